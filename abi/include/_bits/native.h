@@ -79,12 +79,14 @@ typedef void *uspace_addr_t;
 #define uspace_ptr_const_char uspace_ptr(const char)
 #define uspace_ptr_ddi_ioarg_t uspace_ptr(ddi_ioarg_t)
 #define uspace_ptr_ipc_data_t uspace_ptr(ipc_data_t)
+#define uspace_ptr_ipc_submit_t uspace_ptr(ipc_submit_t)
 #define uspace_ptr_irq_code_t uspace_ptr(irq_code_t)
 #define uspace_ptr_size_t uspace_ptr(size_t)
 #define uspace_ptr_struct_uspace_arg uspace_ptr(struct uspace_arg)
 #define uspace_ptr_sysarg64_t uspace_ptr(sysarg64_t)
 #define uspace_ptr_task_id_t uspace_ptr(task_id_t)
 #define uspace_ptr_thread_id_t uspace_ptr(thread_id_t)
+#define uspace_ptr_uint8_t uspace_ptr(uint8_t)
 #define uspace_ptr_uintptr_t uspace_ptr(uintptr_t)
 #define uspace_ptr_uspace_arg_t uspace_ptr(uspace_arg_t)
 #define uspace_ptr_uspace_thread_function_t uspace_ptr(uspace_thread_function_t)
@@ -54,9 +54,15 @@ enum {
 
 	/**
 	 * Maximum buffer size allowed for IPC_M_DATA_WRITE and
-	 * IPC_M_DATA_READ requests.
+	 * IPC_M_DATA_READ requests copied through a kernel buffer.
 	 */
 	DATA_XFER_LIMIT = 64 * 1024,
+
+	/**
+	 * Maximum buffer size allowed for IPC_M_DATA_WRITE and
+	 * IPC_M_DATA_READ requests whose buffer the kernel can loan.
+	 */
+	DATA_XFER_LOAN_LIMIT = 16 * 1024 * 1024,
 };
 
 /* Flags for calls */
@@ -122,6 +128,28 @@ typedef struct {
 	cap_call_handle_t cap_handle;
 } ipc_data_t;
 
+/** Operations of a vectored IPC submission */
+enum {
+	/** Make an asynchronous call over a phone */
+	IPC_SUBMIT_CALL = 0,
+	/** Answer a received call */
+	IPC_SUBMIT_ANSWER = 1,
+};
+
+/** One entry of a vectored IPC submission */
+typedef struct {
+	/** IPC_SUBMIT_CALL or IPC_SUBMIT_ANSWER */
+	sysarg_t op;
+	/** Phone capability for calls or call capability for answers */
+	cap_handle_t handle;
+	/** User-defined label associated with the request (calls only) */
+	sysarg_t label;
+	/** Method and arguments of the call or the answer */
+	sysarg_t args[IPC_CALL_LEN];
+	/** Outcome of the operation, filled in by the kernel */
+	errno_t rc;
+} ipc_submit_t;
+
 /* Functions for manipulating calling data */
 
 static inline void ipc_set_retval(ipc_data_t *data, errno_t retval)
@@ -214,6 +214,16 @@ enum {
 	 * - other arguments are specific to the debug method
 	 */
 	IPC_M_DEBUG,
+
+	/** Share a wait queue with the recipient.
+	 *
+	 * - ARG1 - sender's wait queue capability
+	 *
+	 * The recipient receives its own capability to the same wait queue
+	 * in ARG1. The capability becomes valid when the recipient answers
+	 * with EOK.
+	 */
+	IPC_M_WAITQ_SHARE,
 };
 
 /** Last system IPC method */
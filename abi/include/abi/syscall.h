@@ -49,11 +49,13 @@ typedef enum {
 	SYS_THREAD_GET_ID,
 	SYS_THREAD_USLEEP,
 	SYS_THREAD_UDELAY,
+	SYS_THREAD_SET_AFFINITY,
 
 	SYS_TASK_GET_ID,
 	SYS_TASK_SET_NAME,
 	SYS_TASK_KILL,
 	SYS_TASK_EXIT,
+	SYS_TASK_SET_AFFINITY,
 	SYS_PROGRAM_SPAWN_LOADER,
 
 	SYS_WAITQ_CREATE,
@@ -67,6 +69,7 @@ typedef enum {
 	SYS_AS_AREA_CHANGE_FLAGS,
 	SYS_AS_AREA_GET_INFO,
 	SYS_AS_AREA_DESTROY,
+	SYS_AS_AREA_DISCARD,
 
 	SYS_PAGE_FIND_MAPPING,
 
@@ -80,6 +83,8 @@ typedef enum {
 	SYS_IPC_POKE,
 	SYS_IPC_HANGUP,
 	SYS_IPC_CONNECT_KBOX,
+	SYS_IPC_SUBMIT,
+	SYS_IPC_WAIT_MULTI,
 
 	SYS_IPC_EVENT_SUBSCRIBE,
 	SYS_IPC_EVENT_UNSUBSCRIBE,
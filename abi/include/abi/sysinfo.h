@@ -48,6 +48,7 @@ enum {
 	/** Maximum name sizes */
 	TASK_NAME_BUFLEN = 64,
 	EXC_NAME_BUFLEN  = 20,
+	SLAB_NAME_BUFLEN = 32,
 };
 
 /** Item value type
@@ -70,6 +71,12 @@ typedef struct {
 	uint16_t frequency_mhz;  /**< Frequency in MHz */
 	uint64_t idle_cycles;    /**< Number of idle cycles */
 	uint64_t busy_cycles;    /**< Number of busy cycles */
+	uint64_t steals;         /**< Threads stolen from other CPUs */
+	uint64_t steals_failed;  /**< Unsuccessful steal attempts */
+	uint64_t migrations;     /**< Threads stolen by other CPUs */
+	uint64_t tlb_shootdowns;     /**< TLB shootdowns started */
+	uint64_t tlb_ipis_sent;      /**< TLB shootdown IPIs sent */
+	uint64_t tlb_ipis_received;  /**< TLB shootdown IPIs received */
 } stats_cpu_t;
 
 /** Physical memory statistics
@@ -108,6 +115,7 @@ typedef struct {
 	uint64_t ucycles;             /**< Number of CPU cycles in user space */
 	uint64_t kcycles;             /**< Number of CPU cycles in kernel */
 	stats_ipc_t ipc_info;         /**< IPC statistics */
+	uint64_t affinity;            /**< Allowed CPUs among the first 64 */
 } stats_task_t;
 
 /** Statistics about a single thread
@@ -122,6 +130,7 @@ typedef struct {
 	uint64_t kcycles;       /**< Number of CPU cycles in kernel */
 	bool on_cpu;            /**< Associated with a CPU */
 	unsigned int cpu;       /**< Associated CPU ID (if on_cpu is true) */
+	uint64_t affinity;      /**< Allowed CPUs among the first 64 */
 } stats_thread_t;
 
 /** Statistics about a single IPC connection
@@ -143,6 +152,20 @@ typedef struct {
 	uint64_t count;              /**< Number of handled exceptions */
 } stats_exc_t;
 
+/** Statistics about a single kernel slab cache
+ *
+ */
+typedef struct {
+	char name[SLAB_NAME_BUFLEN];  /**< Cache name */
+	uint64_t size;                /**< Object size (bytes) */
+	uint64_t slabs;               /**< Number of allocated slabs */
+	uint64_t cached;              /**< Objects cached in magazines */
+	uint64_t allocated;           /**< Allocated objects */
+	uint64_t magazine_size;       /**< Size of new magazines */
+	uint64_t depot_accesses;      /**< Magazine depot lock acquisitions */
+	uint64_t depot_contention;    /**< Contended depot lock acquisitions */
+} stats_slab_t;
+
 /** Load fixed-point value */
 typedef uint32_t load_t;
 
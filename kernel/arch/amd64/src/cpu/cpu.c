@@ -38,6 +38,7 @@
 #include <arch/pm.h>
 
 #include <arch.h>
+#include <bitops.h>
 #include <stdio.h>
 #include <fpu_context.h>
 
@@ -130,6 +131,18 @@ void cpu_identify(void)
 		CPU->arch.family = (info.cpuid_eax >> 8) & 0xf;
 		CPU->arch.model = (info.cpuid_eax >> 4) & 0xf;
 		CPU->arch.stepping = (info.cpuid_eax >> 0) & 0xf;
+
+		/*
+		 * Logical processors of one package share the upper bits of
+		 * their initial APIC ID. The number of the lower bits follows
+		 * from the maximum number of logical processors per package.
+		 */
+		uint32_t apic_id = info.cpuid_ebx >> 24;
+		uint32_t logical = 1;
+		if (info.cpuid_edx & (1 << INTEL_HTT))
+			logical = (info.cpuid_ebx >> 16) & 0xffU;
+		CPU->domain = (logical > 1) ?
+		    apic_id >> (fnzb32(logical - 1) + 1) : apic_id;
 	}
 }
 
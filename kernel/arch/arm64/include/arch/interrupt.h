@@ -50,6 +50,9 @@
 /* This needs to be defined for inter-architecture API portability. */
 #define VECTOR_TLB_SHOOTDOWN_IPI  0
 
+/* Any IPI wakes up an idle CPU, an empty shootdown does no harm. */
+#define VECTOR_WAKEUP_IPI  VECTOR_TLB_SHOOTDOWN_IPI
+
 extern ipl_t interrupts_disable(void);
 extern ipl_t interrupts_enable(void);
 extern void interrupts_restore(ipl_t ipl);
@@ -42,6 +42,9 @@
 static irq_t timer_irq;
 static uint64_t timer_increment;
 
+/** Counter value of the next periodic tick. */
+static uint64_t timer_next;
+
 /** Disable interrupts.
  *
  * @return Old interrupt priority level.
@@ -116,7 +119,8 @@ static void timer_start(void)
 	timer_increment = cntfrq / HZ;
 
 	/* Program the timer. */
-	CNTV_CVAL_EL0_write(cntvct + timer_increment);
+	timer_next = cntvct + timer_increment;
+	CNTV_CVAL_EL0_write(timer_next);
 	CNTV_CTL_EL0_write(
 	    (cntv_ctl & ~CNTV_CTL_IMASK_FLAG) | CNTV_CTL_ENABLE_FLAG);
 }
@@ -131,14 +135,15 @@ static irq_ownership_t timer_claim(irq_t *irq)
 static void timer_irq_handler(irq_t *irq)
 {
 	uint64_t cntvct = CNTVCT_EL0_read();
-	uint64_t cntv_cval = CNTV_CVAL_EL0_read();
 
-	uint64_t drift = cntvct - cntv_cval;
-	while (drift > timer_increment) {
-		drift -= timer_increment;
-		CPU->missed_clock_ticks++;
-	}
-	CNTV_CVAL_EL0_write(cntvct + timer_increment - drift);
+	/* Account for the ticks lost or skipped while idle. */
+	uint64_t missed = 0;
+	if (cntvct > timer_next)
+		missed = (cntvct - timer_next) / timer_increment;
+
+	CPU->missed_clock_ticks += missed;
+	timer_next += (missed + 1) * timer_increment;
+	CNTV_CVAL_EL0_write(timer_next);
 
 	/*
 	 * We are holding a lock which prevents preemption.
@@ -149,6 +154,23 @@ static void timer_irq_handler(irq_t *irq)
 	irq_spinlock_lock(&irq->lock, false);
 }
 
+/** Defer the timer interrupt while the CPU is idle. */
+static void timer_idle_enter(uint64_t ticks)
+{
+	CNTV_CVAL_EL0_write(timer_next + (ticks - 1) * timer_increment);
+}
+
+/** Restore the periodic timer interrupt. */
+static void timer_idle_exit(void)
+{
+	CNTV_CVAL_EL0_write(timer_next);
+}
+
+static clock_tickless_ops_t timer_tickless_ops = {
+	.idle_enter = timer_idle_enter,
+	.idle_exit = timer_idle_exit
+};
+
 /** Initialize basic tables for exception dispatching. */
 void interrupt_init(void)
 {
@@ -166,6 +188,7 @@ void interrupt_init(void)
 	irq_register(&timer_irq);
 
 	timer_start();
+	clock_tickless_ops = &timer_tickless_ops;
 }
 
 /** @}
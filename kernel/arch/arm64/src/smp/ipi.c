@@ -46,6 +46,16 @@ void ipi_broadcast_arch(int ipi)
 	panic("broadcast IPI not implemented.");
 }
 
+/** Deliver IPI to a single processor.
+ *
+ * @param cpu_id ID of the destination processor.
+ * @param ipi    IPI number.
+ */
+void ipi_unicast_arch(unsigned int cpu_id, int ipi)
+{
+	panic("unicast IPI not implemented.");
+}
+
 #endif /* CONFIG_SMP */
 
 /** @}
@@ -37,6 +37,7 @@
 #include <arch/pm.h>
 
 #include <arch.h>
+#include <bitops.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <fpu_context.h>
@@ -141,6 +142,18 @@ void cpu_identify(void)
 		CPU->arch.family = (info.cpuid_eax >> 8) & 0x0fU;
 		CPU->arch.model = (info.cpuid_eax >> 4) & 0x0fU;
 		CPU->arch.stepping = (info.cpuid_eax >> 0) & 0x0fU;
+
+		/*
+		 * Logical processors of one package share the upper bits of
+		 * their initial APIC ID. The number of the lower bits follows
+		 * from the maximum number of logical processors per package.
+		 */
+		uint32_t apic_id = info.cpuid_ebx >> 24;
+		uint32_t logical = 1;
+		if (info.cpuid_edx & (1 << INTEL_HTT))
+			logical = (info.cpuid_ebx >> 16) & 0xffU;
+		CPU->domain = (logical > 1) ?
+		    apic_id >> (fnzb32(logical - 1) + 1) : apic_id;
 	}
 }
 
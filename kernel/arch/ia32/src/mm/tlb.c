@@ -38,6 +38,13 @@
 #include <arch/asm.h>
 #include <typedefs.h>
 
+/**
+ * Above this number of pages, flushing the whole TLB is cheaper than
+ * invalidating the pages one by one and refilling the TLB later costs
+ * about the same.
+ */
+#define TLB_INVL_PAGES_MAX  32
+
 /** Invalidate all entries in TLB. */
 void tlb_invalidate_all(void)
 {
@@ -54,6 +61,8 @@ void tlb_invalidate_asid(asid_t asid __attribute__((unused)))
 }
 
 /** Invalidate TLB entries for specified page range belonging to specified address space.
+ *
+ * Large ranges are invalidated by a single flush of all non-global entries.
  *
  * @param asid This parameter is ignored as the architecture doesn't support it.
  * @param page Address of the first page whose entry is to be invalidated.
@@ -63,6 +72,11 @@ void tlb_invalidate_pages(asid_t asid __attribute__((unused)), uintptr_t page, s
 {
 	unsigned int i;
 
+	if (cnt > TLB_INVL_PAGES_MAX) {
+		tlb_invalidate_all();
+		return;
+	}
+
 	for (i = 0; i < cnt; i++)
 		invlpg(page + i * PAGE_SIZE);
 }
@@ -64,6 +64,9 @@
 
 #define VECTOR_TLB_SHOOTDOWN_IPI  0xf0
 
+/* Any IPI wakes up an idle CPU, an empty shootdown does no harm. */
+#define VECTOR_WAKEUP_IPI  VECTOR_TLB_SHOOTDOWN_IPI
+
 #define INTERRUPT_SPURIOUS  15
 #define INTERRUPT_TIMER     255
 
@@ -42,6 +42,9 @@
 
 #define VECTOR_TLB_SHOOTDOWN_IPI  EXC_Int
 
+/* Any IPI wakes up an idle CPU, an empty shootdown does no harm. */
+#define VECTOR_WAKEUP_IPI  VECTOR_TLB_SHOOTDOWN_IPI
+
 extern function virtual_timer_fnc;
 extern uint32_t count_hi;
 
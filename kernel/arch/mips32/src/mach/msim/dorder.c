@@ -49,6 +49,15 @@ void ipi_broadcast_arch(int ipi)
 	pio_write_32(((ioport32_t *) MSIM_DORDER_ADDRESS), 0x7fffffff);
 }
 
+void ipi_unicast_arch(unsigned int cpu_id, int ipi)
+{
+	/*
+	 * Spurious IPIs are harmless, so do not bother with mapping
+	 * kernel CPU IDs to the device order numbers.
+	 */
+	ipi_broadcast_arch(ipi);
+}
+
 #endif
 
 static irq_ownership_t dorder_claim(irq_t *irq)
@@ -43,6 +43,9 @@
 
 #define VECTOR_TLB_SHOOTDOWN_IPI  0
 
+/* Any IPI wakes up an idle CPU, an empty shootdown does no harm. */
+#define VECTOR_WAKEUP_IPI  VECTOR_TLB_SHOOTDOWN_IPI
+
 #endif
 
 /** @}
@@ -172,5 +172,25 @@ void ipi_broadcast_arch(int ipi)
 	}
 }
 
+/*
+ * Deliver IPI to a single processor.
+ *
+ * We assume that interrupts are disabled.
+ *
+ * @param cpu_id ID of the destination processor.
+ * @param ipi    IPI number.
+ */
+void ipi_unicast_arch(unsigned int cpu_id, int ipi)
+{
+	switch (ipi) {
+	case IPI_TLB_SHOOTDOWN:
+		cross_call(cpus[cpu_id].arch.mid, tlb_shootdown_ipi_recv);
+		break;
+	default:
+		panic("Unknown IPI (%d).\n", ipi);
+		break;
+	}
+}
+
 /** @}
  */
@@ -128,6 +128,19 @@
 #define SET_PTL3_PRESENT(ptl2, i)   SET_PTL3_PRESENT_ARCH(ptl2, i)
 #define SET_FRAME_PRESENT(ptl3, i)  SET_FRAME_PRESENT_ARCH(ptl3, i)
 
+/*
+ * Architectures that can map a whole PTL3 worth of memory directly from a
+ * PTL2 entry define LARGE_PAGE_WIDTH_ARCH and the accessors below.
+ *
+ */
+#ifdef LARGE_PAGE_WIDTH_ARCH
+#define LARGE_PAGE_WIDTH  LARGE_PAGE_WIDTH_ARCH
+#define LARGE_PAGE_SIZE   (((uintptr_t) 1) << LARGE_PAGE_WIDTH)
+
+#define GET_PTL3_LARGE(ptl2, i)     GET_PTL3_LARGE_ARCH(ptl2, i)
+#define SET_PTL3_LARGE(ptl2, i, x)  SET_PTL3_LARGE_ARCH(ptl2, i, x)
+#endif
+
 /*
  * Macros for querying the last-level PTEs.
  *
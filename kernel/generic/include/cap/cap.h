@@ -38,9 +38,6 @@
 #include <abi/cap.h>
 #include <typedefs.h>
 #include <adt/list.h>
-#include <adt/hash.h>
-#include <adt/hash_table.h>
-#include <lib/ra.h>
 #include <synch/mutex.h>
 #include <atomic.h>
 
@@ -110,25 +107,42 @@ typedef struct cap {
 	/* Link to the task's capabilities of the same kobject type. */
 	link_t type_link;
 
-	ht_link_t caps_link;
+	/** Link to the task's list of free capabilities. */
+	link_t free_link;
 
 	/* The underlying kernel object. */
 	kobject_t *kobject;
 } cap_t;
 
+/** Number of capabilities in one leaf of the capability table. */
+#define CAPS_PER_LEAF	64
+
 typedef struct cap_info {
 	mutex_t lock;
 
 	list_t type_list[KOBJECT_TYPE_MAX];
 
-	hash_table_t caps;
-	ra_arena_t *handles;
+	/**
+	 * Capability table. Leaves are arrays of CAPS_PER_LEAF capabilities
+	 * indexed directly by the capability handle. Leaves are only ever
+	 * added, so capabilities never move.
+	 */
+	cap_t **leaves;
+	/** Number of leaves in the capability table. */
+	size_t leaf_count;
+	/** Number of leaves the table has room for. */
+	size_t leaf_max;
+
+	/** List of free capabilities, lowest handles first. */
+	list_t free_list;
 } cap_info_t;
 
 extern void caps_init(void);
 extern errno_t caps_task_alloc(struct task *);
 extern void caps_task_free(struct task *);
 extern void caps_task_init(struct task *);
+extern void caps_task_fini(struct task *);
+extern void caps_task_shrink(struct task *);
 extern bool caps_apply_to_kobject_type(struct task *, kobject_type_t,
     bool (*)(cap_t *, void *), void *);
 
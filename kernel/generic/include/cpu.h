@@ -36,11 +36,13 @@
 #define KERN_CPU_H_
 
 #include <mm/tlb.h>
+#include <mm/frame.h>
 #include <synch/spinlock.h>
 #include <proc/scheduler.h>
 #include <arch/cpu.h>
 #include <arch/context.h>
 #include <adt/list.h>
+#include <time/timeout_wheel.h>
 #include <arch.h>
 
 #define CPU                  CURRENT->cpu
@@ -58,8 +60,31 @@ typedef struct cpu {
 	atomic_size_t nrdy;
 	runq_t rq[RQ_COUNT];
 
+	/**
+	 * Bitmap of non-empty run queues. Bit i is set iff rq[i] is not
+	 * empty. Bits are only changed with the respective rq[i].lock held.
+	 */
+	atomic_uint_fast32_t rq_bitmap;
+
+	/**
+	 * Load balancing statistics.
+	 */
+	atomic_size_t steals;         /**< Threads stolen by this CPU. */
+	atomic_size_t steals_failed;  /**< Steal attempts that found no thread. */
+	atomic_size_t migrations;     /**< Threads stolen from this CPU. */
+
+	/**
+	 * TLB shootdown statistics.
+	 */
+	atomic_size_t tlb_shootdowns;      /**< Shootdowns started by this CPU. */
+	atomic_size_t tlb_ipis_sent;       /**< Shootdown IPIs sent. */
+	atomic_size_t tlb_ipis_received;   /**< Shootdown IPIs received. */
+
+	/** Caches of single free frames */
+	frame_cache_t frame_cache[FRAME_CACHE_CLASSES];
+
 	IRQ_SPINLOCK_DECLARE(timeoutlock);
-	list_t timeout_active_list;
+	timeout_wheel_t timeout_wheel;
 
 	/**
 	 * When system clock loses a tick, it is
@@ -79,15 +104,30 @@ typedef struct cpu {
 	 * Processor cycle accounting.
 	 */
 	bool idle;
+	bool tickless;  /**< Periodic clock stopped while idle. */
 	uint64_t last_cycle;
 	atomic_time_stat_t idle_cycles;
 	atomic_time_stat_t busy_cycles;
 
+	/**
+	 * IPC allocation statistics. Calls allocated and call payloads kept
+	 * in the call itself or allocated from the heap.
+	 */
+	atomic_size_t ipc_calls;
+	atomic_size_t ipc_inline_buffers;
+	atomic_size_t ipc_heap_buffers;
+
 	/**
 	 * Processor ID assigned by kernel.
 	 */
 	unsigned int id;
 
+	/**
+	 * Locality domain of the processor, such as its package. Set by the
+	 * architecture if it knows the topology, zero otherwise.
+	 */
+	unsigned int domain;
+
 	bool active;
 	volatile bool tlb_active;
 
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_CPU_AFFINITY_H_
+#define KERN_CPU_AFFINITY_H_
+
+#include <cpu/cpu_mask.h>
+#include <lib/refcount.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <typedefs.h>
+
+/** CPU affinity of a task or a thread.
+ *
+ * The mask is never modified once the structure is published, so a task
+ * and all its threads can share one instance. A NULL pointer in place of
+ * the affinity means that there is no restriction.
+ */
+typedef struct cpu_affinity {
+	atomic_refcount_t refcount;
+	/** CPUs allowed to run the thread. Variable size, must be last. */
+	cpu_mask_t mask;
+} cpu_affinity_t;
+
+extern errno_t cpu_affinity_from_uspace(uspace_addr_t, size_t,
+    cpu_affinity_t **);
+extern cpu_affinity_t *cpu_affinity_ref(cpu_affinity_t *);
+extern void cpu_affinity_put(cpu_affinity_t *);
+extern bool cpu_affinity_allows(cpu_affinity_t *, unsigned int);
+extern uint64_t cpu_affinity_summary(cpu_affinity_t *);
+
+#endif /* KERN_CPU_AFFINITY_H_ */
+
+/** @}
+ */
@@ -41,9 +41,13 @@
 #include <abi/ipc/ipc.h>
 #include <abi/proc/task.h>
 #include <typedefs.h>
+#include <mm/as.h>
 #include <mm/slab.h>
 #include <cap/cap.h>
 
+/** Payloads up to this size are carried in a buffer inside the call. */
+#define IPC_CALL_INLINE_SIZE  256
+
 struct answerbox;
 struct task;
 struct call;
@@ -165,6 +169,34 @@ typedef struct call {
 
 	/** Buffer for IPC_M_DATA_WRITE and IPC_M_DATA_READ. */
 	uint8_t *buffer;
+
+	/**
+	 * Frames of the caller's buffer loaned for a zero-copy
+	 * IPC_M_DATA_WRITE or IPC_M_DATA_READ. Used instead of buffer.
+	 */
+	struct {
+		as_loan_frame_t *frames;
+		size_t count;
+		/** Offset of the data within the first frame. */
+		size_t offset;
+		/** True if the data is copied into the frames. */
+		bool writable;
+	} loan;
+
+	/** Wait queue passed by IPC_M_WAITQ_SHARE. */
+	kobject_t *waitq;
+
+	/**
+	 * The call and its answer carry nothing but registers, so the sender
+	 * can switch straight to the thread receiving them.
+	 */
+	bool handoff;
+
+	/**
+	 * Storage for small payloads, see ipc_call_buffer_alloc(). Must stay
+	 * the last member, it is not cleared when the call is initialized.
+	 */
+	uint8_t inline_buffer[IPC_CALL_INLINE_SIZE];
 } call_t;
 
 extern slab_cache_t *phone_cache;
@@ -184,6 +216,12 @@ extern errno_t ipc_forward(call_t *, phone_t *, answerbox_t *, unsigned int);
 extern void ipc_answer(answerbox_t *, call_t *);
 extern void _ipc_answer_free_call(call_t *, bool);
 
+extern uint8_t *ipc_call_buffer_alloc(call_t *, size_t);
+extern errno_t ipc_call_xfer_limit(call_t *, size_t);
+extern errno_t ipc_call_loan(call_t *, uspace_addr_t, size_t, bool);
+extern errno_t ipc_call_loan_copy(call_t *, uspace_addr_t, size_t);
+extern void ipc_call_loan_return(call_t *);
+
 extern void ipc_phone_init(phone_t *, struct task *);
 extern bool ipc_phone_connect(phone_t *, answerbox_t *);
 extern errno_t ipc_phone_hangup(phone_t *);
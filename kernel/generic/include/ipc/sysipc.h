@@ -55,6 +55,9 @@ extern sys_errno_t sys_ipc_forward_fast(cap_call_handle_t, cap_phone_handle_t,
 extern sys_errno_t sys_ipc_forward_slow(cap_call_handle_t, cap_phone_handle_t,
     uspace_ptr_ipc_data_t, unsigned int);
 extern sys_errno_t sys_ipc_hangup(cap_phone_handle_t);
+extern sys_errno_t sys_ipc_submit(uspace_ptr_ipc_submit_t, sysarg_t);
+extern sys_errno_t sys_ipc_wait_multi(uspace_ptr_ipc_data_t, sysarg_t,
+    uspace_ptr_size_t, uint32_t, unsigned int);
 
 extern sys_errno_t sys_ipc_irq_subscribe(inr_t, sysarg_t, uspace_ptr_irq_code_t,
     uspace_ptr_cap_irq_handle_t);
@@ -115,6 +115,14 @@ typedef struct as {
 	 */
 	asid_t asid;
 
+	/**
+	 * Processors which have ever run this address space and so may hold
+	 * its translations in their TLBs. TLB shootdowns are only sent to
+	 * these. NULL for the kernel address space, which every processor
+	 * uses. Modified only by tlb_shootdown_cpu_add().
+	 */
+	struct cpu_mask *cpu_mask;
+
 	/** Number of references (i.e. tasks that reference this as). */
 	atomic_refcount_t refcount;
 
@@ -296,6 +304,7 @@ typedef struct mem_backend {
 
 	bool (*is_resizable)(as_area_t *);
 	bool (*is_shareable)(as_area_t *);
+	bool (*is_discardable)(as_area_t *);
 
 	int (*page_fault)(as_area_t *, uintptr_t, pf_access_t);
 	void (*frame_free)(as_area_t *, uintptr_t, uintptr_t);
@@ -304,6 +313,14 @@ typedef struct mem_backend {
 	void (*destroy_shared_data)(void *);
 } mem_backend_t;
 
+/** Frame loaned by as_frames_loan(). */
+typedef struct {
+	/** Physical address of the frame. */
+	uintptr_t frame;
+	/** The frame carries its own reservation (AS_AREA_LATE_RESERVE). */
+	bool late_reserve;
+} as_loan_frame_t;
+
 extern as_t *AS_KERNEL;
 
 extern const as_operations_t *as_operations;
@@ -316,11 +333,15 @@ extern void as_hold(as_t *);
 extern void as_release(as_t *);
 extern void as_switch(as_t *, as_t *);
 extern int as_page_fault(uintptr_t, pf_access_t, istate_t *);
+extern errno_t as_frames_loan(uintptr_t, size_t, pf_access_t,
+    as_loan_frame_t *);
+extern void as_frames_return(as_loan_frame_t *, size_t);
 
 extern as_area_t *as_area_create(as_t *, unsigned int, size_t, unsigned int,
     mem_backend_t *, mem_backend_data_t *, uintptr_t *, uintptr_t);
 extern errno_t as_area_destroy(as_t *, uintptr_t);
 extern errno_t as_area_resize(as_t *, uintptr_t, size_t, unsigned int);
+extern errno_t as_area_discard(as_t *, uintptr_t, size_t);
 extern errno_t as_area_share(as_t *, uintptr_t, size_t, as_t *, unsigned int,
     uintptr_t *, uintptr_t);
 extern errno_t as_area_change_flags(as_t *, unsigned int, uintptr_t);
@@ -378,6 +399,7 @@ extern sys_errno_t sys_as_area_resize(uintptr_t, size_t, unsigned int);
 extern sys_errno_t sys_as_area_change_flags(uintptr_t, unsigned int);
 extern sys_errno_t sys_as_area_get_info(uintptr_t, uspace_ptr_as_area_info_t);
 extern sys_errno_t sys_as_area_destroy(uintptr_t);
+extern sys_errno_t sys_as_area_discard(uintptr_t, size_t);
 
 /* Introspection functions. */
 extern as_area_info_t *as_get_area_info(as_t *, size_t *);
@@ -89,6 +89,36 @@ typedef uint8_t zone_flags_t;
 	(((((zf) & ZONE_EF_MASK)) == ((f) & ZONE_EF_MASK)) && \
 	    (((zf) & ~ZONE_EF_MASK) & (f)))
 
+/** Number of frames each list of a per-CPU frame cache can hold */
+#define FRAME_CACHE_SIZE   32
+
+/** Number of frames moved between a per-CPU frame cache and the zones */
+#define FRAME_CACHE_BATCH  16
+
+/** Per-CPU frame caches of low and high memory frames */
+#define FRAME_CACHE_LOWMEM   0
+#define FRAME_CACHE_HIGHMEM  1
+#define FRAME_CACHE_CLASSES  2
+
+/** Per-CPU cache of single free frames
+ *
+ * The frames are accounted as allocated in their zones. The lock is
+ * only contended when another CPU drains the cache because a zone
+ * allocation failed.
+ *
+ */
+typedef struct {
+	IRQ_SPINLOCK_DECLARE(lock);
+
+	/** Recently freed frames, likely still present in the CPU caches */
+	pfn_t hot[FRAME_CACHE_SIZE];
+	size_t hot_count;
+
+	/** Frames taken from the zones in advance */
+	pfn_t cold[FRAME_CACHE_SIZE];
+	size_t cold_count;
+} frame_cache_t;
+
 typedef struct {
 	size_t refcount;  /**< Tracking of shared frames */
 	void *parent;     /**< If allocated by slab, this points there */
@@ -139,6 +169,8 @@ extern void frame_free(uintptr_t, size_t);
 extern void frame_free_noreserve(uintptr_t, size_t);
 extern void frame_reference_add(pfn_t);
 extern size_t frame_total_free_get(void);
+extern void frame_cache_init(frame_cache_t *);
+extern size_t frame_cache_drain_all(void);
 
 extern size_t find_zone(pfn_t, size_t, size_t);
 extern size_t zone_create(pfn_t, size_t, pfn_t, zone_flags_t);
@@ -39,10 +39,26 @@
 #include <synch/spinlock.h>
 #include <atomic.h>
 #include <mm/frame.h>
+#include <abi/sysinfo.h>
 
-/** Initial Magazine size (TODO: dynamically growing magazines) */
+/** Initial Magazine size */
 #define SLAB_MAG_SIZE  4
 
+/** Number of supported magazine sizes, each twice the previous one */
+#define SLAB_MAG_SIZES  5
+
+/** Maximum Magazine size */
+#define SLAB_MAG_SIZE_MAX  (SLAB_MAG_SIZE << (SLAB_MAG_SIZES - 1))
+
+/** Number of depot accesses over which the contention is evaluated */
+#define SLAB_MAG_RESIZE_WINDOW  256
+
+/** Grow magazines if more than 1/n of depot accesses were contended */
+#define SLAB_MAG_RESIZE_RATIO  8
+
+/** Maximum number of full and empty magazines kept by each CPU */
+#define SLAB_CPU_DEPOT_SIZE  2
+
 /** If object size is less, store control structure inside SLAB */
 #define SLAB_INSIDE_SIZE  (PAGE_SIZE >> 3)
 
@@ -74,6 +90,13 @@ typedef struct {
 typedef struct {
 	slab_magazine_t *current;
 	slab_magazine_t *last;
+
+	/* CPU depot */
+	list_t full;         /**< List of full magazines */
+	list_t empty;        /**< List of empty magazines */
+	size_t full_count;   /**< Number of magazines in full */
+	size_t empty_count;  /**< Number of magazines in empty */
+
 	IRQ_SPINLOCK_DECLARE(lock);
 } slab_mag_cache_t;
 
@@ -103,13 +126,25 @@ typedef struct {
 	atomic_size_t cached_objs;
 	/** How many magazines in magazines list */
 	atomic_size_t magazine_counter;
+	/** How many times the magazine depot was locked */
+	atomic_size_t depot_accesses;
+	/** How many times the magazine depot lock was contended */
+	atomic_size_t depot_contention;
+
+	/** Size of newly allocated magazines */
+	atomic_size_t mag_size;
+	/** Depot accesses in the current resize window */
+	size_t window_accesses;
+	/** Contended depot accesses in the current resize window */
+	size_t window_contention;
 
 	/* Slabs */
 	list_t full_slabs;     /**< List of full slabs */
 	list_t partial_slabs;  /**< List of partial slabs */
 	IRQ_SPINLOCK_DECLARE(slablock);
 	/* Magazines */
-	list_t magazines;  /**< List o full magazines */
+	list_t magazines;        /**< List o full magazines */
+	list_t empty_magazines;  /**< List of empty magazines */
 	IRQ_SPINLOCK_DECLARE(maglock);
 
 	/** CPU cache */
@@ -132,6 +167,9 @@ extern void slab_enable_cpucache(void);
 /* kconsole debug */
 extern void slab_print_list(void);
 
+/* statistics */
+extern size_t slab_stats_get(stats_slab_t *, size_t);
+
 #endif
 
 /** @}
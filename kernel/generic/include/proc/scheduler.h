@@ -36,6 +36,7 @@
 #define KERN_SCHEDULER_H_
 
 #include <stddef.h>
+#include <stdint.h>
 #include <synch/spinlock.h>
 #include <time/clock.h>
 #include <atomic.h>
@@ -51,13 +52,34 @@ typedef struct {
 	size_t n;			/**< Number of threads in rq_ready. */
 } runq_t;
 
+/** Mark run queue @a i as non-empty in @a bitmap.
+ *
+ * The lock of the respective run queue must be held.
+ *
+ */
+static inline void rq_bitmap_set(atomic_uint_fast32_t *bitmap, int i)
+{
+	atomic_fetch_or_explicit(bitmap, UINT32_C(1) << i,
+	    memory_order_relaxed);
+}
+
+/** Mark run queue @a i as empty in @a bitmap.
+ *
+ * The lock of the respective run queue must be held.
+ *
+ */
+static inline void rq_bitmap_clear(atomic_uint_fast32_t *bitmap, int i)
+{
+	atomic_fetch_and_explicit(bitmap, ~(UINT32_C(1) << i),
+	    memory_order_relaxed);
+}
+
 extern atomic_size_t nrdy;
 extern void scheduler_init(void);
 
 extern void scheduler_fpu_lazy_request(void);
 extern void scheduler(void);
 extern void scheduler_locked(ipl_t);
-extern void kcpulb(void *arg);
 
 extern void sched_print_list(void);
 
@@ -62,6 +62,7 @@
 
 struct thread;
 struct cap;
+struct cpu_affinity;
 
 /** Task structure. */
 typedef struct task {
@@ -94,6 +95,9 @@ typedef struct task {
 	/** Task permissions. */
 	perm_t perms;
 
+	/** CPU affinity given to new threads, NULL if unrestricted. */
+	struct cpu_affinity *affinity;
+
 	/** Capabilities */
 	cap_info_t *cap_info;
 
@@ -150,6 +154,7 @@ extern task_t *task_next(task_t *);
 extern errno_t task_kill(task_id_t);
 extern void task_kill_self(bool) __attribute__((noreturn));
 extern void task_get_accounting(task_t *, uint64_t *, uint64_t *);
+extern void task_set_affinity(task_t *, struct cpu_affinity *);
 extern void task_print_list(bool);
 
 extern void perm_set(task_t *, perm_t);
@@ -173,6 +178,7 @@ extern sysarg_t sys_task_get_id(void);
 
 extern sys_errno_t sys_task_set_name(uspace_ptr_const_char, size_t);
 extern sys_errno_t sys_task_kill(uspace_ptr_task_id_t);
+extern sys_errno_t sys_task_set_affinity(uspace_ptr_uint8_t, size_t);
 extern sys_errno_t sys_task_exit(sysarg_t);
 
 #endif
@@ -139,10 +139,18 @@ typedef struct thread {
 
 	/** Thread CPU. */
 	cpu_t *cpu;
+	/** CPUs the thread may run on, NULL if unrestricted. */
+	struct cpu_affinity *affinity;
 	/** Containing task. */
 	task_t *task;
 	/** Thread was migrated to another CPU and has not run yet. */
 	bool stolen;
+	/**
+	 * Thread woken up by this thread to run next on its CPU, see
+	 * thread_wakeup_handoff(). Only accessed by the thread itself with
+	 * interrupts disabled.
+	 */
+	struct thread *handoff;
 	/** Thread is executed in user space. */
 	bool uspace;
 
@@ -202,6 +210,8 @@ typedef enum {
 extern thread_termination_state_t thread_wait_start(void);
 extern thread_wait_result_t thread_wait_finish(deadline_t);
 extern void thread_wakeup(thread_t *);
+extern void thread_wakeup_handoff(thread_t *);
+extern void thread_handoff_release(void);
 
 static inline thread_t *thread_ref(thread_t *thread)
 {
@@ -247,6 +257,8 @@ extern thread_t *thread_try_get(thread_t *);
 
 extern void thread_migration_disable(void);
 extern void thread_migration_enable(void);
+extern void thread_set_affinity(thread_t *, struct cpu_affinity *);
+extern void thread_affinity_apply(void);
 
 #ifdef CONFIG_UDEBUG
 extern void thread_stack_trace(thread_id_t);
@@ -260,6 +272,8 @@ extern sys_errno_t sys_thread_create(uspace_ptr_uspace_arg_t, uspace_ptr_char, s
     uspace_ptr_thread_id_t);
 extern sys_errno_t sys_thread_exit(int);
 extern sys_errno_t sys_thread_get_id(uspace_ptr_thread_id_t);
+extern sys_errno_t sys_thread_set_affinity(uspace_ptr_thread_id_t,
+    uspace_ptr_uint8_t, size_t);
 extern sys_errno_t sys_thread_usleep(uint32_t);
 extern sys_errno_t sys_thread_udelay(uint32_t);
 
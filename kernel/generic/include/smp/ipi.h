@@ -39,10 +39,13 @@
 
 extern void ipi_broadcast(int);
 extern void ipi_broadcast_arch(int);
+extern void ipi_unicast(unsigned int, int);
+extern void ipi_unicast_arch(unsigned int, int);
 
 #else
 
 #define ipi_broadcast(ipi)
+#define ipi_unicast(cpu_id, ipi)
 
 #endif /* CONFIG_SMP */
 
@@ -78,6 +78,7 @@ extern errno_t waitq_sleep_unsafe(waitq_t *, wait_guard_t);
 extern errno_t waitq_sleep_timeout_unsafe(waitq_t *, uint32_t, unsigned int, wait_guard_t);
 
 extern void waitq_wake_one(waitq_t *);
+extern void waitq_wake_one_handoff(waitq_t *);
 extern void waitq_wake_all(waitq_t *);
 extern void waitq_signal(waitq_t *);
 extern void waitq_close(waitq_t *);
@@ -39,6 +39,9 @@
 
 #define HZ  100
 
+/** Longest period an idle CPU may spend without a clock tick. */
+#define CLOCK_IDLE_MAX_TICKS  HZ
+
 /** Uptime structure */
 typedef struct {
 	sysarg_t seconds1;
@@ -46,10 +49,26 @@ typedef struct {
 	sysarg_t seconds2;
 } uptime_t;
 
+/** Clock source operations needed for tickless idle
+ *
+ * Both are called with interrupts disabled on the CPU whose clock
+ * interrupt is to be affected.
+ *
+ */
+typedef struct {
+	/** Defer the next clock interrupt by the given number of ticks. */
+	void (*idle_enter)(uint64_t);
+	/** Resume periodic clock interrupts. */
+	void (*idle_exit)(void);
+} clock_tickless_ops_t;
+
 extern uptime_t *uptime;
+extern clock_tickless_ops_t *clock_tickless_ops;
 
 extern void clock(void);
 extern void clock_counter_init(void);
+extern void clock_idle_enter(void);
+extern void clock_idle_exit(void);
 
 #endif
 
@@ -45,8 +45,10 @@ typedef uint64_t deadline_t;
 #define DEADLINE_NEVER ((deadline_t) UINT64_MAX)
 
 typedef struct {
-	/** Link to the list of active timeouts on timeout->cpu */
+	/** Link to the timing wheel slot on timeout->cpu */
 	link_t link;
+	/** Index of the timing wheel slot the timeout is linked to. */
+	unsigned int slot;
 	/** Timeout will be activated when current clock tick reaches this value. */
 	deadline_t deadline;
 	/** Function that will be called on timeout activation. */
@@ -68,6 +70,8 @@ extern void timeout_initialize(timeout_t *);
 extern void timeout_register(timeout_t *, uint64_t, timeout_handler_t, void *);
 extern void timeout_register_deadline(timeout_t *, deadline_t, timeout_handler_t, void *);
 extern bool timeout_unregister(timeout_t *);
+extern deadline_t timeout_next_deadline(void);
+extern void timeout_run_expired(void);
 
 #endif
 
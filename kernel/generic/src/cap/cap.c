@@ -54,6 +54,13 @@
  * underlying kernel object and puts it back into the allocated state. An
  * allocated capability can be freed to become available for future use.
  *
+ * The capabilities of a task are kept in a two-level table indexed directly by
+ * the capability handle. The table is a growable array of pointers to leaves of
+ * CAPS_PER_LEAF capabilities each, so translating a handle to a capability is
+ * just two array indexations. Free capabilities are linked on a free list from
+ * which handles are allocated; the table grows by one leaf when the list runs
+ * empty. Leaves are only released together with the task.
+ *
  * There is a 1:1 correspondence between a kernel object (kobject_t) and the
  * actual raw object it encapsulates. A kernel object (kobject_t) may have
  * multiple references, either implicit from one or more capabilities (cap_t),
@@ -95,7 +102,10 @@
 #define CAPS_SIZE	(INT_MAX - (int) CAPS_START)
 #define CAPS_LAST	(CAPS_SIZE - 1)
 
-static slab_cache_t *cap_cache;
+/** Initial number of leaves the capability table has room for. */
+#define CAPS_LEAVES_INITIAL	4
+
+static slab_cache_t *cap_leaf_cache;
 static slab_cache_t *kobject_cache;
 
 kobject_ops_t *kobject_ops[KOBJECT_TYPE_MAX] = {
@@ -105,35 +115,10 @@ kobject_ops_t *kobject_ops[KOBJECT_TYPE_MAX] = {
 	[KOBJECT_TYPE_WAITQ] = &waitq_kobject_ops
 };
 
-static size_t caps_hash(const ht_link_t *item)
-{
-	cap_t *cap = hash_table_get_inst(item, cap_t, caps_link);
-	return hash_mix(cap_handle_raw(cap->handle));
-}
-
-static size_t caps_key_hash(const void *key)
-{
-	const cap_handle_t *handle = key;
-	return hash_mix(cap_handle_raw(*handle));
-}
-
-static bool caps_key_equal(const void *key, const ht_link_t *item)
-{
-	const cap_handle_t *handle = key;
-	cap_t *cap = hash_table_get_inst(item, cap_t, caps_link);
-	return *handle == cap->handle;
-}
-
-static const hash_table_ops_t caps_ops = {
-	.hash = caps_hash,
-	.key_hash = caps_key_hash,
-	.key_equal = caps_key_equal
-};
-
 void caps_init(void)
 {
-	cap_cache = slab_cache_create("cap_t", sizeof(cap_t), 0, NULL,
-	    NULL, 0);
+	cap_leaf_cache = slab_cache_create("cap_leaf_t",
+	    CAPS_PER_LEAF * sizeof(cap_t), 0, NULL, NULL, 0);
 	kobject_cache = slab_cache_create("kobject_t", sizeof(kobject_t), 0,
 	    NULL, NULL, 0);
 }
@@ -147,20 +132,11 @@ errno_t caps_task_alloc(task_t *task)
 	task->cap_info = (cap_info_t *) malloc(sizeof(cap_info_t));
 	if (!task->cap_info)
 		return ENOMEM;
-	task->cap_info->handles = ra_arena_create();
-	if (!task->cap_info->handles)
-		goto error_handles;
-	if (!ra_span_add(task->cap_info->handles, CAPS_START, CAPS_SIZE))
-		goto error_span;
-	if (!hash_table_create(&task->cap_info->caps, 0, 0, &caps_ops))
-		goto error_span;
+	task->cap_info->leaves = NULL;
+	task->cap_info->leaf_count = 0;
+	task->cap_info->leaf_max = 0;
+	list_initialize(&task->cap_info->free_list);
 	return EOK;
-
-error_span:
-	ra_arena_destroy(task->cap_info->handles);
-error_handles:
-	free(task->cap_info);
-	return ENOMEM;
 }
 
 /** Initialize the capability info structure
@@ -173,6 +149,36 @@ void caps_task_init(task_t *task)
 
 	for (kobject_type_t t = 0; t < KOBJECT_TYPE_MAX; t++)
 		list_initialize(&task->cap_info->type_list[t]);
+
+	/* The leaves of a previous task were released by caps_task_fini(). */
+	assert(task->cap_info->leaf_count == 0);
+	list_initialize(&task->cap_info->free_list);
+}
+
+/** Release the capability table of a task that is being destroyed
+ *
+ * The info structure itself stays allocated for the next task that reuses
+ * the task structure.
+ *
+ * @param task  Task whose capability table to release.
+ */
+void caps_task_fini(task_t *task)
+{
+	cap_info_t *info = task->cap_info;
+
+	for (size_t i = 0; i < info->leaf_count; i++) {
+		cap_t *leaf = info->leaves[i];
+		for (size_t j = 0; j < CAPS_PER_LEAF; j++)
+			assert(leaf[j].state == CAP_STATE_FREE);
+		slab_free(cap_leaf_cache, leaf);
+	}
+
+	if (info->leaves)
+		free(info->leaves);
+	info->leaves = NULL;
+	info->leaf_count = 0;
+	info->leaf_max = 0;
+	list_initialize(&info->free_list);
 }
 
 /** Deallocate the capability info structure
@@ -181,8 +187,7 @@ void caps_task_init(task_t *task)
  */
 void caps_task_free(task_t *task)
 {
-	hash_table_destroy(&task->cap_info->caps);
-	ra_arena_destroy(task->cap_info->handles);
+	caps_task_fini(task);
 	free(task->cap_info);
 }
 
@@ -227,6 +232,80 @@ static void cap_initialize(cap_t *cap, task_t *task, cap_handle_t handle)
 	cap->handle = handle;
 	link_initialize(&cap->kobj_link);
 	link_initialize(&cap->type_link);
+	link_initialize(&cap->free_link);
+}
+
+/** Add a leaf of free capabilities to the capability table
+ *
+ * @param task  Task whose capability table to grow.
+ *
+ * @return EOK on success or ENOMEM if out of memory or handles.
+ */
+static errno_t caps_grow(task_t *task)
+{
+	cap_info_t *info = task->cap_info;
+
+	assert(mutex_locked(&info->lock));
+
+	intptr_t base = CAPS_START + (intptr_t) (info->leaf_count * CAPS_PER_LEAF);
+	if (base + CAPS_PER_LEAF - 1 > CAPS_LAST)
+		return ENOMEM;
+
+	if (info->leaf_count == info->leaf_max) {
+		size_t max = (info->leaf_max > 0) ? 2 * info->leaf_max :
+		    CAPS_LEAVES_INITIAL;
+		cap_t **leaves = realloc(info->leaves, max * sizeof(cap_t *));
+		if (!leaves)
+			return ENOMEM;
+		info->leaves = leaves;
+		info->leaf_max = max;
+	}
+
+	cap_t *leaf = slab_alloc(cap_leaf_cache, FRAME_ATOMIC);
+	if (!leaf)
+		return ENOMEM;
+
+	for (size_t i = 0; i < CAPS_PER_LEAF; i++) {
+		cap_initialize(&leaf[i], task, (cap_handle_t) (base + i));
+		list_append(&leaf[i].free_link, &info->free_list);
+	}
+
+	info->leaves[info->leaf_count++] = leaf;
+	return EOK;
+}
+
+/** Release the free leaves at the end of the capability table
+ *
+ * A task that used many capabilities for a while can give the memory of
+ * the table back this way.
+ *
+ * @param task  Task whose capability table to shrink.
+ */
+void caps_task_shrink(task_t *task)
+{
+	cap_info_t *info = task->cap_info;
+
+	mutex_lock(&info->lock);
+
+	while (info->leaf_count > 0) {
+		cap_t *leaf = info->leaves[info->leaf_count - 1];
+
+		size_t i;
+		for (i = 0; i < CAPS_PER_LEAF; i++) {
+			if (leaf[i].state != CAP_STATE_FREE)
+				break;
+		}
+		if (i < CAPS_PER_LEAF)
+			break;
+
+		for (i = 0; i < CAPS_PER_LEAF; i++)
+			list_remove(&leaf[i].free_link);
+
+		slab_free(cap_leaf_cache, leaf);
+		info->leaf_count--;
+	}
+
+	mutex_unlock(&info->lock);
 }
 
 /** Get capability using capability handle
@@ -245,10 +324,11 @@ static cap_t *cap_get(task_t *task, cap_handle_t handle, cap_state_t state)
 	if ((cap_handle_raw(handle) < CAPS_START) ||
 	    (cap_handle_raw(handle) > CAPS_LAST))
 		return NULL;
-	ht_link_t *link = hash_table_find(&task->cap_info->caps, &handle);
-	if (!link)
+	size_t idx = (size_t) (cap_handle_raw(handle) - CAPS_START);
+	if (idx / CAPS_PER_LEAF >= task->cap_info->leaf_count)
 		return NULL;
-	cap_t *cap = hash_table_get_inst(link, cap_t, caps_link);
+	cap_t *cap = &task->cap_info->leaves[idx / CAPS_PER_LEAF]
+	    [idx % CAPS_PER_LEAF];
 	if (cap->state != state)
 		return NULL;
 	return cap;
@@ -265,20 +345,19 @@ static cap_t *cap_get(task_t *task, cap_handle_t handle, cap_state_t state)
 errno_t cap_alloc(task_t *task, cap_handle_t *handle)
 {
 	mutex_lock(&task->cap_info->lock);
-	cap_t *cap = slab_alloc(cap_cache, FRAME_ATOMIC);
-	if (!cap) {
-		mutex_unlock(&task->cap_info->lock);
-		return ENOMEM;
-	}
-	uintptr_t hbase;
-	if (!ra_alloc(task->cap_info->handles, 1, 1, &hbase)) {
-		slab_free(cap_cache, cap);
-		mutex_unlock(&task->cap_info->lock);
-		return ENOMEM;
+	if (list_empty(&task->cap_info->free_list)) {
+		errno_t rc = caps_grow(task);
+		if (rc != EOK) {
+			mutex_unlock(&task->cap_info->lock);
+			return rc;
+		}
 	}
-	cap_initialize(cap, task, (cap_handle_t) hbase);
-	hash_table_insert(&task->cap_info->caps, &cap->caps_link);
+	cap_t *cap = list_get_instance(list_first(&task->cap_info->free_list),
+	    cap_t, free_link);
+	list_remove(&cap->free_link);
 
+	assert(cap->state == CAP_STATE_FREE);
+	cap->task = task;
 	cap->state = CAP_STATE_ALLOCATED;
 	*handle = cap->handle;
 	mutex_unlock(&task->cap_info->lock);
@@ -401,9 +480,9 @@ void cap_free(task_t *task, cap_handle_t handle)
 
 	assert(cap);
 
-	hash_table_remove_item(&task->cap_info->caps, &cap->caps_link);
-	ra_free(task->cap_info->handles, cap_handle_raw(handle), 1);
-	slab_free(cap_cache, cap);
+	/* Reuse recently freed capabilities first, they are cache-hot. */
+	cap->state = CAP_STATE_FREE;
+	list_prepend(&cap->free_link, &task->cap_info->free_list);
 	mutex_unlock(&task->cap_info->lock);
 }
 
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic
+ * @{
+ */
+
+/**
+ * @file
+ * @brief CPU affinity of tasks and threads.
+ */
+
+#include <cpu/affinity.h>
+#include <cpu/cpu_mask.h>
+#include <cpu.h>
+#include <config.h>
+#include <errno.h>
+#include <macros.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <syscall/copy.h>
+
+/** Size of the user space representation of a CPU mask in bytes. */
+static size_t cpu_affinity_uspace_size(void)
+{
+	return (config.cpu_count + 7) / 8;
+}
+
+/** Create CPU affinity from a user space CPU mask.
+ *
+ * The user space mask is an array of bytes where the bit (i % 8) of the
+ * byte (i / 8) stands for the CPU with ID i. Bits which refer to CPUs
+ * that do not exist are ignored, missing bytes are treated as zeros.
+ *
+ * @param uspace_mask User space address of the mask.
+ * @param size        Size of the mask in bytes.
+ * @param affinity    Place to store the new affinity. NULL is stored
+ *                    if @a size is zero which removes any restriction.
+ *
+ * @return EOK on success, EINVAL if the mask contains no active CPU,
+ *         ENOMEM if out of memory or an error code of copy_from_uspace().
+ *
+ */
+errno_t cpu_affinity_from_uspace(uspace_addr_t uspace_mask, size_t size,
+    cpu_affinity_t **affinity)
+{
+	if (size == 0) {
+		*affinity = NULL;
+		return EOK;
+	}
+
+	size_t bytes = min(size, cpu_affinity_uspace_size());
+	uint8_t *buf = malloc(bytes);
+	if (!buf)
+		return ENOMEM;
+
+	errno_t rc = copy_from_uspace(buf, uspace_mask, bytes);
+	if (rc != EOK) {
+		free(buf);
+		return rc;
+	}
+
+	cpu_affinity_t *new = malloc(offsetof(cpu_affinity_t, mask) +
+	    max(cpu_mask_size(), sizeof(cpu_mask_t)));
+	if (!new) {
+		free(buf);
+		return ENOMEM;
+	}
+
+	refcount_init(&new->refcount);
+	cpu_mask_none(&new->mask);
+
+	bool any_active = false;
+	for (unsigned int id = 0; id < bytes * 8; id++) {
+		if ((id >= config.cpu_count) || !(buf[id / 8] & (1 << (id % 8))))
+			continue;
+
+		cpu_mask_set(&new->mask, id);
+		if (cpus[id].active)
+			any_active = true;
+	}
+
+	free(buf);
+
+	if (!any_active) {
+		free(new);
+		return EINVAL;
+	}
+
+	*affinity = new;
+	return EOK;
+}
+
+/** Get another reference to CPU affinity.
+ *
+ * @param affinity Affinity or NULL.
+ *
+ * @return @a affinity
+ *
+ */
+cpu_affinity_t *cpu_affinity_ref(cpu_affinity_t *affinity)
+{
+	if (affinity != NULL)
+		refcount_up(&affinity->refcount);
+
+	return affinity;
+}
+
+/** Drop a reference to CPU affinity.
+ *
+ * @param affinity Affinity or NULL.
+ *
+ */
+void cpu_affinity_put(cpu_affinity_t *affinity)
+{
+	if ((affinity != NULL) && (refcount_down(&affinity->refcount)))
+		free(affinity);
+}
+
+/** Check whether the affinity allows a CPU.
+ *
+ * @param affinity Affinity or NULL for no restriction.
+ * @param cpu_id   CPU ID.
+ *
+ * @return True if a thread with the affinity may run on the CPU.
+ *
+ */
+bool cpu_affinity_allows(cpu_affinity_t *affinity, unsigned int cpu_id)
+{
+	if (affinity == NULL)
+		return true;
+
+	return cpu_mask_is_set(&affinity->mask, cpu_id);
+}
+
+/** Summarize CPU affinity for statistics.
+ *
+ * @param affinity Affinity or NULL for no restriction.
+ *
+ * @return Bitmap of the allowed CPUs among the first 64 CPUs.
+ *
+ */
+uint64_t cpu_affinity_summary(cpu_affinity_t *affinity)
+{
+	uint64_t summary = 0;
+
+	for (unsigned int id = 0; id < min(config.cpu_count, 64); id++) {
+		if (cpu_affinity_allows(affinity, id))
+			summary |= UINT64_C(1) << id;
+	}
+
+	return summary;
+}
+
+/** @}
+ */
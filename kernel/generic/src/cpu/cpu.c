@@ -92,6 +92,9 @@ void cpu_init(void)
 				irq_spinlock_initialize(&cpus[i].rq[j].lock, "cpus[].rq[].lock");
 				list_initialize(&cpus[i].rq[j].rq);
 			}
+
+			for (unsigned int j = 0; j < FRAME_CACHE_CLASSES; j++)
+				frame_cache_init(&cpus[i].frame_cache[j]);
 		}
 
 #ifdef CONFIG_SMP
@@ -51,6 +51,9 @@
 #include <ipc/sysipc_priv.h>
 #include <errno.h>
 #include <mm/slab.h>
+#include <mm/as.h>
+#include <mm/frame.h>
+#include <mm/km.h>
 #include <arch.h>
 #include <proc/task.h>
 #include <mem.h>
@@ -61,6 +64,19 @@
 #include <ipc/irq.h>
 #include <cap/cap.h>
 #include <stdlib.h>
+#include <syscall/copy.h>
+#include <align.h>
+#include <macros.h>
+#include <config.h>
+#include <cpu.h>
+#include <stddef.h>
+#include <sysinfo/sysinfo.h>
+
+/**
+ * Smallest IPC_M_DATA_WRITE or IPC_M_DATA_READ transfer for which the
+ * caller's buffer is loaned instead of being copied to a kernel buffer.
+ */
+#define IPC_LOAN_MIN  (4 * PAGE_SIZE)
 
 static void ipc_forget_call(call_t *);
 
@@ -79,23 +95,30 @@ slab_cache_t *phone_cache = NULL;
  */
 static void _ipc_call_init(call_t *call)
 {
-	memsetb(call, sizeof(*call), 0);
+	/* The inline buffer is only ever read after being written. */
+	memsetb(call, offsetof(call_t, inline_buffer), 0);
 	spinlock_initialize(&call->forget_lock, "forget_lock");
 	call->active = false;
 	call->forget = false;
 	call->sender = NULL;
 	call->callerbox = NULL;
 	call->buffer = NULL;
+	call->loan.frames = NULL;
+	call->waitq = NULL;
+	call->handoff = false;
 }
 
 static void call_destroy(void *arg)
 {
 	call_t *call = (call_t *) arg;
 
-	if (call->buffer)
+	if ((call->buffer) && (call->buffer != call->inline_buffer))
 		free(call->buffer);
+	ipc_call_loan_return(call);
 	if (call->caller_phone)
 		kobject_put(call->caller_phone->kobject);
+	if (call->waitq)
+		kobject_put(call->waitq);
 	slab_free(call_cache, call);
 }
 
@@ -103,6 +126,174 @@ kobject_ops_t call_kobject_ops = {
 	.destroy = call_destroy
 };
 
+/** Allocate a kernel buffer for the payload of a call.
+ *
+ * Small payloads are kept in the call structure itself, which comes from
+ * the per-CPU magazines of the call slab cache, so that they do not need a
+ * separate allocation. The buffer is released together with the call.
+ *
+ * @param call Call to allocate the buffer for. Must not have a buffer yet.
+ * @param size Size of the payload.
+ *
+ * @return The buffer, also stored in call->buffer, or NULL if out of memory.
+ *
+ */
+uint8_t *ipc_call_buffer_alloc(call_t *call, size_t size)
+{
+	assert(!call->buffer);
+
+	if (size <= IPC_CALL_INLINE_SIZE) {
+		call->buffer = call->inline_buffer;
+		atomic_fetch_add_explicit(&CPU->ipc_inline_buffers, 1,
+		    memory_order_relaxed);
+	} else {
+		call->buffer = malloc(size);
+		if (call->buffer)
+			atomic_fetch_add_explicit(&CPU->ipc_heap_buffers, 1,
+			    memory_order_relaxed);
+	}
+
+	return call->buffer;
+}
+
+/** Limit the size of a data transfer request.
+ *
+ * @param call  IPC_M_DATA_WRITE or IPC_M_DATA_READ request.
+ * @param limit Maximum size of the transfer.
+ *
+ * @return EOK if the transfer fits in @a limit or the caller passed
+ *         IPC_XF_RESTRICT and the transfer has been truncated to it.
+ * @return ELIMIT if the transfer is too large.
+ *
+ */
+errno_t ipc_call_xfer_limit(call_t *call, size_t limit)
+{
+	if (ipc_get_arg2(&call->data) <= limit)
+		return EOK;
+
+	if (!(ipc_get_arg3(&call->data) & IPC_XF_RESTRICT))
+		return ELIMIT;
+
+	ipc_set_arg2(&call->data, limit);
+	return EOK;
+}
+
+/** Loan the caller's buffer to a call.
+ *
+ * Large data transfers do not go through a kernel buffer. Instead, the frames
+ * backing the buffer in the current address space are loaned to the call and
+ * the data is later copied directly between them and the address space of the
+ * other party by ipc_call_loan_copy().
+ *
+ * @param call     Call to loan the buffer to.
+ * @param addr     Address of the buffer in the current address space.
+ * @param size     Size of the buffer.
+ * @param writable True if the data will be copied into the buffer, false if
+ *                 it will be copied out of the buffer.
+ *
+ * @return EOK on success.
+ * @return ENOTSUP if the buffer is too small to be worth loaning or it cannot
+ *         be loaned. The caller is expected to fall back to a kernel buffer.
+ *
+ */
+errno_t ipc_call_loan(call_t *call, uspace_addr_t addr, size_t size,
+    bool writable)
+{
+	assert(!call->buffer);
+	assert(!call->loan.frames);
+
+	if ((size < IPC_LOAN_MIN) || (addr + size < addr))
+		return ENOTSUP;
+
+	uintptr_t page = ALIGN_DOWN(addr, PAGE_SIZE);
+	size_t count = SIZE2FRAMES(addr + size - page);
+
+	as_loan_frame_t *frames = malloc(count * sizeof(as_loan_frame_t));
+	if (!frames)
+		return ENOTSUP;
+
+	errno_t rc = as_frames_loan(page, count,
+	    writable ? PF_ACCESS_WRITE : PF_ACCESS_READ, frames);
+	if (rc != EOK) {
+		free(frames);
+		return ENOTSUP;
+	}
+
+	call->loan.frames = frames;
+	call->loan.count = count;
+	call->loan.offset = addr - page;
+	call->loan.writable = writable;
+	return EOK;
+}
+
+/** Copy data between a loaned buffer and the current address space.
+ *
+ * @param call Call with a loaned buffer.
+ * @param addr Address of the data in the current address space.
+ * @param size Size of the data. Must not exceed the size of the loaned buffer.
+ *
+ * @return EOK on success or an error code from copy_to_uspace() or
+ *         copy_from_uspace().
+ *
+ */
+errno_t ipc_call_loan_copy(call_t *call, uspace_addr_t addr, size_t size)
+{
+	assert(call->loan.frames);
+	assert(call->loan.offset + size <= FRAMES2SIZE(call->loan.count));
+
+	size_t offset = call->loan.offset;
+	size_t done = 0;
+
+	for (size_t i = 0; done < size; i++) {
+		uintptr_t frame = call->loan.frames[i].frame;
+		size_t chunk = min(PAGE_SIZE - offset, size - done);
+		bool mapped = (frame >= config.identity_size);
+		uintptr_t kpage;
+		errno_t rc;
+
+		if (mapped) {
+			kpage = km_map(frame, PAGE_SIZE, PAGE_SIZE,
+			    PAGE_READ | PAGE_WRITE | PAGE_CACHEABLE);
+		} else
+			kpage = PA2KA(frame);
+
+		if (call->loan.writable) {
+			rc = copy_from_uspace((void *) (kpage + offset),
+			    addr + done, chunk);
+		} else {
+			rc = copy_to_uspace(addr + done,
+			    (void *) (kpage + offset), chunk);
+		}
+
+		if (mapped)
+			km_unmap(kpage, PAGE_SIZE);
+
+		if (rc != EOK)
+			return rc;
+
+		done += chunk;
+		offset = 0;
+	}
+
+	return EOK;
+}
+
+/** Return the buffer loaned to a call, if any.
+ *
+ * @param call Call with a possibly loaned buffer.
+ *
+ */
+void ipc_call_loan_return(call_t *call)
+{
+	if (!call->loan.frames)
+		return;
+
+	as_frames_return(call->loan.frames, call->loan.count);
+	free(call->loan.frames);
+	call->loan.frames = NULL;
+	call->loan.count = 0;
+}
+
 /** Allocate and initialize a call structure.
  *
  * The call is initialized, so that the reply will be directed to
@@ -129,6 +320,8 @@ call_t *ipc_call_alloc(void)
 	kobject_initialize(kobj, KOBJECT_TYPE_CALL, call);
 	call->kobject = kobj;
 
+	atomic_fetch_add_explicit(&CPU->ipc_calls, 1, memory_order_relaxed);
+
 	return call;
 }
 
@@ -325,7 +518,10 @@ void _ipc_answer_free_call(call_t *call, bool selflocked)
 	if (do_lock)
 		irq_spinlock_unlock(&callerbox->lock, true);
 
-	waitq_wake_one(&callerbox->wq);
+	if (call->handoff)
+		waitq_wake_one_handoff(&callerbox->wq);
+	else
+		waitq_wake_one(&callerbox->wq);
 }
 
 /** Answer a message which is in a callee queue.
@@ -415,7 +611,10 @@ static void _ipc_call(phone_t *phone, answerbox_t *box, call_t *call,
 	list_append(&call->ab_link, &box->calls);
 	irq_spinlock_unlock(&box->lock, true);
 
-	waitq_wake_one(&box->wq);
+	if (call->handoff)
+		waitq_wake_one_handoff(&box->wq);
+	else
+		waitq_wake_one(&box->wq);
 }
 
 /** Send an asynchronous request using a phone to an answerbox.
@@ -880,6 +1079,28 @@ void ipc_cleanup(void)
 	assert(atomic_load(&TASK->answerbox.active_calls) == 0);
 }
 
+/** Sum a per-CPU IPC statistics counter for sysinfo.
+ *
+ * @param item Sysinfo item (unused).
+ * @param data Offset of the counter in cpu_t.
+ *
+ * @return Sum of the counter over all CPUs.
+ *
+ */
+static sysarg_t ipc_stat_sum(sysinfo_item_t *item, void *data)
+{
+	size_t offset = (size_t) data;
+	sysarg_t sum = 0;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		atomic_size_t *counter =
+		    (atomic_size_t *) ((uint8_t *) &cpus[i] + offset);
+		sum += atomic_load_explicit(counter, memory_order_relaxed);
+	}
+
+	return sum;
+}
+
 /** Initilize IPC subsystem
  *
  */
@@ -891,6 +1112,13 @@ void ipc_init(void)
 	    NULL, 0);
 	answerbox_cache = slab_cache_create("answerbox_t", sizeof(answerbox_t),
 	    0, NULL, NULL, 0);
+
+	sysinfo_set_item_gen_val("ipc.calls", NULL, ipc_stat_sum,
+	    (void *) offsetof(cpu_t, ipc_calls));
+	sysinfo_set_item_gen_val("ipc.buffers.inline", NULL, ipc_stat_sum,
+	    (void *) offsetof(cpu_t, ipc_inline_buffers));
+	sysinfo_set_item_gen_val("ipc.buffers.heap", NULL, ipc_stat_sum,
+	    (void *) offsetof(cpu_t, ipc_heap_buffers));
 }
 
 static void ipc_print_call_list(list_t *list)
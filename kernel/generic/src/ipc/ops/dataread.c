@@ -42,18 +42,24 @@
 
 static errno_t request_preprocess(call_t *call, phone_t *phone)
 {
-	size_t size = ipc_get_arg2(&call->data);
-
-	if (size > DATA_XFER_LIMIT) {
-		int flags = ipc_get_arg3(&call->data);
-
-		if (flags & IPC_XF_RESTRICT)
-			ipc_set_arg2(&call->data, DATA_XFER_LIMIT);
-		else
-			return ELIMIT;
-	}
-
-	return EOK;
+	uspace_addr_t dst = ipc_get_arg1(&call->data);
+
+	errno_t rc = ipc_call_xfer_limit(call, DATA_XFER_LOAN_LIMIT);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Large transfers are copied straight into the receiver's buffer when
+	 * the sender answers.
+	 */
+	if (ipc_call_loan(call, dst, ipc_get_arg2(&call->data), true) == EOK)
+		return EOK;
+
+	/*
+	 * The data will go through a kernel buffer, which can hold only
+	 * DATA_XFER_LIMIT bytes.
+	 */
+	return ipc_call_xfer_limit(call, DATA_XFER_LIMIT);
 }
 
 static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
@@ -74,8 +80,16 @@ static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
 			 */
 			ipc_set_arg1(&answer->data, dst);
 
-			answer->buffer = malloc(size);
-			if (!answer->buffer) {
+			if (answer->loan.frames) {
+				errno_t rc = ipc_call_loan_copy(answer, src,
+				    size);
+				if (rc)
+					ipc_set_retval(&answer->data, rc);
+				ipc_call_loan_return(answer);
+				return EOK;
+			}
+
+			if (!ipc_call_buffer_alloc(answer, size)) {
 				ipc_set_retval(&answer->data, ENOMEM);
 				return EOK;
 			}
@@ -43,22 +43,27 @@
 static errno_t request_preprocess(call_t *call, phone_t *phone)
 {
 	uspace_addr_t src = ipc_get_arg1(&call->data);
-	size_t size = ipc_get_arg2(&call->data);
 
-	if (size > DATA_XFER_LIMIT) {
-		int flags = ipc_get_arg3(&call->data);
+	errno_t rc = ipc_call_xfer_limit(call, DATA_XFER_LOAN_LIMIT);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Large transfers are copied straight from the sender's buffer when
+	 * the recipient answers.
+	 */
+	if (ipc_call_loan(call, src, ipc_get_arg2(&call->data), false) == EOK)
+		return EOK;
 
-		if (flags & IPC_XF_RESTRICT) {
-			size = DATA_XFER_LIMIT;
-			ipc_set_arg2(&call->data, size);
-		} else
-			return ELIMIT;
-	}
+	/* Only DATA_XFER_LIMIT bytes may go through a kernel buffer. */
+	rc = ipc_call_xfer_limit(call, DATA_XFER_LIMIT);
+	if (rc != EOK)
+		return rc;
 
-	call->buffer = (uint8_t *) malloc(size);
-	if (!call->buffer)
+	size_t size = ipc_get_arg2(&call->data);
+	if (!ipc_call_buffer_alloc(call, size))
 		return ENOMEM;
-	errno_t rc = copy_from_uspace(call->buffer, src, size);
+	rc = copy_from_uspace(call->buffer, src, size);
 	if (rc != EOK) {
 		/*
 		 * call->buffer will be cleaned up in ipc_call_free() at the
@@ -72,7 +77,7 @@ static errno_t request_preprocess(call_t *call, phone_t *phone)
 
 static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
 {
-	assert(answer->buffer);
+	assert(answer->buffer || answer->loan.frames);
 
 	if (!ipc_get_retval(&answer->data)) {
 		/* The recipient agreed to receive data. */
@@ -81,8 +86,12 @@ static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
 		size_t max_size = ipc_get_arg2(olddata);
 
 		if (size <= max_size) {
-			errno_t rc = copy_to_uspace(dst,
-			    answer->buffer, size);
+			errno_t rc;
+
+			if (answer->loan.frames)
+				rc = ipc_call_loan_copy(answer, dst, size);
+			else
+				rc = copy_to_uspace(dst, answer->buffer, size);
 			if (rc)
 				ipc_set_retval(&answer->data, rc);
 		} else {
@@ -90,6 +99,9 @@ static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
 		}
 	}
 
+	/* The sender's buffer is no longer needed. */
+	ipc_call_loan_return(answer);
+
 	return EOK;
 }
 
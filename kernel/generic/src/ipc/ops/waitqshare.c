@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+/** @file
+ */
+
+
+#include <ipc/sysipc_ops.h>
+#include <ipc/ipc.h>
+#include <cap/cap.h>
+#include <proc/task.h>
+#include <abi/errno.h>
+#include <arch.h>
+
+static errno_t request_preprocess(call_t *call, phone_t *phone)
+{
+	cap_waitq_handle_t whandle = (cap_handle_t) ipc_get_arg1(&call->data);
+
+	/* The call holds the reference until it is destroyed. */
+	call->waitq = kobject_get(TASK, whandle, KOBJECT_TYPE_WAITQ);
+	if (!call->waitq)
+		return ENOENT;
+
+	return EOK;
+}
+
+static int request_process(call_t *call, answerbox_t *box)
+{
+	/*
+	 * Allocate the recipient's capability now, but only publish it once
+	 * the recipient accepts the wait queue.
+	 */
+	cap_waitq_handle_t whandle = CAP_NIL;
+	if (cap_alloc(TASK, &whandle) != EOK)
+		whandle = CAP_NIL;
+
+	ipc_set_arg1(&call->data, cap_handle_raw(whandle));
+	return 0;
+}
+
+static errno_t answer_cleanup(call_t *answer, ipc_data_t *olddata)
+{
+	cap_waitq_handle_t whandle = (cap_handle_t) ipc_get_arg1(olddata);
+
+	if (cap_handle_valid(whandle))
+		cap_free(TASK, whandle);
+
+	return EOK;
+}
+
+static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
+{
+	cap_waitq_handle_t whandle = (cap_handle_t) ipc_get_arg1(olddata);
+
+	if (ipc_get_retval(&answer->data) != EOK) {
+		/* The wait queue was not accepted */
+		answer_cleanup(answer, olddata);
+	} else if (cap_handle_valid(whandle)) {
+		/* Give the capability a reference of its own */
+		kobject_add_ref(answer->waitq);
+		cap_publish(TASK, whandle, answer->waitq);
+	} else {
+		ipc_set_retval(&answer->data, ELIMIT);
+	}
+
+	return EOK;
+}
+
+sysipc_ops_t ipc_m_waitq_share_ops = {
+	.request_preprocess = request_preprocess,
+	.request_forget = null_request_forget,
+	.request_process = request_process,
+	.answer_cleanup = answer_cleanup,
+	.answer_preprocess = answer_preprocess,
+	.answer_process = null_answer_process,
+};
+
+/** @}
+ */
@@ -110,6 +110,7 @@ static inline bool method_is_immutable(sysarg_t imethod)
 	case IPC_M_DATA_WRITE:
 	case IPC_M_DATA_READ:
 	case IPC_M_STATE_CHANGE_AUTHORIZE:
+	case IPC_M_WAITQ_SHARE:
 		return true;
 	default:
 		return false;
@@ -139,6 +140,7 @@ static inline bool answer_need_old(call_t *call)
 	case IPC_M_DATA_WRITE:
 	case IPC_M_DATA_READ:
 	case IPC_M_STATE_CHANGE_AUTHORIZE:
+	case IPC_M_WAITQ_SHARE:
 		return true;
 	default:
 		return false;
@@ -398,6 +400,9 @@ sys_errno_t sys_ipc_call_async_fast(cap_phone_handle_t handle, sysarg_t imethod,
 	/* Set the user-defined label */
 	call->data.answer_label = label;
 
+	/* System methods may carry more than registers. */
+	call->handoff = !method_is_system(imethod);
+
 	errno_t res = request_preprocess(call, kobj->phone);
 
 	if (!res)
@@ -409,17 +414,17 @@ sys_errno_t sys_ipc_call_async_fast(cap_phone_handle_t handle, sysarg_t imethod,
 	return EOK;
 }
 
-/** Make an asynchronous IPC call allowing to transmit the entire payload.
+/** Make an asynchronous IPC call with the entire payload already in kernel.
  *
  * @param handle  Phone capability for the call.
- * @param data    Userspace address of call data with the request.
+ * @param args    Method and arguments of the call.
  * @param label   User-defined label.
  *
  * @return See sys_ipc_call_async_fast().
  *
  */
-sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_data_t data,
-    sysarg_t label)
+static errno_t ipc_call_async_args(cap_phone_handle_t handle,
+    const sysarg_t args[IPC_CALL_LEN], sysarg_t label)
 {
 	kobject_t *kobj = kobject_get(TASK, handle, KOBJECT_TYPE_PHONE);
 	if (!kobj)
@@ -436,17 +441,14 @@ sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_da
 		return ENOMEM;
 	}
 
-	errno_t rc = copy_from_uspace(&call->data.args, data + offsetof(ipc_data_t, args),
-	    sizeof(call->data.args));
-	if (rc != EOK) {
-		kobject_put(call->kobject);
-		kobject_put(kobj);
-		return (sys_errno_t) rc;
-	}
+	memcpy(call->data.args, args, sizeof(call->data.args));
 
 	/* Set the user-defined label */
 	call->data.answer_label = label;
 
+	/* System methods may carry more than registers. */
+	call->handoff = !method_is_system(ipc_get_imethod(&call->data));
+
 	errno_t res = request_preprocess(call, kobj->phone);
 
 	if (!res)
@@ -458,6 +460,28 @@ sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_da
 	return EOK;
 }
 
+/** Make an asynchronous IPC call allowing to transmit the entire payload.
+ *
+ * @param handle  Phone capability for the call.
+ * @param data    Userspace address of call data with the request.
+ * @param label   User-defined label.
+ *
+ * @return See sys_ipc_call_async_fast().
+ *
+ */
+sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_data_t data,
+    sysarg_t label)
+{
+	sysarg_t args[IPC_CALL_LEN];
+
+	errno_t rc = copy_from_uspace(args, data + offsetof(ipc_data_t, args),
+	    sizeof(args));
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	return (sys_errno_t) ipc_call_async_args(handle, args, label);
+}
+
 /** Forward a received call to another destination
  *
  * Common code for both the fast and the slow version.
@@ -691,15 +715,16 @@ sys_errno_t sys_ipc_answer_fast(cap_call_handle_t chandle, sysarg_t retval,
 	return rc;
 }
 
-/** Answer an IPC call.
+/** Answer an IPC call with the entire payload already in kernel.
  *
  * @param chandle Call handle to be answered.
- * @param data    Userspace address of call data with the answer.
+ * @param args    Return value and arguments of the answer.
  *
  * @return 0 on success, otherwise an error code.
  *
  */
-sys_errno_t sys_ipc_answer_slow(cap_call_handle_t chandle, uspace_ptr_ipc_data_t data)
+static errno_t ipc_answer_args(cap_call_handle_t chandle,
+    const sysarg_t args[IPC_CALL_LEN])
 {
 	kobject_t *kobj = cap_unpublish(TASK, chandle, KOBJECT_TYPE_CALL);
 	if (!kobj)
@@ -717,17 +742,9 @@ sys_errno_t sys_ipc_answer_slow(cap_call_handle_t chandle, uspace_ptr_ipc_data_t
 	} else
 		saved = false;
 
-	errno_t rc = copy_from_uspace(&call->data.args, data + offsetof(ipc_data_t, args),
-	    sizeof(call->data.args));
-	if (rc != EOK) {
-		/*
-		 * Republish the capability so that the call does not get lost.
-		 */
-		cap_publish(TASK, chandle, kobj);
-		return rc;
-	}
+	memcpy(call->data.args, args, sizeof(call->data.args));
 
-	rc = answer_preprocess(call, saved ? &saved_data : NULL);
+	errno_t rc = answer_preprocess(call, saved ? &saved_data : NULL);
 
 	ipc_answer(&TASK->answerbox, call);
 
@@ -737,6 +754,77 @@ sys_errno_t sys_ipc_answer_slow(cap_call_handle_t chandle, uspace_ptr_ipc_data_t
 	return rc;
 }
 
+/** Answer an IPC call.
+ *
+ * @param chandle Call handle to be answered.
+ * @param data    Userspace address of call data with the answer.
+ *
+ * @return 0 on success, otherwise an error code.
+ *
+ */
+sys_errno_t sys_ipc_answer_slow(cap_call_handle_t chandle, uspace_ptr_ipc_data_t data)
+{
+	sysarg_t args[IPC_CALL_LEN];
+
+	/*
+	 * Fetch the answer before the call is unpublished so that the call
+	 * does not get lost if the copy fails.
+	 */
+	errno_t rc = copy_from_uspace(args, data + offsetof(ipc_data_t, args),
+	    sizeof(args));
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	return (sys_errno_t) ipc_answer_args(chandle, args);
+}
+
+/** Make and answer several IPC calls in one go.
+ *
+ * The entries are processed in order. The outcome of each is stored in its
+ * rc member, which has the same meaning as the return value of
+ * sys_ipc_call_async_slow() or sys_ipc_answer_slow(), respectively.
+ *
+ * @param ops    Userspace address of an array of submission entries.
+ * @param count  Number of entries in the array.
+ *
+ * @return EOK if all entries were processed. Otherwise an error code, in
+ *         which case the entries with the rc member not yet updated were not
+ *         processed.
+ *
+ */
+sys_errno_t sys_ipc_submit(uspace_ptr_ipc_submit_t ops, sysarg_t count)
+{
+	for (sysarg_t i = 0; i < count; i++) {
+		uspace_ptr_ipc_submit_t entry = ops + i * sizeof(ipc_submit_t);
+		ipc_submit_t op;
+
+		errno_t rc = copy_from_uspace(&op, entry, sizeof(op));
+		if (rc != EOK)
+			return (sys_errno_t) rc;
+
+		switch (op.op) {
+		case IPC_SUBMIT_CALL:
+			rc = ipc_call_async_args((cap_phone_handle_t) op.handle,
+			    op.args, op.label);
+			break;
+		case IPC_SUBMIT_ANSWER:
+			rc = ipc_answer_args((cap_call_handle_t) op.handle,
+			    op.args);
+			break;
+		default:
+			rc = EINVAL;
+			break;
+		}
+
+		errno_t copy_rc = copy_to_uspace(entry + offsetof(ipc_submit_t, rc),
+		    &rc, sizeof(rc));
+		if (copy_rc != EOK)
+			return (sys_errno_t) copy_rc;
+	}
+
+	return EOK;
+}
+
 /** Hang up a phone.
  *
  * @param handle  Phone capability handle of the phone to be hung up.
@@ -756,7 +844,7 @@ sys_errno_t sys_ipc_hangup(cap_phone_handle_t handle)
 	return rc;
 }
 
-/** Wait for an incoming IPC call or an answer.
+/** Wait for an incoming IPC call or an answer and pass it to userspace.
  *
  * @param calldata Pointer to buffer where the call/answer data is stored.
  * @param usec     Timeout. See waitq_sleep_timeout() for explanation.
@@ -765,7 +853,7 @@ sys_errno_t sys_ipc_hangup(cap_phone_handle_t handle)
  *
  * @return An error code on error.
  */
-sys_errno_t sys_ipc_wait_for_call(uspace_ptr_ipc_data_t calldata, uint32_t usec,
+static errno_t ipc_wait_one(uspace_ptr_ipc_data_t calldata, uint32_t usec,
     unsigned int flags)
 {
 	call_t *call = NULL;
@@ -865,6 +953,61 @@ error:
 	return rc;
 }
 
+/** Wait for an incoming IPC call or an answer.
+ *
+ * @param calldata Pointer to buffer where the call/answer data is stored.
+ * @param usec     Timeout. See waitq_sleep_timeout() for explanation.
+ * @param flags    Select mode of sleep operation. See waitq_sleep_timeout()
+ *                 for explanation.
+ *
+ * @return An error code on error.
+ */
+sys_errno_t sys_ipc_wait_for_call(uspace_ptr_ipc_data_t calldata, uint32_t usec,
+    unsigned int flags)
+{
+	return (sys_errno_t) ipc_wait_one(calldata, usec, flags);
+}
+
+/** Wait for incoming IPC calls or answers and receive several at once.
+ *
+ * Waits for the first call or answer like sys_ipc_wait_for_call() and then
+ * drains up to @a count - 1 more from the answerbox without blocking.
+ *
+ * @param calldata Pointer to an array of @a count buffers where the
+ *                 call/answer data is stored.
+ * @param count    Maximum number of calls and answers to receive.
+ * @param received Pointer to where the number of received calls and
+ *                 answers is stored.
+ * @param usec     Timeout of the wait for the first call or answer. See
+ *                 waitq_sleep_timeout() for explanation.
+ * @param flags    Select mode of the sleep for the first call or answer.
+ *                 See waitq_sleep_timeout() for explanation.
+ *
+ * @return An error code if not even the first call or answer was received.
+ */
+sys_errno_t sys_ipc_wait_multi(uspace_ptr_ipc_data_t calldata,
+    sysarg_t count, uspace_ptr_size_t received, uint32_t usec,
+    unsigned int flags)
+{
+	if (count == 0)
+		return EINVAL;
+
+	errno_t rc = ipc_wait_one(calldata, usec, flags);
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	size_t n = 1;
+	while (n < count) {
+		rc = ipc_wait_one(calldata + n * sizeof(ipc_data_t),
+		    SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NON_BLOCKING);
+		if (rc != EOK)
+			break;
+		n++;
+	}
+
+	return (sys_errno_t) copy_to_uspace(received, &n, sizeof(n));
+}
+
 /** Interrupt one thread from sys_ipc_wait_for_call().
  *
  */
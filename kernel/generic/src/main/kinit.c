@@ -109,8 +109,7 @@ void kinit(void *arg)
 
 		/*
 		 * Create the kmp thread and wait for its completion.
-		 * cpu1 through cpuN-1 will come up consecutively and
-		 * not mess together with kcpulb threads.
+		 * cpu1 through cpuN-1 will come up consecutively.
 		 * Just a beautification.
 		 */
 		thread = thread_create(kmp, NULL, TASK,
@@ -122,22 +121,6 @@ void kinit(void *arg)
 		thread_ready(thread_ref(thread));
 		thread_join(thread);
 		thread_put(thread);
-
-		/*
-		 * For each CPU, create its load balancing thread.
-		 */
-		unsigned int i;
-
-		for (i = 0; i < config.cpu_count; i++) {
-			thread = thread_create(kcpulb, NULL, TASK,
-			    THREAD_FLAG_UNCOUNTED, "kcpulb");
-			if (thread != NULL) {
-				thread_wire(thread, &cpus[i]);
-				thread_ready(thread);
-			} else
-				log(LF_OTHER, LVL_ERROR,
-				    "Unable to create kcpulb thread for cpu%u", i);
-		}
 	}
 #endif /* CONFIG_SMP */
 
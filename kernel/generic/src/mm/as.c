@@ -53,6 +53,7 @@
 #include <mm/frame.h>
 #include <mm/slab.h>
 #include <mm/tlb.h>
+#include <cpu/cpu_mask.h>
 #include <arch/mm/page.h>
 #include <genarch/mm/page_pt.h>
 #include <genarch/mm/page_ht.h>
@@ -172,6 +173,17 @@ as_t *as_create(unsigned int flags)
 	if (!as)
 		return NULL;
 
+	if (flags & FLAG_AS_KERNEL) {
+		as->cpu_mask = NULL;
+	} else {
+		as->cpu_mask = malloc(max(cpu_mask_size(), sizeof(cpu_mask_t)));
+		if (!as->cpu_mask) {
+			slab_free(as_cache, as);
+			return NULL;
+		}
+		cpu_mask_none(as->cpu_mask);
+	}
+
 	(void) as_create_arch(as, 0);
 
 	odict_initialize(&as->as_areas, as_areas_getkey, as_areas_cmp);
@@ -269,6 +281,9 @@ retry:
 	page_table_destroy(NULL);
 #endif
 
+	if (as->cpu_mask)
+		free(as->cpu_mask);
+
 	slab_free(as_cache, as);
 }
 
@@ -721,9 +736,59 @@ _NO_TRACE static void sh_info_remove_reference(share_info_t *sh_info)
 	}
 }
 
+/** Fault in all pages of a newly created address space area.
+ *
+ * Pages which the backend fails to provide are left to be faulted in on
+ * demand later.
+ *
+ * The area must belong to the current address space, which must be locked.
+ *
+ * @param area Address space area to be populated.
+ *
+ */
+static void as_area_populate(as_area_t *area)
+{
+	assert(area->as == AS);
+	assert(mutex_locked(&AS->lock));
+
+	if ((!area->backend) || (!area->backend->page_fault))
+		return;
+
+	pf_access_t access;
+	if (area->flags & AS_AREA_WRITE)
+		access = PF_ACCESS_WRITE;
+	else if (area->flags & AS_AREA_READ)
+		access = PF_ACCESS_READ;
+	else if (area->flags & AS_AREA_EXEC)
+		access = PF_ACCESS_EXEC;
+	else
+		return;
+
+	mutex_lock(&area->lock);
+	page_table_lock(AS, false);
+
+	for (size_t i = 0; i < area->pages; i++) {
+		uintptr_t page = area->base + P2SZ(i);
+
+		/* The backend may have mapped more than one page at once. */
+		pte_t pte;
+		if (page_mapping_find(AS, page, false, &pte) &&
+		    PTE_PRESENT(&pte))
+			continue;
+
+		if (area->backend->page_fault(area, page, access) != AS_PF_OK)
+			break;
+	}
+
+	page_table_unlock(AS, false);
+	mutex_unlock(&area->lock);
+}
+
 /** Create address space area of common attributes.
  *
  * The created address space area is added to the target address space.
+ * Areas created in the current address space with AS_AREA_POPULATE are
+ * faulted in completely right away.
  *
  * @param as           Target address space.
  * @param flags        Flags of the area memory.
@@ -846,6 +911,10 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	used_space_initialize(&area->used_space);
 	odict_insert(&area->las_areas, &as->as_areas, NULL);
 
+	if ((flags & AS_AREA_POPULATE) && (as == AS) &&
+	    !(attrs & AS_AREA_ATTR_PARTIAL))
+		as_area_populate(area);
+
 	mutex_unlock(&as->lock);
 
 	return area;
@@ -954,8 +1023,8 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 		 * Start TLB shootdown sequence.
 		 */
 
-		ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES,
-		    as->asid, area->base + P2SZ(pages),
+		ipl_t ipl = tlb_shootdown_start(as->cpu_mask,
+		    TLB_INVL_PAGES, as->asid, area->base + P2SZ(pages),
 		    area->pages - pages);
 
 		/*
@@ -1079,6 +1148,134 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 	return 0;
 }
 
+/** Discard pages of an address space area.
+ *
+ * Frames backing the pages in the given range are released and the pages
+ * are unmapped. The area itself is left intact, so the next access to a
+ * discarded page faults it in again as if it had never been touched.
+ * Anonymous memory is thus read back as zeros.
+ *
+ * @param as      Address space.
+ * @param address Start of the range to discard. Must be page-aligned.
+ * @param size    Size of the range to discard. Must be page-aligned and the
+ *                range must lie within a single address space area.
+ *
+ * @return Zero on success or a value from @ref errno.h otherwise.
+ *
+ */
+errno_t as_area_discard(as_t *as, uintptr_t address, size_t size)
+{
+	if (!IS_ALIGNED(address, PAGE_SIZE) || !IS_ALIGNED(size, PAGE_SIZE))
+		return EINVAL;
+
+	if (size == 0)
+		return EOK;
+
+	if (overflows(address, size))
+		return EINVAL;
+
+	mutex_lock(&as->lock);
+
+	as_area_t *area = find_area_and_lock(as, address);
+	if (!area) {
+		mutex_unlock(&as->lock);
+		return ENOENT;
+	}
+
+	if (address + size > area->base + P2SZ(area->pages)) {
+		mutex_unlock(&area->lock);
+		mutex_unlock(&as->lock);
+		return EINVAL;
+	}
+
+	if ((!area->backend->is_discardable) ||
+	    (!area->backend->is_discardable(area))) {
+		mutex_unlock(&area->lock);
+		mutex_unlock(&as->lock);
+		return ENOTSUP;
+	}
+
+	mutex_lock(&area->sh_info->lock);
+	if (area->sh_info->shared) {
+		/*
+		 * Frames of shared areas are tracked in the pagemap
+		 * and may be mapped by other address spaces.
+		 */
+		mutex_unlock(&area->sh_info->lock);
+		mutex_unlock(&area->lock);
+		mutex_unlock(&as->lock);
+		return ENOTSUP;
+	}
+	mutex_unlock(&area->sh_info->lock);
+
+	size_t count = SIZE2FRAMES(size);
+	uintptr_t end = address + size;
+
+	page_table_lock(as, false);
+
+	ipl_t ipl = tlb_shootdown_start(as->cpu_mask, TLB_INVL_PAGES,
+	    as->asid, address, count);
+
+	/*
+	 * Only the used space can have frames mapped, so walk the intervals
+	 * of used space that overlap with the discarded range.
+	 */
+	used_space_ival_t *ival =
+	    used_space_find_gteq(&area->used_space, address);
+	while ((ival != NULL) && (ival->page < end)) {
+		used_space_ival_t *next = used_space_next(ival);
+
+		uintptr_t ival_end = ival->page + P2SZ(ival->count);
+		uintptr_t from = max(ival->page, address);
+		uintptr_t to = min(ival_end, end);
+
+		for (uintptr_t page = from; page < to; page += PAGE_SIZE) {
+			pte_t pte;
+			bool found = page_mapping_find(as, page, false, &pte);
+
+			(void) found;
+			assert(found);
+			assert(PTE_VALID(&pte));
+			assert(PTE_PRESENT(&pte));
+
+			if (area->backend->frame_free) {
+				area->backend->frame_free(area, page,
+				    PTE_GET_FRAME(&pte));
+			}
+
+			page_mapping_remove(as, page);
+		}
+
+		/* Keep the parts of the interval outside of the range. */
+		if (ival->page < from)
+			used_space_shorten_ival(ival, (from - ival->page) >> PAGE_WIDTH);
+		else
+			used_space_remove_ival(ival);
+
+		if ((ival_end > to) && (!used_space_insert(&area->used_space,
+		    to, (ival_end - to) >> PAGE_WIDTH)))
+			panic("Cannot insert used space.");
+
+		ival = next;
+	}
+
+	tlb_invalidate_pages(as->asid, address, count);
+
+	/*
+	 * Invalidate software translation caches
+	 * (e.g. TSB on sparc64, PHT on ppc32).
+	 */
+	as_invalidate_translation_cache(as, address, count);
+	tlb_shootdown_finalize(ipl);
+
+	page_table_unlock(as, false);
+
+	mutex_unlock(&area->lock);
+	mutex_unlock(&as->lock);
+
+	return EOK;
+}
+
 /** Destroy address space area.
  *
  * @param as      Address space.
@@ -1104,7 +1301,8 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	/*
 	 * Start TLB shootdown sequence.
 	 */
-	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as->asid, area->base,
+	ipl_t ipl = tlb_shootdown_start(as->cpu_mask, TLB_INVL_PAGES,
+	    as->asid, area->base,
 	    area->pages);
 
 	/*
@@ -1404,7 +1602,8 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	/*
 	 * Start TLB shootdown sequence.
 	 */
-	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as->asid, area->base,
+	ipl_t ipl = tlb_shootdown_start(as->cpu_mask, TLB_INVL_PAGES,
+	    as->asid, area->base,
 	    area->pages);
 
 	/*
@@ -1607,6 +1806,111 @@ page_fault:
 	return AS_PF_DEFER;
 }
 
+/** Loan frames backing a range of pages of the current address space.
+ *
+ * Pages which are not yet present are faulted in. Each loaned frame gets an
+ * extra reference so that it stays valid even if the address space unmaps it
+ * in the meantime. Only frames of anonymous memory can be loaned.
+ *
+ * @param page   First page of the range.
+ * @param count  Number of pages in the range.
+ * @param access Access that must be allowed on the whole range.
+ * @param frames Array of count entries to be filled with the loaned
+ *               frames.
+ *
+ * @return EOK on success.
+ * @return ENOTSUP if part of the range is not anonymous memory or does not
+ *         allow the access.
+ * @return EFAULT if part of the range is not mapped or cannot be faulted in.
+ *
+ */
+errno_t as_frames_loan(uintptr_t page, size_t count, pf_access_t access,
+    as_loan_frame_t *frames)
+{
+	assert(IS_ALIGNED(page, PAGE_SIZE));
+
+	errno_t rc = EOK;
+	size_t i = 0;
+
+	mutex_lock(&AS->lock);
+
+	while ((i < count) && (rc == EOK)) {
+		as_area_t *area = find_area_and_lock(AS, page + P2SZ(i));
+		if (!area) {
+			rc = EFAULT;
+			break;
+		}
+
+		if ((area->backend != &anon_backend) ||
+		    (area->attributes & AS_AREA_ATTR_PARTIAL) ||
+		    (!as_area_check_access(area, access))) {
+			mutex_unlock(&area->lock);
+			rc = ENOTSUP;
+			break;
+		}
+
+		page_table_lock(AS, false);
+
+		uintptr_t end = area->base + P2SZ(area->pages);
+		for (; (i < count) && (page + P2SZ(i) < end); i++) {
+			uintptr_t upage = page + P2SZ(i);
+			pte_t pte;
+
+			bool found = page_mapping_find(AS, upage, false, &pte);
+			bool present = found && PTE_PRESENT(&pte) &&
+			    ((access != PF_ACCESS_WRITE) || PTE_WRITABLE(&pte));
+			if (!present) {
+				if (area->backend->page_fault(area, upage,
+				    access) != AS_PF_OK) {
+					rc = EFAULT;
+					break;
+				}
+
+				found = page_mapping_find(AS, upage, false,
+				    &pte);
+				assert(found);
+				assert(PTE_PRESENT(&pte));
+			}
+
+			frames[i].frame = PTE_GET_FRAME(&pte);
+			frames[i].late_reserve =
+			    (area->flags & AS_AREA_LATE_RESERVE) != 0;
+			frame_reference_add(ADDR2PFN(frames[i].frame));
+		}
+
+		page_table_unlock(AS, false);
+		mutex_unlock(&area->lock);
+	}
+
+	mutex_unlock(&AS->lock);
+
+	if (rc != EOK)
+		as_frames_return(frames, i);
+
+	return rc;
+}
+
+/** Return frames loaned by as_frames_loan().
+ *
+ * The loan may outlive the mapping of a frame, so the frame is released the
+ * same way its area would release it. Frames of late reserve areas give back
+ * their reservation when the last reference goes away, frames of other areas
+ * leave it to the area, see anon_frame_free().
+ *
+ * @param frames Loaned frames.
+ * @param count  Number of loaned frames.
+ *
+ */
+void as_frames_return(as_loan_frame_t *frames, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (frames[i].late_reserve)
+			frame_free(frames[i].frame, 1);
+		else
+			frame_free_noreserve(frames[i].frame, 1);
+	}
+}
+
 /** Switch address spaces.
  *
  * Note that this function cannot sleep as it is essentially a part of
@@ -1675,6 +1979,14 @@ retry:
 			new_as->asid = asid_get();
 	}
 
+	/*
+	 * Make sure TLB shootdowns of the new address space reach this
+	 * processor before it can cache any of its translations.
+	 */
+	if ((new_as->cpu_mask != NULL) &&
+	    (!cpu_mask_is_set(new_as->cpu_mask, CPU->id)))
+		tlb_shootdown_cpu_add(new_as->cpu_mask);
+
 #ifdef AS_PAGE_TABLE
 	SET_PTL0_ADDRESS(new_as->genarch.page_table);
 #endif
@@ -2160,6 +2472,11 @@ sys_errno_t sys_as_area_destroy(uintptr_t address)
 	return (sys_errno_t) as_area_destroy(AS, address);
 }
 
+sys_errno_t sys_as_area_discard(uintptr_t address, size_t size)
+{
+	return (sys_errno_t) as_area_discard(AS, address, size);
+}
+
 /** Get list of address space areas.
  *
  * @param as    Address space.
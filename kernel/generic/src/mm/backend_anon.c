@@ -50,6 +50,7 @@
 #include <errno.h>
 #include <typedefs.h>
 #include <align.h>
+#include <macros.h>
 #include <mem.h>
 #include <arch.h>
 
@@ -60,6 +61,7 @@ static void anon_destroy(as_area_t *);
 
 static bool anon_is_resizable(as_area_t *);
 static bool anon_is_shareable(as_area_t *);
+static bool anon_is_discardable(as_area_t *);
 
 static int anon_page_fault(as_area_t *, uintptr_t, pf_access_t);
 static void anon_frame_free(as_area_t *, uintptr_t, uintptr_t);
@@ -72,6 +74,7 @@ mem_backend_t anon_backend = {
 
 	.is_resizable = anon_is_resizable,
 	.is_shareable = anon_is_shareable,
+	.is_discardable = anon_is_discardable,
 
 	.page_fault = anon_page_fault,
 	.frame_free = anon_frame_free,
@@ -170,6 +173,63 @@ bool anon_is_shareable(as_area_t *area)
 	return !(area->flags & AS_AREA_LATE_RESERVE);
 }
 
+/** Discarded anonymous pages are simply faulted in again as zero pages. */
+bool anon_is_discardable(as_area_t *area)
+{
+	return true;
+}
+
+/** Try to back the large page containing the faulting page at once.
+ *
+ * Areas created with AS_AREA_LARGE_PAGES have every large page that lies
+ * completely inside the area and has no page mapped yet backed by a single
+ * large page mapping of physically contiguous frames. If the frames are not
+ * available, the caller falls back to mapping just the faulting page.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param upage Faulting virtual page.
+ *
+ * @return True if the large page was mapped, false otherwise.
+ */
+static bool anon_large_page_fault(as_area_t *area, uintptr_t upage)
+{
+	size_t large = page_mapping_large_size();
+
+	if ((large == 0) || !(area->flags & AS_AREA_LARGE_PAGES) ||
+	    (area->flags & AS_AREA_LATE_RESERVE))
+		return false;
+
+	uintptr_t base = ALIGN_DOWN(upage, large);
+	if ((base < area->base) ||
+	    (base + large > area->base + P2SZ(area->pages)))
+		return false;
+
+	used_space_ival_t *ival = used_space_find_gteq(&area->used_space, base);
+	if ((ival != NULL) && (ival->page < base + large))
+		return false;
+
+	/*
+	 * The frames are zeroed through the identity mapping, so they must
+	 * come from low memory. Do not fight for them, the fallback is fine.
+	 */
+	uintptr_t frame = frame_alloc(SIZE2FRAMES(large), FRAME_LOWMEM |
+	    FRAME_ATOMIC | FRAME_NO_RECLAIM | FRAME_NO_RESERVE, large - 1);
+	if (frame == 0)
+		return false;
+
+	memsetb((void *) PA2KA(frame), large, 0);
+
+	page_mapping_insert_large(area->as, base, frame,
+	    as_area_get_flags(area));
+	if (!used_space_insert(&area->used_space, base,
+	    large >> PAGE_WIDTH))
+		panic("Cannot insert used space.");
+
+	return true;
+}
+
 /** Service a page fault in the anonymous memory address space area.
  *
  * The address space area and page tables must be already locked.
@@ -186,7 +246,7 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	uintptr_t kpage;
 	uintptr_t frame;
 
-	assert(page_table_locked(AS));
+	assert(page_table_locked(area->as));
 	assert(mutex_locked(&area->lock));
 	assert(IS_ALIGNED(upage, PAGE_SIZE));
 
@@ -236,6 +296,11 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		 *   the different causes
 		 */
 
+		if (anon_large_page_fault(area, upage)) {
+			mutex_unlock(&area->sh_info->lock);
+			return AS_PF_OK;
+		}
+
 		if (area->flags & AS_AREA_LATE_RESERVE) {
 			/*
 			 * Reserve the memory for this page now.
@@ -257,7 +322,7 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	 * Note that TLB shootdown is not attempted as only new information is
 	 * being inserted into page tables.
 	 */
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+	page_mapping_insert(area->as, upage, frame, as_area_get_flags(area));
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
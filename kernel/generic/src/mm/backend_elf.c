@@ -52,6 +52,9 @@
 #include <arch.h>
 #include <barrier.h>
 
+/** Maximum number of pages mapped by a single fault in the ELF image. */
+#define ELF_FAULT_AROUND_PAGES  16
+
 static bool elf_create(as_area_t *);
 static bool elf_resize(as_area_t *, size_t);
 static void elf_share(as_area_t *);
@@ -71,6 +74,7 @@ mem_backend_t elf_backend = {
 
 	.is_resizable = elf_is_resizable,
 	.is_shareable = elf_is_shareable,
+	.is_discardable = NULL,
 
 	.page_fault = elf_page_fault,
 	.frame_free = elf_frame_free,
@@ -243,6 +247,60 @@ bool elf_is_shareable(as_area_t *area)
 	return true;
 }
 
+/** Map pages of the ELF image surrounding a faulting page.
+ *
+ * Pages of read-only segments backed directly by the ELF image are always
+ * present in memory, so instead of waiting for them to be faulted in one by
+ * one, map the unmapped ones from the naturally aligned window of
+ * ELF_FAULT_AROUND_PAGES pages containing the faulting page.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param upage Faulting virtual page, already mapped.
+ */
+static void elf_fault_around(as_area_t *area, uintptr_t upage)
+{
+	elf_header_t *elf = area->backend_data.elf;
+	elf_segment_header_t *entry = area->backend_data.segment;
+	uintptr_t base = (uintptr_t)
+	    (((void *) elf) + ALIGN_DOWN(entry->p_offset, PAGE_SIZE));
+	uintptr_t start_anon = entry->p_vaddr + entry->p_filesz;
+	uintptr_t first = ALIGN_DOWN(upage, P2SZ(ELF_FAULT_AROUND_PAGES));
+
+	for (size_t j = 0; j < ELF_FAULT_AROUND_PAGES; j++) {
+		uintptr_t page = first + P2SZ(j);
+
+		if ((page < area->base) ||
+		    (page >= area->base + P2SZ(area->pages)))
+			continue;
+
+		uintptr_t elfpage = elf_orig_page(area, page);
+		if ((elfpage < entry->p_vaddr) ||
+		    (elfpage + PAGE_SIZE > start_anon))
+			continue;
+
+		pte_t pte;
+		if (page_mapping_find(AS, page, false, &pte) &&
+		    PTE_VALID(&pte))
+			continue;
+
+		size_t i = (elfpage - ALIGN_DOWN(entry->p_vaddr, PAGE_SIZE)) >>
+		    PAGE_WIDTH;
+		bool found = page_mapping_find(AS_KERNEL,
+		    base + i * FRAME_SIZE, true, &pte);
+
+		(void) found;
+		assert(found);
+		assert(PTE_PRESENT(&pte));
+
+		page_mapping_insert(AS, page, PTE_GET_FRAME(&pte),
+		    as_area_get_flags(area));
+		if (!used_space_insert(&area->used_space, page, 1))
+			panic("Cannot insert used space.");
+	}
+}
+
 /** Service a page fault in the ELF backend address space area.
  *
  * The address space area and page tables must be already locked.
@@ -266,6 +324,7 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	uintptr_t elfpage;
 	size_t i;
 	bool dirty = false;
+	bool around = false;
 
 	assert(page_table_locked(AS));
 	assert(mutex_locked(&area->lock));
@@ -343,6 +402,12 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 			assert(PTE_PRESENT(&pte));
 
 			frame = PTE_GET_FRAME(&pte);
+
+			/*
+			 * Neighbouring pages of a read-only area cannot be in
+			 * the pagemap, map them too.
+			 */
+			around = !(area->flags & AS_AREA_WRITE);
 		}
 	} else if (elfpage >= start_anon) {
 		/*
@@ -400,6 +465,9 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
+	if (around)
+		elf_fault_around(area, upage);
+
 	return AS_PF_OK;
 }
 
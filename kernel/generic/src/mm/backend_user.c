@@ -39,6 +39,7 @@
 #include <mm/as.h>
 #include <mm/page.h>
 #include <mm/frame.h>
+#include <mm/km.h>
 #include <abi/mm/as.h>
 #include <abi/ipc/methods.h>
 #include <ipc/sysipc.h>
@@ -48,7 +49,9 @@
 #include <assert.h>
 #include <errno.h>
 #include <log.h>
+#include <mem.h>
 #include <str.h>
+#include <barrier.h>
 
 static bool user_create(as_area_t *);
 static void user_destroy(as_area_t *);
@@ -67,6 +70,7 @@ mem_backend_t user_backend = {
 
 	.is_resizable = user_is_resizable,
 	.is_shareable = user_is_shareable,
+	.is_discardable = NULL,
 
 	.page_fault = user_page_fault,
 	.frame_free = user_frame_free,
@@ -145,7 +149,30 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	 */
 
 	uintptr_t frame = ipc_get_arg1(&data);
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+
+	/*
+	 * The pager may hand out the same frame to several address spaces,
+	 * e.g. when it keeps a page cache. Writable areas therefore receive a
+	 * private copy of the page so that their modifications do not leak
+	 * into the pager's frame. Read-only areas map the frame directly.
+	 */
+	unsigned int flags = as_area_get_flags(area);
+	if (flags & PAGE_WRITE) {
+		uintptr_t copy;
+		uintptr_t kpage = km_temporary_page_get(&copy, 0);
+		uintptr_t src = km_map(frame, PAGE_SIZE, PAGE_SIZE,
+		    PAGE_READ | PAGE_CACHEABLE);
+		memcpy((void *) kpage, (void *) src, PAGE_SIZE);
+		if (flags & PAGE_EXEC)
+			smc_coherence((void *) kpage, PAGE_SIZE);
+		km_unmap(src, PAGE_SIZE);
+		km_temporary_page_put(kpage);
+
+		user_frame_free(area, upage, frame);
+		frame = copy;
+	}
+
+	page_mapping_insert(AS, upage, frame, flags);
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
@@ -60,6 +60,9 @@
 #include <macros.h>
 #include <config.h>
 #include <str.h>
+#include <mem.h>
+#include <atomic.h>
+#include <cpu.h>
 #include <proc/thread.h> /* THREAD */
 
 zones_t zones;
@@ -73,6 +76,9 @@ static condvar_t mem_avail_cv;
 static size_t mem_avail_req = 0;  /**< Number of frames requested. */
 static size_t mem_avail_gen = 0;  /**< Generation counter. */
 
+/** Number of frames sitting in the per-CPU frame caches. */
+static atomic_size_t frames_cached = 0;
+
 /** Initialize frame structure.
  *
  * @param frame Frame structure to be initialized.
@@ -163,7 +169,7 @@ _NO_TRACE static size_t frame_total_free_get_internal(void)
 	for (i = 0; i < zones.count; i++)
 		total += zones.info[i].free_count;
 
-	return total;
+	return total + atomic_load(&frames_cached);
 }
 
 _NO_TRACE size_t frame_total_free_get(void)
@@ -859,6 +865,228 @@ static size_t try_find_zone(size_t count, bool lowmem,
 	    frame_constraint, hint);
 }
 
+/*
+ * Per-CPU frame caches
+ *
+ * Single-frame allocations without constraints are served from per-CPU
+ * caches, so that the common case of a page fault does not need to take
+ * the zones lock. Each cache holds recently freed (hot) frames, which
+ * are handed out first, and frames fetched from the zones in batches
+ * (cold). When the hot list overflows, a batch of the coldest frames is
+ * returned to the zones.
+ *
+ */
+
+/** Initialize per-CPU frame cache.
+ *
+ * @param cache Frame cache to be initialized.
+ *
+ */
+void frame_cache_init(frame_cache_t *cache)
+{
+	irq_spinlock_initialize(&cache->lock, "cpus[].frame_cache[].lock");
+	cache->hot_count = 0;
+	cache->cold_count = 0;
+}
+
+/** Fetch a batch of frames from the zones to the cold list.
+ *
+ * Assume the frame cache is locked.
+ *
+ */
+_NO_TRACE static void frame_cache_refill(frame_cache_t *cache,
+    unsigned int class)
+{
+	zone_flags_t flags = ZONE_AVAILABLE |
+	    ((class == FRAME_CACHE_HIGHMEM) ? ZONE_HIGHMEM : ZONE_LOWMEM);
+	size_t znum = 0;
+
+	irq_spinlock_lock(&zones.lock, false);
+
+	while (cache->cold_count < FRAME_CACHE_BATCH) {
+		znum = find_free_zone(1, flags, 0, znum);
+		if (znum == (size_t) -1)
+			break;
+
+		cache->cold[cache->cold_count++] =
+		    zone_frame_alloc(&zones.info[znum], 1, 0) +
+		    zones.info[znum].base;
+		atomic_inc(&frames_cached);
+	}
+
+	irq_spinlock_unlock(&zones.lock, false);
+}
+
+/** Return frames from the cache to their zones.
+ *
+ * Assume the frame cache and the zones lock are locked.
+ * The cold frames are returned first, then the oldest hot ones.
+ *
+ * @param count Number of frames to return.
+ *
+ * @return Number of frames returned.
+ *
+ */
+_NO_TRACE static size_t frame_cache_drain(frame_cache_t *cache, size_t count)
+{
+	size_t drained = 0;
+
+	while ((drained < count) && (cache->cold_count > 0)) {
+		pfn_t pfn = cache->cold[--cache->cold_count];
+		size_t znum = find_zone(pfn, 1, 0);
+
+		assert(znum != (size_t) -1);
+
+		zone_frame_free(&zones.info[znum], pfn - zones.info[znum].base);
+		drained++;
+	}
+
+	size_t hot = min(count - drained, cache->hot_count);
+	for (size_t i = 0; i < hot; i++) {
+		pfn_t pfn = cache->hot[i];
+		size_t znum = find_zone(pfn, 1, 0);
+
+		assert(znum != (size_t) -1);
+
+		zone_frame_free(&zones.info[znum], pfn - zones.info[znum].base);
+	}
+
+	if (hot > 0) {
+		memmove(&cache->hot[0], &cache->hot[hot],
+		    (cache->hot_count - hot) * sizeof(pfn_t));
+		cache->hot_count -= hot;
+		drained += hot;
+	}
+
+	atomic_fetch_sub(&frames_cached, drained);
+	return drained;
+}
+
+/** Allocate a single frame from the frame cache of the current CPU.
+ *
+ * Assume interrupts are disabled.
+ *
+ * @param class Frame cache to allocate from.
+ * @param pfn   Place to store the frame number.
+ *
+ * @return True on success, false if there are no suitable free frames.
+ *
+ */
+_NO_TRACE static bool frame_cache_alloc(unsigned int class, pfn_t *pfn)
+{
+	frame_cache_t *cache = &CPU->frame_cache[class];
+	bool found = true;
+
+	irq_spinlock_lock(&cache->lock, false);
+
+	if ((cache->hot_count == 0) && (cache->cold_count == 0))
+		frame_cache_refill(cache, class);
+
+	if (cache->hot_count > 0)
+		*pfn = cache->hot[--cache->hot_count];
+	else if (cache->cold_count > 0)
+		*pfn = cache->cold[--cache->cold_count];
+	else
+		found = false;
+
+	irq_spinlock_unlock(&cache->lock, false);
+
+	if (found)
+		atomic_dec(&frames_cached);
+
+	return found;
+}
+
+/** Free a single frame to the frame cache of the current CPU.
+ *
+ * Assume interrupts are disabled.
+ *
+ * @param pfn Frame to be freed.
+ *
+ * @return Number of freed frames.
+ *
+ */
+_NO_TRACE static size_t frame_cache_free(pfn_t pfn)
+{
+	irq_spinlock_lock(&zones.lock, false);
+
+	size_t znum = find_zone(pfn, 1, 0);
+
+	assert(znum != (size_t) -1);
+
+	zone_t *zone = &zones.info[znum];
+	frame_t *frame = zone_get_frame(zone, pfn - zone->base);
+
+	assert(zone->flags & ZONE_AVAILABLE);
+	assert(frame->refcount > 0);
+
+	/* Shared frames only lose a reference */
+	if (frame->refcount > 1) {
+		frame->refcount--;
+		irq_spinlock_unlock(&zones.lock, false);
+		return 0;
+	}
+
+	unsigned int class = (zone->flags & ZONE_HIGHMEM) ?
+	    FRAME_CACHE_HIGHMEM : FRAME_CACHE_LOWMEM;
+
+	irq_spinlock_unlock(&zones.lock, false);
+
+	/*
+	 * We hold the last reference, so nobody else can touch the frame
+	 * while we are not holding the zones lock. The frame stays
+	 * allocated in its zone while it is cached.
+	 */
+	frame_cache_t *cache = &CPU->frame_cache[class];
+
+	irq_spinlock_lock(&cache->lock, false);
+
+	if (cache->hot_count == FRAME_CACHE_SIZE) {
+		irq_spinlock_lock(&zones.lock, false);
+		(void) frame_cache_drain(cache, FRAME_CACHE_BATCH);
+		irq_spinlock_unlock(&zones.lock, false);
+	}
+
+	cache->hot[cache->hot_count++] = pfn;
+	atomic_inc(&frames_cached);
+
+	irq_spinlock_unlock(&cache->lock, false);
+
+	return 1;
+}
+
+/** Return all frames from the per-CPU frame caches to the zones.
+ *
+ * Assume the zones lock is not locked.
+ *
+ * @return Number of frames returned.
+ *
+ */
+size_t frame_cache_drain_all(void)
+{
+	size_t drained = 0;
+
+	if (cpus == NULL)
+		return 0;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		for (unsigned int class = 0; class < FRAME_CACHE_CLASSES;
+		    class++) {
+			frame_cache_t *cache = &cpus[i].frame_cache[class];
+
+			irq_spinlock_lock(&cache->lock, true);
+			irq_spinlock_lock(&zones.lock, false);
+
+			drained += frame_cache_drain(cache, FRAME_CACHE_SIZE * 2);
+
+			irq_spinlock_unlock(&zones.lock, false);
+			irq_spinlock_unlock(&cache->lock, true);
+		}
+	}
+
+	return drained;
+}
+
 /** Allocate frames of physical memory.
  *
  * @param count      Number of continuous frames to allocate.
@@ -884,17 +1112,54 @@ uintptr_t frame_alloc_generic(size_t count, frame_flags_t flags,
 	if (!(flags & FRAME_NO_RESERVE))
 		reserve_force_alloc(count);
 
-loop:
-	irq_spinlock_lock(&zones.lock, true);
-
 	// TODO: Print diagnostic if neither is explicitly specified.
 	bool lowmem = (flags & FRAME_LOWMEM) || !(flags & FRAME_HIGHMEM);
 
+	/*
+	 * Single frames without constraints come from the per-CPU caches.
+	 * The caller asking for the zone gets the slow path.
+	 */
+	if ((count == 1) && (frame_constraint == 0) && (pzone == NULL)) {
+		ipl_t ipl = interrupts_disable();
+
+		bool found = false;
+		pfn_t pfn;
+
+		if (CPU != NULL) {
+			if (!lowmem)
+				found = frame_cache_alloc(FRAME_CACHE_HIGHMEM, &pfn);
+
+			if (!found)
+				found = frame_cache_alloc(FRAME_CACHE_LOWMEM, &pfn);
+		}
+
+		interrupts_restore(ipl);
+
+		if (found)
+			return PFN2ADDR(pfn);
+	}
+
+loop:
+	irq_spinlock_lock(&zones.lock, true);
+
 	/*
 	 * First, find suitable frame zone.
 	 */
 	size_t znum = try_find_zone(count, lowmem, frame_constraint, hint);
 
+	/*
+	 * If no memory, return the frames cached by the CPUs first.
+	 */
+	if (znum == (size_t) -1) {
+		irq_spinlock_unlock(&zones.lock, true);
+		size_t drained = frame_cache_drain_all();
+		irq_spinlock_lock(&zones.lock, true);
+
+		if (drained > 0)
+			znum = try_find_zone(count, lowmem,
+			    frame_constraint, hint);
+	}
+
 	/*
 	 * If no memory, reclaim some slab memory,
 	 * if it does not help, reclaim all.
@@ -1006,22 +1271,30 @@ void frame_free_generic(uintptr_t start, size_t count, frame_flags_t flags)
 {
 	size_t freed = 0;
 
-	irq_spinlock_lock(&zones.lock, true);
+	ipl_t ipl = interrupts_disable();
 
-	for (size_t i = 0; i < count; i++) {
-		/*
-		 * First, find host frame zone for addr.
-		 */
-		pfn_t pfn = ADDR2PFN(start) + i;
-		size_t znum = find_zone(pfn, 1, 0);
+	if ((count == 1) && (CPU != NULL)) {
+		freed = frame_cache_free(ADDR2PFN(start));
+	} else {
+		irq_spinlock_lock(&zones.lock, false);
 
-		assert(znum != (size_t) -1);
+		for (size_t i = 0; i < count; i++) {
+			/*
+			 * First, find host frame zone for addr.
+			 */
+			pfn_t pfn = ADDR2PFN(start) + i;
+			size_t znum = find_zone(pfn, 1, 0);
+
+			assert(znum != (size_t) -1);
+
+			freed += zone_frame_free(&zones.info[znum],
+			    pfn - zones.info[znum].base);
+		}
 
-		freed += zone_frame_free(&zones.info[znum],
-		    pfn - zones.info[znum].base);
+		irq_spinlock_unlock(&zones.lock, false);
 	}
 
-	irq_spinlock_unlock(&zones.lock, true);
+	interrupts_restore(ipl);
 
 	/*
 	 * Signal that some memory has been freed.
@@ -1030,7 +1303,7 @@ void frame_free_generic(uintptr_t start, size_t count, frame_flags_t flags)
 	 * with TLB shootdown.
 	 */
 
-	ipl_t ipl = interrupts_disable();
+	ipl = interrupts_disable();
 	mutex_lock(&mem_avail_mtx);
 
 	if (mem_avail_req > 0)
@@ -1218,6 +1491,11 @@ void zones_stats(uint64_t *total, uint64_t *unavail, uint64_t *busy,
 			*unavail += (uint64_t) FRAMES2SIZE(zones.info[i].count);
 	}
 
+	/* Frames in the per-CPU caches are free, albeit allocated in zones */
+	uint64_t cached = FRAMES2SIZE(atomic_load(&frames_cached));
+	*busy -= min(*busy, cached);
+	*free += cached;
+
 	irq_spinlock_unlock(&zones.lock, true);
 }
 
@@ -189,6 +189,48 @@ void page_mapping_make_global(uintptr_t base, size_t size)
 	return page_mapping_operations->mapping_make_global(base, size);
 }
 
+/** Return the size of a large page.
+ *
+ * @return Size of a large page mapping or zero if the page table
+ *         implementation cannot map large pages.
+ */
+size_t page_mapping_large_size(void)
+{
+	assert(page_mapping_operations);
+
+	return page_mapping_operations->large_page_size;
+}
+
+/** Insert mapping of a large page to a contiguous run of frames.
+ *
+ * The whole large page must be unmapped. Any page of the large mapping
+ * can later be removed or remapped individually, the page table
+ * implementation splits the large mapping as needed.
+ *
+ * @param as    Address space to which the page belongs.
+ * @param page  Virtual address of the large page, aligned to
+ *              page_mapping_large_size().
+ * @param frame Physical address of the first frame, aligned to
+ *              page_mapping_large_size().
+ * @param flags Flags to be used for mapping.
+ *
+ */
+_NO_TRACE void page_mapping_insert_large(as_t *as, uintptr_t page,
+    uintptr_t frame, unsigned int flags)
+{
+	assert(page_table_locked(as));
+
+	assert(page_mapping_operations);
+	assert(page_mapping_operations->mapping_insert_large);
+	assert(IS_ALIGNED(page, page_mapping_operations->large_page_size));
+	assert(IS_ALIGNED(frame, page_mapping_operations->large_page_size));
+
+	page_mapping_operations->mapping_insert_large(as, page, frame, flags);
+
+	/* Repel prefetched accesses to the old mapping. */
+	memory_barrier();
+}
+
 errno_t page_find_mapping(uintptr_t virt, uintptr_t *phys)
 {
 	page_table_lock(AS, true);
@@ -40,13 +40,11 @@
  * with the following exceptions:
  * @li empty slabs are deallocated immediately
  *     (in Linux they are kept in linked list, in Solaris ???)
- * @li empty magazines are deallocated when not needed
- *     (in Solaris they are held in linked list in slab cache)
+ * @li besides the per-cache depot, each CPU keeps a small depot of its
+ *     own full and empty magazines
  *
  * Following features are not currently supported but would be easy to do:
  * @li cache coloring
- * @li dynamic magazine growing (different magazine sizes are already
- *     supported, but we would need to adjust allocation strategy)
  *
  * The slab allocator supports per-CPU caches ('magazines') to facilitate
  * good SMP scaling.
@@ -57,9 +55,17 @@
  * it is used, otherwise a new one is allocated.
  *
  * When an object is being deallocated, it is put to a CPU-bound magazine.
- * If there is no such magazine, a new one is allocated (if this fails,
- * the object is deallocated into slab). If the magazine is full, it is
- * put into cpu-shared list of magazines and a new one is allocated.
+ * If there is no such magazine, an empty one is taken from the CPU depot,
+ * the cache depot or newly allocated, in this order (if this fails, the
+ * object is deallocated into slab). If the magazine is full, it is put
+ * into the CPU depot, or into the cpu-shared list of magazines if the
+ * CPU depot is full, and an empty one is taken instead.
+ *
+ * Each cache counts contended acquisitions of its depot lock. When the
+ * contention is high, the size of new magazines is doubled, so that
+ * the CPUs need to visit the depot less often. Magazines of the old size
+ * are freed as they become empty. Memory pressure (SLAB_RECLAIM_ALL)
+ * resets the magazine size.
  *
  * The CPU-bound magazine is actually a pair of magazines in order to avoid
  * thrashing when somebody is allocating/deallocating 1 item at the magazine
@@ -84,16 +90,6 @@
  * magazines.
  *
  * @todo
- * For better CPU-scaling the magazine allocation strategy should
- * be extended. Currently, if the cache does not have magazine, it asks
- * for non-cpu cached magazine cache to provide one. It might be feasible
- * to add cpu-cached magazine cache (which would allocate it's magazines
- * from non-cpu-cached mag. cache). This would provide a nice per-cpu
- * buffer. The other possibility is to use the per-cache
- * 'empty-magazine-list', which decreases competing for 1 per-system
- * magazine cache.
- *
- * @todo
  * It might be good to add granularity of locks even to slab level,
  * we could then try_spinlock over all partial slabs and thus improve
  * scalability even on slab level.
@@ -116,12 +112,15 @@
 #include <macros.h>
 #include <cpu.h>
 #include <stdlib.h>
+#include <str.h>
+#include <print.h>
 
 IRQ_SPINLOCK_STATIC_INITIALIZE(slab_cache_lock);
 static LIST_INITIALIZE(slab_cache_list);
 
-/** Magazine cache */
-static slab_cache_t mag_cache;
+/** Magazine caches, one for each magazine size */
+static slab_cache_t mag_cache[SLAB_MAG_SIZES];
+static char mag_cache_name[SLAB_MAG_SIZES][SLAB_NAME_BUFLEN];
 
 /** Cache for cache descriptors */
 static slab_cache_t slab_cache_cache;
@@ -326,6 +325,86 @@ _NO_TRACE static void *slab_obj_create(slab_cache_t *cache, unsigned int flags)
  * CPU-Cache slab functions
  */
 
+/** Map magazine size to the index of the cache it is allocated from */
+_NO_TRACE static size_t mag_cache_index(size_t size)
+{
+	return fnzb(size / SLAB_MAG_SIZE);
+}
+
+/** Free memory associated with an empty magazine
+ *
+ */
+_NO_TRACE static void magazine_free(slab_magazine_t *mag)
+{
+	assert(mag->busy == 0);
+
+	slab_free(&mag_cache[mag_cache_index(mag->size)], mag);
+}
+
+/** Take the first magazine from a magazine list
+ *
+ * @return Magazine or NULL if the list is empty.
+ *
+ */
+_NO_TRACE static slab_magazine_t *mag_list_pop(list_t *list)
+{
+	link_t *cur = list_first(list);
+	if (!cur)
+		return NULL;
+
+	list_remove(cur);
+	return list_get_instance(cur, slab_magazine_t, link);
+}
+
+/** Lock the magazine depot of a cache
+ *
+ * Contended acquisitions are counted. Larger magazines make the CPUs
+ * visit the depot less often, so whenever more than
+ * 1/SLAB_MAG_RESIZE_RATIO of the last SLAB_MAG_RESIZE_WINDOW
+ * acquisitions were contended, the size of new magazines is doubled.
+ *
+ * @return Interrupt priority level to be passed to depot_unlock().
+ *
+ */
+_NO_TRACE static ipl_t depot_lock(slab_cache_t *cache)
+{
+	ipl_t ipl = interrupts_disable();
+
+	bool contended = !irq_spinlock_trylock(&cache->maglock);
+	if (contended)
+		irq_spinlock_lock(&cache->maglock, false);
+
+	atomic_inc(&cache->depot_accesses);
+	if (contended) {
+		atomic_inc(&cache->depot_contention);
+		cache->window_contention++;
+	}
+
+	if (++cache->window_accesses == SLAB_MAG_RESIZE_WINDOW) {
+		size_t size = atomic_load_explicit(&cache->mag_size,
+		    memory_order_relaxed);
+
+		if ((cache->window_contention * SLAB_MAG_RESIZE_RATIO >
+		    SLAB_MAG_RESIZE_WINDOW) && (size < SLAB_MAG_SIZE_MAX))
+			atomic_store_explicit(&cache->mag_size, size << 1,
+			    memory_order_relaxed);
+
+		cache->window_accesses = 0;
+		cache->window_contention = 0;
+	}
+
+	return ipl;
+}
+
+/** Unlock the magazine depot of a cache
+ *
+ */
+_NO_TRACE static void depot_unlock(slab_cache_t *cache, ipl_t ipl)
+{
+	irq_spinlock_unlock(&cache->maglock, false);
+	interrupts_restore(ipl);
+}
+
 /** Find a full magazine in cache, take it from list and return it
  *
  * @param first If true, return first, else last mag.
@@ -337,7 +416,7 @@ _NO_TRACE static slab_magazine_t *get_mag_from_cache(slab_cache_t *cache,
 	slab_magazine_t *mag = NULL;
 	link_t *cur;
 
-	irq_spinlock_lock(&cache->maglock, true);
+	ipl_t ipl = depot_lock(cache);
 	if (!list_empty(&cache->magazines)) {
 		if (first)
 			cur = list_first(&cache->magazines);
@@ -348,7 +427,7 @@ _NO_TRACE static slab_magazine_t *get_mag_from_cache(slab_cache_t *cache,
 		list_remove(&mag->link);
 		atomic_dec(&cache->magazine_counter);
 	}
-	irq_spinlock_unlock(&cache->maglock, true);
+	depot_unlock(cache, ipl);
 
 	return mag;
 }
@@ -359,12 +438,12 @@ _NO_TRACE static slab_magazine_t *get_mag_from_cache(slab_cache_t *cache,
 _NO_TRACE static void put_mag_to_cache(slab_cache_t *cache,
     slab_magazine_t *mag)
 {
-	irq_spinlock_lock(&cache->maglock, true);
+	ipl_t ipl = depot_lock(cache);
 
 	list_prepend(&mag->link, &cache->magazines);
 	atomic_inc(&cache->magazine_counter);
 
-	irq_spinlock_unlock(&cache->maglock, true);
+	depot_unlock(cache, ipl);
 }
 
 /** Free all objects in magazine and free memory associated with magazine
@@ -383,42 +462,138 @@ _NO_TRACE static size_t magazine_destroy(slab_cache_t *cache,
 		atomic_dec(&cache->cached_objs);
 	}
 
-	slab_free(&mag_cache, mag);
+	mag->busy = 0;
+	magazine_free(mag);
 
 	return frames;
 }
 
+/** Get a full magazine from the CPU depot or from the cache
+ *
+ */
+_NO_TRACE static slab_magazine_t *get_full_mag(slab_cache_t *cache,
+    slab_mag_cache_t *mcache)
+{
+	slab_magazine_t *mag = mag_list_pop(&mcache->full);
+	if (mag) {
+		mcache->full_count--;
+		return mag;
+	}
+
+	return get_mag_from_cache(cache, 1);
+}
+
+/** Put a full magazine to the CPU depot, or to the cache if it is full
+ *
+ */
+_NO_TRACE static void put_full_mag(slab_cache_t *cache,
+    slab_mag_cache_t *mcache, slab_magazine_t *mag)
+{
+	if (mcache->full_count < SLAB_CPU_DEPOT_SIZE) {
+		list_prepend(&mag->link, &mcache->full);
+		mcache->full_count++;
+	} else {
+		put_mag_to_cache(cache, mag);
+	}
+}
+
+/** Get an empty magazine for the CPU cache
+ *
+ * The CPU depot is tried first, then the cache depot. A new magazine
+ * is allocated only if both are exhausted or if the magazine found
+ * predates the last change of the magazine size.
+ *
+ * @return Empty magazine or NULL if none can be allocated.
+ *
+ */
+_NO_TRACE static slab_magazine_t *get_empty_mag(slab_cache_t *cache,
+    slab_mag_cache_t *mcache)
+{
+	size_t size = atomic_load_explicit(&cache->mag_size,
+	    memory_order_relaxed);
+
+	slab_magazine_t *mag = mag_list_pop(&mcache->empty);
+	if (mag) {
+		mcache->empty_count--;
+	} else {
+		ipl_t ipl = depot_lock(cache);
+		mag = mag_list_pop(&cache->empty_magazines);
+		depot_unlock(cache, ipl);
+	}
+
+	if ((mag) && (mag->size == size))
+		return mag;
+
+	if (mag)
+		magazine_free(mag);
+
+	/*
+	 * We do not want to sleep just because of caching,
+	 * especially we do not want reclaiming to start, as
+	 * this would deadlock.
+	 *
+	 */
+	mag = slab_alloc(&mag_cache[mag_cache_index(size)],
+	    FRAME_ATOMIC | FRAME_NO_RECLAIM);
+	if (!mag)
+		return NULL;
+
+	mag->size = size;
+	mag->busy = 0;
+
+	return mag;
+}
+
+/** Put an empty magazine to the CPU depot, or to the cache if it is full
+ *
+ */
+_NO_TRACE static void put_empty_mag(slab_cache_t *cache,
+    slab_mag_cache_t *mcache, slab_magazine_t *mag)
+{
+	assert(mag->busy == 0);
+
+	if (mcache->empty_count < SLAB_CPU_DEPOT_SIZE) {
+		list_prepend(&mag->link, &mcache->empty);
+		mcache->empty_count++;
+	} else {
+		ipl_t ipl = depot_lock(cache);
+		list_prepend(&mag->link, &cache->empty_magazines);
+		depot_unlock(cache, ipl);
+	}
+}
+
 /** Find full magazine, set it as current and return it
  *
  */
 _NO_TRACE static slab_magazine_t *get_full_current_mag(slab_cache_t *cache)
 {
-	slab_magazine_t *cmag = cache->mag_cache[CPU->id].current;
-	slab_magazine_t *lastmag = cache->mag_cache[CPU->id].last;
+	slab_mag_cache_t *mcache = &cache->mag_cache[CPU->id];
+	slab_magazine_t *cmag = mcache->current;
+	slab_magazine_t *lastmag = mcache->last;
 
-	assert(irq_spinlock_locked(&cache->mag_cache[CPU->id].lock));
+	assert(irq_spinlock_locked(&mcache->lock));
 
 	if (cmag) { /* First try local CPU magazines */
 		if (cmag->busy)
 			return cmag;
 
 		if ((lastmag) && (lastmag->busy)) {
-			cache->mag_cache[CPU->id].current = lastmag;
-			cache->mag_cache[CPU->id].last = cmag;
+			mcache->current = lastmag;
+			mcache->last = cmag;
 			return lastmag;
 		}
 	}
 
-	/* Local magazines are empty, import one from magazine list */
-	slab_magazine_t *newmag = get_mag_from_cache(cache, 1);
+	/* Local magazines are empty, import one from the depot */
+	slab_magazine_t *newmag = get_full_mag(cache, mcache);
 	if (!newmag)
 		return NULL;
 
 	if (lastmag)
-		magazine_destroy(cache, lastmag);
+		put_empty_mag(cache, mcache, lastmag);
 
-	cache->mag_cache[CPU->id].last = cmag;
-	cache->mag_cache[CPU->id].current = newmag;
+	mcache->last = cmag;
+	mcache->current = newmag;
 
 	return newmag;
 }
@@ -455,50 +630,40 @@ _NO_TRACE static void *magazine_obj_get(slab_cache_t *cache)
  * We have 2 magazines bound to processor.
  * First try the current.
  * If full, try the last.
- * If full, put to magazines list.
+ * If full, put to the depot.
  *
  */
 _NO_TRACE static slab_magazine_t *make_empty_current_mag(slab_cache_t *cache)
 {
-	slab_magazine_t *cmag = cache->mag_cache[CPU->id].current;
-	slab_magazine_t *lastmag = cache->mag_cache[CPU->id].last;
+	slab_mag_cache_t *mcache = &cache->mag_cache[CPU->id];
+	slab_magazine_t *cmag = mcache->current;
+	slab_magazine_t *lastmag = mcache->last;
 
-	assert(irq_spinlock_locked(&cache->mag_cache[CPU->id].lock));
+	assert(irq_spinlock_locked(&mcache->lock));
 
 	if (cmag) {
 		if (cmag->busy < cmag->size)
 			return cmag;
 
 		if ((lastmag) && (lastmag->busy < lastmag->size)) {
-			cache->mag_cache[CPU->id].last = cmag;
-			cache->mag_cache[CPU->id].current = lastmag;
+			mcache->last = cmag;
+			mcache->current = lastmag;
 			return lastmag;
 		}
 	}
 
-	/* current | last are full | nonexistent, allocate new */
-
-	/*
-	 * We do not want to sleep just because of caching,
-	 * especially we do not want reclaiming to start, as
-	 * this would deadlock.
-	 *
-	 */
-	slab_magazine_t *newmag = slab_alloc(&mag_cache,
-	    FRAME_ATOMIC | FRAME_NO_RECLAIM);
+	/* current | last are full | nonexistent, get an empty one */
+	slab_magazine_t *newmag = get_empty_mag(cache, mcache);
 	if (!newmag)
 		return NULL;
 
-	newmag->size = SLAB_MAG_SIZE;
-	newmag->busy = 0;
-
-	/* Flush last to magazine list */
+	/* Flush last to the depot */
 	if (lastmag)
-		put_mag_to_cache(cache, lastmag);
+		put_full_mag(cache, mcache, lastmag);
 
 	/* Move current as last, save new as current */
-	cache->mag_cache[CPU->id].last = cmag;
-	cache->mag_cache[CPU->id].current = newmag;
+	mcache->last = cmag;
+	mcache->current = newmag;
 
 	return newmag;
 }
@@ -574,6 +739,8 @@ _NO_TRACE static bool make_magcache(slab_cache_t *cache)
 	size_t i;
 	for (i = 0; i < config.cpu_count; i++) {
 		memsetb(&cache->mag_cache[i], sizeof(cache->mag_cache[i]), 0);
+		list_initialize(&cache->mag_cache[i].full);
+		list_initialize(&cache->mag_cache[i].empty);
 		irq_spinlock_initialize(&cache->mag_cache[i].lock,
 		    "slab.cache.mag_cache[].lock");
 	}
@@ -606,6 +773,8 @@ _NO_TRACE static void _slab_cache_create(slab_cache_t *cache, const char *name,
 	list_initialize(&cache->full_slabs);
 	list_initialize(&cache->partial_slabs);
 	list_initialize(&cache->magazines);
+	list_initialize(&cache->empty_magazines);
+	atomic_store(&cache->mag_size, SLAB_MAG_SIZE);
 
 	irq_spinlock_initialize(&cache->slablock, "slab.cache.slablock");
 	irq_spinlock_initialize(&cache->maglock, "slab.cache.maglock");
@@ -664,13 +833,24 @@ _NO_TRACE static size_t _slab_reclaim(slab_cache_t *cache, unsigned int flags)
 	if (cache->flags & SLAB_CACHE_NOMAGAZINE)
 		return 0; /* Nothing to do */
 
+	/* Empty magazines in the depot hold no objects, free them all */
+	list_t empty;
+	list_initialize(&empty);
+
+	ipl_t ipl = depot_lock(cache);
+	list_concat(&empty, &cache->empty_magazines);
+	depot_unlock(cache, ipl);
+
+	slab_magazine_t *mag;
+	while ((mag = mag_list_pop(&empty)))
+		magazine_free(mag);
+
 	/*
 	 * We count up to original magazine count to avoid
 	 * endless loop
 	 */
 	size_t magcount = atomic_load(&cache->magazine_counter);
 
-	slab_magazine_t *mag;
 	size_t frames = 0;
 
 	while ((magcount--) && (mag = get_mag_from_cache(cache, 0))) {
@@ -680,23 +860,37 @@ _NO_TRACE static size_t _slab_reclaim(slab_cache_t *cache, unsigned int flags)
 	}
 
 	if (flags & SLAB_RECLAIM_ALL) {
+		/* We are short of memory, start over with small magazines */
+		atomic_store(&cache->mag_size, SLAB_MAG_SIZE);
+
 		/* Free cpu-bound magazines */
 		/* Destroy CPU magazines */
 		size_t i;
 		for (i = 0; i < config.cpu_count; i++) {
-			irq_spinlock_lock(&cache->mag_cache[i].lock, true);
+			slab_mag_cache_t *mcache = &cache->mag_cache[i];
+
+			irq_spinlock_lock(&mcache->lock, true);
 
-			mag = cache->mag_cache[i].current;
+			mag = mcache->current;
 			if (mag)
 				frames += magazine_destroy(cache, mag);
-			cache->mag_cache[i].current = NULL;
+			mcache->current = NULL;
 
-			mag = cache->mag_cache[i].last;
+			mag = mcache->last;
 			if (mag)
 				frames += magazine_destroy(cache, mag);
-			cache->mag_cache[i].last = NULL;
+			mcache->last = NULL;
+
+			/* Destroy the CPU depot */
+			while ((mag = mag_list_pop(&mcache->full)))
+				frames += magazine_destroy(cache, mag);
+			mcache->full_count = 0;
 
-			irq_spinlock_unlock(&cache->mag_cache[i].lock, true);
+			while ((mag = mag_list_pop(&mcache->empty)))
+				magazine_free(mag);
+			mcache->empty_count = 0;
+
+			irq_spinlock_unlock(&mcache->lock, true);
 		}
 	}
 
@@ -807,7 +1001,7 @@ size_t slab_reclaim(unsigned int flags)
 void slab_print_list(void)
 {
 	printf("[cache name      ] [size  ] [pages ] [obj/pg] [slabs ]"
-	    " [cached] [alloc ] [ctl]\n");
+	    " [cached] [alloc ] [magsz ] [depot ] [contnd] [ctl]\n");
 
 	size_t skip = 0;
 	while (true) {
@@ -859,24 +1053,75 @@ void slab_print_list(void)
 		long allocated_slabs = atomic_load(&cache->allocated_slabs);
 		long cached_objs = atomic_load(&cache->cached_objs);
 		long allocated_objs = atomic_load(&cache->allocated_objs);
+		size_t mag_size = atomic_load(&cache->mag_size);
+		size_t depot_accesses = atomic_load(&cache->depot_accesses);
+		size_t depot_contention = atomic_load(&cache->depot_contention);
 		unsigned int flags = cache->flags;
 
 		irq_spinlock_unlock(&slab_cache_lock, true);
 
-		printf("%-18s %8zu %8zu %8zu %8ld %8ld %8ld %-5s\n",
+		if (flags & SLAB_CACHE_NOMAGAZINE)
+			mag_size = 0;
+
+		printf("%-18s %8zu %8zu %8zu %8ld %8ld %8ld %8zu %8zu %8zu %-5s\n",
 		    name, size, frames, objects, allocated_slabs,
-		    cached_objs, allocated_objs,
-		    flags & SLAB_CACHE_SLINSIDE ? "in" : "out");
+		    cached_objs, allocated_objs, mag_size, depot_accesses,
+		    depot_contention, flags & SLAB_CACHE_SLINSIDE ? "in" : "out");
 	}
 }
 
+/** Get statistics of slab caches
+ *
+ * @param stats Array to be filled in, may be NULL if @a count is zero.
+ * @param count Number of items in @a stats.
+ *
+ * @return Number of existing slab caches. Only the first @a count
+ *         of them are filled in.
+ *
+ */
+size_t slab_stats_get(stats_slab_t *stats, size_t count)
+{
+	irq_spinlock_lock(&slab_cache_lock, true);
+
+	size_t i = 0;
+	list_foreach(slab_cache_list, link, slab_cache_t, cache) {
+		if (i < count) {
+			stats_slab_t *item = &stats[i];
+
+			str_cpy(item->name, SLAB_NAME_BUFLEN, cache->name);
+			item->size = cache->size;
+			item->slabs = atomic_load(&cache->allocated_slabs);
+			item->cached = atomic_load(&cache->cached_objs);
+			item->allocated = atomic_load(&cache->allocated_objs);
+			item->magazine_size =
+			    (cache->flags & SLAB_CACHE_NOMAGAZINE) ?
+			    0 : atomic_load(&cache->mag_size);
+			item->depot_accesses = atomic_load(&cache->depot_accesses);
+			item->depot_contention =
+			    atomic_load(&cache->depot_contention);
+		}
+
+		i++;
+	}
+
+	irq_spinlock_unlock(&slab_cache_lock, true);
+
+	return i;
+}
+
 void slab_cache_init(void)
 {
-	/* Initialize magazine cache */
-	_slab_cache_create(&mag_cache, "slab_magazine_t",
-	    sizeof(slab_magazine_t) + SLAB_MAG_SIZE * sizeof(void *),
-	    sizeof(uintptr_t), NULL, NULL, SLAB_CACHE_NOMAGAZINE |
-	    SLAB_CACHE_SLINSIDE);
+	/* Initialize magazine caches */
+	for (size_t i = 0; i < SLAB_MAG_SIZES; i++) {
+		size_t size = SLAB_MAG_SIZE << i;
+
+		snprintf(mag_cache_name[i], SLAB_NAME_BUFLEN,
+		    "slab_magazine_%zu", size);
+		_slab_cache_create(&mag_cache[i], mag_cache_name[i],
+		    sizeof(slab_magazine_t) + size * sizeof(void *),
+		    sizeof(uintptr_t), NULL, NULL, SLAB_CACHE_NOMAGAZINE |
+		    SLAB_CACHE_SLINSIDE);
+	}
 
 	/* Initialize slab_cache cache */
 	_slab_cache_create(&slab_cache_cache, "slab_cache_cache",
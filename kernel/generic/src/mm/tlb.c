@@ -35,8 +35,9 @@
  * @brief Generic TLB shootdown algorithm.
  *
  * The algorithm implemented here is based on the CMU TLB shootdown
- * algorithm and is further simplified (e.g. all CPUs receive all TLB
- * shootdown messages).
+ * algorithm and is further simplified. Shootdowns of user address spaces
+ * are only sent to the CPUs which have ever run the address space, all
+ * other shootdowns go to all CPUs.
  */
 
 #include <mm/tlb.h>
@@ -51,6 +52,7 @@
 #include <arch.h>
 #include <panic.h>
 #include <cpu.h>
+#include <cpu/cpu_mask.h>
 
 void tlb_init(void)
 {
@@ -70,8 +72,10 @@ IRQ_SPINLOCK_STATIC_INITIALIZE(tlblock);
 /** Send TLB shootdown message.
  *
  * This function attempts to deliver TLB shootdown message
- * to all other processors.
+ * to all other processors in the mask.
  *
+ * @param mask  Processors which may cache the translations or NULL
+ *              for all processors.
  * @param type  Type describing scope of shootdown.
  * @param asid  Address space, if required by type.
  * @param page  Virtual page address, if required by type.
@@ -80,19 +84,26 @@ IRQ_SPINLOCK_STATIC_INITIALIZE(tlblock);
  * @return The interrupt priority level as it existed prior to this call.
  *
  */
-ipl_t tlb_shootdown_start(tlb_invalidate_type_t type, asid_t asid,
-    uintptr_t page, size_t count)
+ipl_t tlb_shootdown_start(cpu_mask_t *mask, tlb_invalidate_type_t type,
+    asid_t asid, uintptr_t page, size_t count)
 {
 	ipl_t ipl = interrupts_disable();
 	CPU->tlb_active = false;
 	irq_spinlock_lock(&tlblock, false);
 
+	atomic_inc(&CPU->tlb_shootdowns);
+
+	size_t targets = 0;
 	size_t i;
 	for (i = 0; i < config.cpu_count; i++) {
 		if (i == CPU->id)
 			continue;
 
+		if ((mask != NULL) && (!cpu_mask_is_set(mask, i)))
+			continue;
+
 		cpu_t *cpu = &cpus[i];
+		targets++;
 
 		irq_spinlock_lock(&cpu->tlb_lock, false);
 		if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
@@ -118,10 +129,22 @@ ipl_t tlb_shootdown_start(tlb_invalidate_type_t type, asid_t asid,
 		irq_spinlock_unlock(&cpu->tlb_lock, false);
 	}
 
-	tlb_shootdown_ipi_send();
+	if (targets + 1 == config.cpu_count) {
+		tlb_shootdown_ipi_send();
+	} else {
+		for (i = 0; i < config.cpu_count; i++) {
+			if ((i != CPU->id) && cpu_mask_is_set(mask, i))
+				ipi_unicast(i, VECTOR_TLB_SHOOTDOWN_IPI);
+		}
+	}
+
+	(void) atomic_fetch_add(&CPU->tlb_ipis_sent, targets);
 
 busy_wait:
 	for (i = 0; i < config.cpu_count; i++) {
+		if ((mask != NULL) && (!cpu_mask_is_set(mask, i)))
+			continue;
+
 		if (cpus[i].tlb_active)
 			goto busy_wait;
 	}
@@ -146,17 +169,14 @@ void tlb_shootdown_ipi_send(void)
 	ipi_broadcast(VECTOR_TLB_SHOOTDOWN_IPI);
 }
 
-/** Receive TLB shootdown message.
+/** Process TLB shootdown messages queued for the current CPU.
+ *
+ * Must be called with interrupts disabled after the sender has finished
+ * the shootdown sequence.
  *
  */
-void tlb_shootdown_ipi_recv(void)
+static void tlb_shootdown_process(void)
 {
-	assert(CPU);
-
-	CPU->tlb_active = false;
-	irq_spinlock_lock(&tlblock, false);
-	irq_spinlock_unlock(&tlblock, false);
-
 	irq_spinlock_lock(&CPU->tlb_lock, false);
 	assert(CPU->tlb_messages_count <= TLB_MESSAGE_QUEUE_LEN);
 
@@ -189,6 +209,50 @@ void tlb_shootdown_ipi_recv(void)
 
 	CPU->tlb_messages_count = 0;
 	irq_spinlock_unlock(&CPU->tlb_lock, false);
+}
+
+/** Receive TLB shootdown message.
+ *
+ */
+void tlb_shootdown_ipi_recv(void)
+{
+	assert(CPU);
+
+	CPU->tlb_active = false;
+	irq_spinlock_lock(&tlblock, false);
+	irq_spinlock_unlock(&tlblock, false);
+
+	atomic_inc(&CPU->tlb_ipis_received);
+	tlb_shootdown_process();
+
+	CPU->tlb_active = true;
+}
+
+/** Add the current CPU to the CPUs which may cache translations.
+ *
+ * Called before the current CPU starts using an address space for the first
+ * time. The CPU is added only after any shootdown in progress is finished,
+ * so every shootdown either covers this CPU or completes before the CPU can
+ * cache any translation of the address space.
+ *
+ * Interrupts must be disabled.
+ *
+ * @param mask CPU mask of the address space.
+ *
+ */
+void tlb_shootdown_cpu_add(cpu_mask_t *mask)
+{
+	assert(CPU);
+	assert(interrupts_disabled());
+
+	CPU->tlb_active = false;
+	irq_spinlock_lock(&tlblock, false);
+	cpu_mask_set(mask, CPU->id);
+	irq_spinlock_unlock(&tlblock, false);
+
+	/* The shootdown we might have waited for may target us as well. */
+	tlb_shootdown_process();
+
 	CPU->tlb_active = true;
 }
 
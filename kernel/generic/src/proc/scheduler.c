@@ -34,18 +34,21 @@
  * @file
  * @brief Scheduler and load balancing.
  *
- * This file contains the scheduler and kcpulb kernel thread which
- * performs load-balancing of per-CPU run queues.
+ * This file contains the scheduler and the work-stealing load balancer
+ * which lets idle CPUs pull ready threads from the per-CPU run queues
+ * of other CPUs.
  */
 
 #include <assert.h>
 #include <atomic.h>
+#include <bitops.h>
 #include <proc/scheduler.h>
 #include <proc/thread.h>
 #include <proc/task.h>
 #include <mm/frame.h>
 #include <mm/page.h>
 #include <mm/as.h>
+#include <time/clock.h>
 #include <time/timeout.h>
 #include <time/delay.h>
 #include <arch/asm.h>
@@ -61,12 +64,17 @@
 #include <adt/list.h>
 #include <panic.h>
 #include <cpu.h>
+#include <cpu/affinity.h>
 #include <stdio.h>
 #include <log.h>
 #include <stacktrace.h>
 
 static void scheduler_separated_stack(void);
 
+#ifdef CONFIG_SMP
+static bool steal_thread(void);
+#endif
+
 atomic_size_t nrdy;  /**< Number of ready threads in the system. */
 
 /** Take actions before new thread runs.
@@ -157,6 +165,26 @@ void scheduler_fpu_lazy_request(void)
 
 	atomic_store_explicit(&CPU->fpu_owner, THREAD, memory_order_relaxed);
 }
+
+/** Save the FPU context of THREAD if it is still loaded in this CPU.
+ *
+ * Used before the thread migrates to another CPU.
+ *
+ */
+static void fpu_lazy_release(void)
+{
+	irq_spinlock_lock(&CPU->fpu_lock, false);
+
+	thread_t *owner = atomic_load_explicit(&CPU->fpu_owner, memory_order_relaxed);
+	if (owner == THREAD) {
+		fpu_enable();
+		fpu_context_save(&THREAD->fpu_context);
+		fpu_disable();
+		atomic_store_explicit(&CPU->fpu_owner, NULL, memory_order_relaxed);
+	}
+
+	irq_spinlock_unlock(&CPU->fpu_lock, false);
+}
 #endif /* CONFIG_FPU_LAZY */
 
 /** Initialize scheduler
@@ -166,6 +194,8 @@ void scheduler_fpu_lazy_request(void)
  */
 void scheduler_init(void)
 {
+	/* Each run queue has its bit in cpu_t.rq_bitmap. */
+	static_assert(RQ_COUNT <= 32, "");
 }
 
 /** Get thread to be scheduled
@@ -185,11 +215,23 @@ static thread_t *try_find_thread(int *rq_index)
 	if (atomic_load(&CPU->nrdy) == 0)
 		return NULL;
 
-	for (int i = 0; i < RQ_COUNT; i++) {
+	while (true) {
+		uint32_t bitmap = atomic_load_explicit(&CPU->rq_bitmap,
+		    memory_order_relaxed);
+		if (bitmap == 0)
+			return NULL;
+
+		/*
+		 * The lowest set bit denotes the highest-priority non-empty
+		 * queue, so this is the only run queue we need to lock.
+		 */
+		int i = fnzb32(bitmap & -bitmap);
+
 		irq_spinlock_lock(&(CPU->rq[i].lock), false);
 		if (CPU->rq[i].n == 0) {
 			/*
-			 * If this queue is empty, try a lower-priority queue.
+			 * The queue was emptied by a load balancer in the
+			 * meantime and its bit is clear now, look again.
 			 */
 			irq_spinlock_unlock(&(CPU->rq[i].lock), false);
 			continue;
@@ -197,7 +239,8 @@ static thread_t *try_find_thread(int *rq_index)
 
 		atomic_dec(&CPU->nrdy);
 		atomic_dec(&nrdy);
-		CPU->rq[i].n--;
+		if (--CPU->rq[i].n == 0)
+			rq_bitmap_clear(&CPU->rq_bitmap, i);
 
 		/*
 		 * Take the first thread from the queue.
@@ -227,8 +270,6 @@ static thread_t *try_find_thread(int *rq_index)
 		*rq_index = i;
 		return thread;
 	}
-
-	return NULL;
 }
 
 /** Get thread to be scheduled
@@ -251,6 +292,15 @@ static thread_t *find_best_thread(int *rq_index)
 		if (thread != NULL)
 			return thread;
 
+#ifdef CONFIG_SMP
+		/*
+		 * Before going idle, try to pull some work from the other
+		 * CPUs. If successful, the thread is in our run queues now.
+		 */
+		if (steal_thread())
+			continue;
+#endif
+
 		/*
 		 * For there was nothing to run, the CPU goes to sleep
 		 * until a hardware interrupt or an IPI comes.
@@ -264,10 +314,39 @@ static thread_t *find_best_thread(int *rq_index)
 		 * all platforms yet, so it is possible we will go sleep when
 		 * a thread has just become available.
 		 */
+		clock_idle_enter();
 		cpu_interruptible_sleep();
+		clock_idle_exit();
 	}
 }
 
+/** Take over the thread handed off by the thread leaving the CPU
+ *
+ * The thread was woken up by thread_wakeup_handoff() and is not in any run
+ * queue. It runs for the rest of the time slice of the thread that handed
+ * it off.
+ *
+ * @param thread   Handed off thread.
+ * @param rq_index Place to store the run queue index of the thread.
+ *
+ */
+static void take_handoff_thread(thread_t *thread, int *rq_index)
+{
+	assert(interrupts_disabled());
+
+	/* Wait until the old CPU of the thread has saved its context. */
+	irq_spinlock_lock(&thread->lock, false);
+
+	if (thread->priority < RQ_COUNT - 1)
+		thread->priority++;
+
+	thread->cpu = CPU;
+	thread->stolen = false;
+	*rq_index = thread->priority;
+
+	irq_spinlock_unlock(&thread->lock, false);
+}
+
 static void switch_task(task_t *task)
 {
 	/* If the task stays the same, a lot of work is avoided. */
@@ -327,6 +406,11 @@ static void relink_rq(int start)
 		CPU->rq[i].n = n;
 		n = tmpn;
 
+		if (CPU->rq[i].n == 0)
+			rq_bitmap_clear(&CPU->rq_bitmap, i);
+		else
+			rq_bitmap_set(&CPU->rq_bitmap, i);
+
 		irq_spinlock_unlock(&CPU->rq[i].lock, false);
 	}
 
@@ -335,6 +419,7 @@ static void relink_rq(int start)
 		irq_spinlock_lock(&CPU->rq[start].lock, false);
 		list_concat(&CPU->rq[start].rq, &list);
 		CPU->rq[start].n += n;
+		rq_bitmap_set(&CPU->rq_bitmap, start);
 		irq_spinlock_unlock(&CPU->rq[start].lock, false);
 	}
 }
@@ -437,14 +522,34 @@ void scheduler_separated_stack(void)
 	assert(CPU != NULL);
 	assert(interrupts_disabled());
 
+	thread_t *handoff = NULL;
+
 	if (THREAD) {
 		/* Must be run after the switch to scheduler stack */
 		after_thread_ran();
 
+		handoff = THREAD->handoff;
+		THREAD->handoff = NULL;
+
 		switch (THREAD->state) {
 		case Running:
+#ifdef CONFIG_FPU_LAZY
+			/*
+			 * If the thread is leaving this CPU because of its
+			 * affinity, the FPU context must not stay behind.
+			 */
+			if ((THREAD->nomigrate == 0) &&
+			    (!cpu_affinity_allows(THREAD->affinity, CPU->id)))
+				fpu_lazy_release();
+#endif
 			irq_spinlock_unlock(&THREAD->lock, false);
 			thread_ready(THREAD);
+
+			/* Only a thread that blocks hands the CPU off. */
+			if (handoff != NULL) {
+				thread_ready(handoff);
+				handoff = NULL;
+			}
 			break;
 
 		case Exiting:
@@ -480,7 +585,12 @@ void scheduler_separated_stack(void)
 	}
 
 	int rq_index;
-	THREAD = find_best_thread(&rq_index);
+	if (handoff != NULL) {
+		take_handoff_thread(handoff, &rq_index);
+		THREAD = handoff;
+	} else {
+		THREAD = find_best_thread(&rq_index);
+	}
 
 	relink_rq(rq_index);
 
@@ -519,6 +629,14 @@ void scheduler_separated_stack(void)
 
 #ifdef CONFIG_SMP
 
+/** Move a ready thread from another CPU's run queue to the local one
+ *
+ * @param old_cpu CPU to steal the thread from.
+ * @param i       Index of the run queue to search.
+ *
+ * @return Stolen thread or NULL if there was no thread to steal.
+ *
+ */
 static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 {
 	runq_t *old_rq = &old_cpu->rq[i];
@@ -543,11 +661,13 @@ static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 		/*
 		 * Do not steal CPU-wired threads, threads
 		 * already stolen, threads for which migration
-		 * was temporarily disabled or threads whose
-		 * FPU context is still in the CPU.
+		 * was temporarily disabled, threads whose
+		 * FPU context is still in the CPU or threads
+		 * not allowed to run here.
 		 */
 		if (thread->stolen || thread->nomigrate ||
-		    thread == fpu_owner) {
+		    thread == fpu_owner ||
+		    !cpu_affinity_allows(thread->affinity, CPU->id)) {
 			irq_spinlock_unlock(&thread->lock, false);
 			continue;
 		}
@@ -561,16 +681,16 @@ static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 		 * Ready thread on local CPU
 		 */
 
-#ifdef KCPULB_VERBOSE
+#ifdef SCHEDULER_VERBOSE
 		log(LF_OTHER, LVL_DEBUG,
-		    "kcpulb%u: TID %" PRIu64 " -> cpu%u, "
-		    "nrdy=%ld, avg=%ld", CPU->id, thread->tid,
-		    CPU->id, atomic_load(&CPU->nrdy),
-		    atomic_load(&nrdy) / config.cpu_active);
+		    "cpu%u: TID %" PRIu64 " stolen from cpu%u, nrdy=%zu",
+		    CPU->id, thread->tid, old_cpu->id,
+		    atomic_load(&old_cpu->nrdy));
 #endif
 
 		/* Remove thread from ready queue. */
-		old_rq->n--;
+		if (--old_rq->n == 0)
+			rq_bitmap_clear(&old_cpu->rq_bitmap, i);
 		list_remove(&thread->rq_link);
 		irq_spinlock_unlock(&old_rq->lock, false);
 
@@ -578,10 +698,12 @@ static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 		irq_spinlock_lock(&new_rq->lock, false);
 		list_append(&thread->rq_link, &new_rq->rq);
 		new_rq->n++;
+		rq_bitmap_set(&CPU->rq_bitmap, i);
 		irq_spinlock_unlock(&new_rq->lock, false);
 
 		atomic_dec(&old_cpu->nrdy);
 		atomic_inc(&CPU->nrdy);
+		atomic_inc(&old_cpu->migrations);
 		interrupts_restore(ipl);
 		return thread;
 	}
@@ -591,88 +713,64 @@ static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 	return NULL;
 }
 
-/** Load balancing thread
+/** Steal a ready thread for an idle CPU
  *
- * SMP load balancing thread, supervising thread supplies
- * for the CPU it's wired to.
+ * CPUs in the same locality domain as the local CPU are visited first,
+ * the others only if none of them has a thread to spare. Within each
+ * group, the CPUs are visited in the order of their IDs, starting with
+ * the one following the local CPU, so that concurrent thieves tend to
+ * pick different victims. On each victim, the lowest-priority non-empty
+ * run queues are searched first.
  *
- * @param arg Generic thread argument (unused).
+ * @return True if a thread was moved to the local run queues.
  *
  */
-void kcpulb(void *arg)
+static bool steal_thread(void)
 {
-	size_t average;
-	size_t rdy;
+	assert(interrupts_disabled());
+	assert(CPU != NULL);
 
-loop:
-	/*
-	 * Work in 1s intervals.
-	 */
-	thread_sleep(1);
+	bool had_victim = false;
 
-not_satisfied:
-	/*
-	 * Calculate the number of threads that will be migrated/stolen from
-	 * other CPU's. Note that situation can have changed between two
-	 * passes. Each time get the most up to date counts.
-	 *
-	 */
-	average = atomic_load(&nrdy) / config.cpu_active + 1;
-	rdy = atomic_load(&CPU->nrdy);
+	for (int pass = 0; pass < 2; pass++) {
+		for (size_t n = 1; n < config.cpu_count; n++) {
+			cpu_t *cpu = &cpus[(CPU->id + n) % config.cpu_count];
 
-	if (average <= rdy)
-		goto satisfied;
+			/* Same domain in the first pass, others in the second. */
+			if ((cpu->domain == CPU->domain) != (pass == 0))
+				continue;
 
-	size_t count = average - rdy;
+			if ((!cpu->active) || (atomic_load(&cpu->nrdy) == 0))
+				continue;
 
-	/*
-	 * Searching least priority queues on all CPU's first and most priority
-	 * queues on all CPU's last.
-	 */
-	size_t acpu;
-	int rq;
+			had_victim = true;
 
-	for (rq = RQ_COUNT - 1; rq >= 0; rq--) {
-		for (acpu = 0; acpu < config.cpu_active; acpu++) {
-			cpu_t *cpu = &cpus[acpu];
+			uint32_t bitmap = atomic_load_explicit(&cpu->rq_bitmap,
+			    memory_order_relaxed);
 
-			/*
-			 * Not interested in ourselves.
-			 * Doesn't require interrupt disabling for kcpulb has
-			 * THREAD_FLAG_WIRED.
-			 *
-			 */
-			if (CPU == cpu)
-				continue;
+			while (bitmap != 0) {
+				int i = fnzb32(bitmap);
 
-			if (atomic_load(&cpu->nrdy) <= average)
-				continue;
+				if (steal_thread_from(cpu, i) != NULL) {
+					atomic_inc(&CPU->steals);
+					return true;
+				}
 
-			if (steal_thread_from(cpu, rq) && --count == 0)
-				goto satisfied;
+				bitmap &= ~(UINT32_C(1) << i);
+			}
 		}
 	}
 
-	if (atomic_load(&CPU->nrdy)) {
-		/*
-		 * Be a little bit light-weight and let migrated threads run.
-		 *
-		 */
-		scheduler();
-	} else {
-		/*
-		 * We failed to migrate a single thread.
-		 * Give up this turn.
-		 *
-		 */
-		goto loop;
-	}
-
-	goto not_satisfied;
+	/*
+	 * Only count the attempts in which there was some work around,
+	 * but none of it could be migrated.
+	 */
+	if (had_victim)
+		atomic_inc(&CPU->steals_failed);
 
-satisfied:
-	goto loop;
+	return false;
 }
+
 #endif /* CONFIG_SMP */
 
 /** Print information about threads & scheduler queues
@@ -49,6 +49,7 @@
 #include <adt/list.h>
 #include <adt/odict.h>
 #include <cap/cap.h>
+#include <cpu/affinity.h>
 #include <ipc/ipc.h>
 #include <ipc/ipcrsc.h>
 #include <ipc/event.h>
@@ -211,6 +212,14 @@ task_t *task_create(as_t *as, const char *name)
 	task->ucycles = 0;
 	task->kcycles = 0;
 
+	/* The new task inherits the CPU affinity of its creator. */
+	task->affinity = NULL;
+	if (TASK != NULL) {
+		irq_spinlock_lock(&TASK->lock, true);
+		task->affinity = cpu_affinity_ref(TASK->affinity);
+		irq_spinlock_unlock(&TASK->lock, true);
+	}
+
 	caps_task_init(task);
 
 	task->ipc_info.call_sent = 0;
@@ -240,6 +249,8 @@ task_t *task_create(as_t *as, const char *name)
 		if (rc != EOK) {
 			task->as = NULL;
 			task_destroy_arch(task);
+			cpu_affinity_put(task->affinity);
+			caps_task_fini(task);
 			slab_free(task_cache, task);
 			return NULL;
 		}
@@ -284,6 +295,14 @@ void task_destroy(task_t *task)
 	 */
 	as_release(task->as);
 
+	cpu_affinity_put(task->affinity);
+
+	/*
+	 * Release the capability table, the task structure may sit in the
+	 * slab cache for a long time.
+	 */
+	caps_task_fini(task);
+
 	slab_free(task_cache, task);
 }
 
@@ -411,6 +430,32 @@ sys_errno_t sys_task_kill(uspace_ptr_task_id_t uspace_taskid)
 	return (sys_errno_t) task_kill(taskid);
 }
 
+/** Syscall to set CPU affinity of the current task
+ *
+ * The affinity is applied to all existing threads of the task and is
+ * inherited by threads and tasks created later.
+ *
+ * @param uspace_mask Userspace address of the CPU mask (see
+ *                    cpu_affinity_from_uspace()).
+ * @param size        Size of the CPU mask in bytes. Zero removes any
+ *                    restriction.
+ *
+ * @return 0 on success or an error code from @ref errno.h.
+ *
+ */
+sys_errno_t sys_task_set_affinity(uspace_ptr_uint8_t uspace_mask, size_t size)
+{
+	cpu_affinity_t *affinity;
+	errno_t rc = cpu_affinity_from_uspace(uspace_mask, size, &affinity);
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	task_set_affinity(TASK, affinity);
+	cpu_affinity_put(affinity);
+
+	return EOK;
+}
+
 /** Find task structure corresponding to task ID.
  *
  * The tasks_lock must be already held by the caller of this function and
@@ -482,6 +527,40 @@ task_t *task_next(task_t *cur)
 	return odict_get_instance(odlink, task_t, ltasks);
 }
 
+/** Set CPU affinity of a task and all its threads.
+ *
+ * If the current thread belongs to the task and may no longer run on the
+ * current CPU, it is migrated right away.
+ *
+ * @param task     Task.
+ * @param affinity New affinity or NULL for no restriction. The caller
+ *                 keeps its reference.
+ *
+ */
+void task_set_affinity(task_t *task, cpu_affinity_t *affinity)
+{
+	irq_spinlock_lock(&task->lock, true);
+
+	cpu_affinity_t *old = task->affinity;
+	task->affinity = cpu_affinity_ref(affinity);
+
+	list_foreach(task->threads, th_link, thread_t, thread) {
+		irq_spinlock_lock(&thread->lock, false);
+		cpu_affinity_t *old_thread = thread->affinity;
+		thread->affinity = cpu_affinity_ref(affinity);
+		irq_spinlock_unlock(&thread->lock, false);
+
+		cpu_affinity_put(old_thread);
+	}
+
+	irq_spinlock_unlock(&task->lock, true);
+
+	cpu_affinity_put(old);
+
+	if (task == TASK)
+		thread_affinity_apply();
+}
+
 /** Get accounting data of given task.
  *
  * Note that task lock of 'task' must be already held and interrupts must be
@@ -49,6 +49,8 @@
 #include <synch/waitq.h>
 #include <synch/syswaitq.h>
 #include <cpu.h>
+#include <cpu/affinity.h>
+#include <cpu/cpu_mask.h>
 #include <str.h>
 #include <context.h>
 #include <adt/list.h>
@@ -58,6 +60,7 @@
 #include <time/delay.h>
 #include <config.h>
 #include <arch/interrupt.h>
+#include <barrier.h>
 #include <smp/ipi.h>
 #include <arch/faddr.h>
 #include <atomic.h>
@@ -240,6 +243,52 @@ static void before_thread_is_ready(thread_t *thread)
 	assert(irq_spinlock_locked(&thread->lock));
 }
 
+/** Choose the CPU on whose run queue a thread will be made ready.
+ *
+ * The CPU on which the thread ran last is preferred unless the affinity
+ * of the thread excludes it. In that case, the least loaded of the
+ * allowed CPUs is chosen.
+ *
+ * @param thread Thread, locked.
+ *
+ * @return Target CPU.
+ *
+ */
+static cpu_t *thread_ready_cpu(thread_t *thread)
+{
+	assert(irq_spinlock_locked(&thread->lock));
+
+	cpu_t *cpu = thread->cpu ? thread->cpu : CPU;
+
+	if ((thread->nomigrate > 0) ||
+	    (cpu_affinity_allows(thread->affinity, cpu->id)))
+		return cpu;
+
+#ifdef CONFIG_FPU_LAZY
+	/*
+	 * Only the CPU holding the FPU context of the thread can save it.
+	 * The thread will migrate once that CPU preempts it.
+	 */
+	if ((thread->cpu != NULL) && (atomic_load_explicit(
+	    &thread->cpu->fpu_owner, memory_order_relaxed) == thread))
+		return cpu;
+#endif
+
+	cpu_t *best = NULL;
+	cpu_mask_for_each(thread->affinity->mask, cpu_id) {
+		cpu_t *candidate = &cpus[cpu_id];
+
+		if (!candidate->active)
+			continue;
+
+		if ((best == NULL) ||
+		    (atomic_load(&candidate->nrdy) < atomic_load(&best->nrdy)))
+			best = candidate;
+	}
+
+	return (best != NULL) ? best : cpu;
+}
+
 /** Make thread ready
  *
  * Switch thread to the ready state. Consumes reference passed by the caller.
@@ -258,8 +307,7 @@ void thread_ready(thread_t *thread)
 	int i = (thread->priority < RQ_COUNT - 1) ?
 	    ++thread->priority : thread->priority;
 
-	/* Prefer the CPU on which the thread ran last */
-	cpu_t *cpu = thread->cpu ? thread->cpu : CPU;
+	cpu_t *cpu = thread_ready_cpu(thread);
 
 	thread->state = Ready;
 
@@ -272,10 +320,22 @@ void thread_ready(thread_t *thread)
 
 	list_append(&thread->rq_link, &cpu->rq[i].rq);
 	cpu->rq[i].n++;
+	rq_bitmap_set(&cpu->rq_bitmap, i);
 	irq_spinlock_unlock(&(cpu->rq[i].lock), true);
 
 	atomic_inc(&nrdy);
 	atomic_inc(&cpu->nrdy);
+
+#ifdef CONFIG_SMP
+	/*
+	 * An idle CPU would not notice the thread before its next clock
+	 * tick, which may be as far as CLOCK_IDLE_MAX_TICKS away if the
+	 * CPU sleeps tickless. Pairs with the check in clock_idle_enter().
+	 */
+	memory_barrier();
+	if ((cpu != CPU) && (cpu->idle || cpu->tickless))
+		ipi_unicast(cpu->id, VECTOR_WAKEUP_IPI);
+#endif
 }
 
 /** Create new thread
@@ -334,7 +394,9 @@ thread_t *thread_create(void (*func)(void *), void *arg, task_t *task,
 	    ((flags & THREAD_FLAG_UNCOUNTED) == THREAD_FLAG_UNCOUNTED);
 	thread->priority = -1;          /* Start in rq[0] */
 	thread->cpu = NULL;
+	thread->affinity = NULL;
 	thread->stolen = false;
+	thread->handoff = NULL;
 	thread->uspace =
 	    ((flags & THREAD_FLAG_USPACE) == THREAD_FLAG_USPACE);
 
@@ -435,6 +497,9 @@ static void thread_destroy(void *obj)
 
 	interrupts_restore(ipl);
 
+	cpu_affinity_put(thread->affinity);
+	thread->affinity = NULL;
+
 	/*
 	 * Drop the reference to the containing task.
 	 */
@@ -478,6 +543,9 @@ void thread_attach(thread_t *thread, task_t *task)
 
 	list_append(&thread->th_link, &task->threads);
 
+	/* Inherit the task-wide CPU affinity. */
+	thread->affinity = cpu_affinity_ref(task->affinity);
+
 	irq_spinlock_unlock(&task->lock, false);
 
 	/*
@@ -685,6 +753,93 @@ void thread_wakeup(thread_t *thread)
 	}
 }
 
+/** Check whether a woken up thread may be switched to on the current CPU.
+ *
+ * @param thread Thread that is not in any run queue.
+ *
+ * @return True if the thread can run on the current CPU.
+ *
+ */
+static bool thread_can_handoff(thread_t *thread)
+{
+	irq_spinlock_lock(&thread->lock, true);
+
+	bool allowed = cpu_affinity_allows(thread->affinity, CPU->id) &&
+	    ((thread->nomigrate == 0) || (thread->cpu == CPU));
+
+#ifdef CONFIG_FPU_LAZY
+	/* Only the CPU holding the FPU context of the thread can save it. */
+	if ((thread->cpu != NULL) && (thread->cpu != CPU) &&
+	    (atomic_load_explicit(&thread->cpu->fpu_owner,
+	    memory_order_relaxed) == thread))
+		allowed = false;
+#endif
+
+	irq_spinlock_unlock(&thread->lock, true);
+	return allowed;
+}
+
+/** Wake up a thread and let it run next on the current CPU.
+ *
+ * Meant for a thread that is about to block waiting for the woken up
+ * thread, such as an IPC client that has just sent a request to a server
+ * waiting for calls. Instead of being put in a run queue, the woken up
+ * thread is kept aside and the scheduler switches straight to it when the
+ * current thread blocks, donating the rest of its time slice. If the
+ * current thread does anything else first, the woken up thread is made
+ * ready as usual by thread_handoff_release().
+ *
+ * Falls back to thread_wakeup() if the thread cannot run on this CPU.
+ *
+ * @param thread Thread to wake up.
+ *
+ */
+void thread_wakeup_handoff(thread_t *thread)
+{
+	assert(thread != NULL);
+
+	int state = atomic_exchange_explicit(&thread->sleep_state, SLEEP_WOKE,
+	    memory_order_release);
+
+	if (state != SLEEP_ASLEEP)
+		return;
+
+	/*
+	 * We now hold the reference that thread_ready() would consume.
+	 * Interrupts stay disabled so that the current thread cannot be
+	 * moved to another CPU between the check and the handoff.
+	 */
+	ipl_t ipl = interrupts_disable();
+
+	if ((THREAD == NULL) || (!THREAD->uspace) ||
+	    (!thread_can_handoff(thread))) {
+		interrupts_restore(ipl);
+		thread_ready(thread);
+		return;
+	}
+
+	thread_t *previous = THREAD->handoff;
+	THREAD->handoff = thread;
+	interrupts_restore(ipl);
+
+	if (previous != NULL)
+		thread_ready(previous);
+}
+
+/** Make the thread handed off by the current thread ready the usual way. */
+void thread_handoff_release(void)
+{
+	assert(THREAD != NULL);
+
+	ipl_t ipl = interrupts_disable();
+	thread_t *thread = THREAD->handoff;
+	THREAD->handoff = NULL;
+	interrupts_restore(ipl);
+
+	if (thread != NULL)
+		thread_ready(thread);
+}
+
 /** Prevent the current thread from being migrated to another processor. */
 void thread_migration_disable(void)
 {
@@ -1046,6 +1201,47 @@ static int threads_cmp(void *a, void *b)
 		return +1;
 }
 
+/** Set CPU affinity of a thread.
+ *
+ * If the current thread is no longer allowed to run on the current CPU,
+ * it is migrated right away.
+ *
+ * @param thread   Thread.
+ * @param affinity New affinity or NULL for no restriction. The caller
+ *                 keeps its reference.
+ *
+ */
+void thread_set_affinity(thread_t *thread, cpu_affinity_t *affinity)
+{
+	irq_spinlock_lock(&thread->lock, true);
+	cpu_affinity_t *old = thread->affinity;
+	thread->affinity = cpu_affinity_ref(affinity);
+	irq_spinlock_unlock(&thread->lock, true);
+
+	cpu_affinity_put(old);
+
+	if (thread == THREAD)
+		thread_affinity_apply();
+}
+
+/** Migrate the current thread if its CPU affinity excludes the current CPU.
+ *
+ */
+void thread_affinity_apply(void)
+{
+	ipl_t ipl = interrupts_disable();
+
+	irq_spinlock_lock(&THREAD->lock, false);
+	if (cpu_affinity_allows(THREAD->affinity, CPU->id)) {
+		irq_spinlock_unlock(&THREAD->lock, false);
+		interrupts_restore(ipl);
+		return;
+	}
+
+	/* Let thread_ready() put us on one of the allowed CPUs. */
+	scheduler_locked(ipl);
+}
+
 /** Process syscall to create new thread.
  *
  */
@@ -1095,6 +1291,7 @@ sys_errno_t sys_thread_create(uspace_ptr_uspace_arg_t uspace_uarg, uspace_ptr_ch
 				 * is still not visible to the system.
 				 * We can safely deallocate it.
 				 */
+				cpu_affinity_put(thread->affinity);
 				slab_free(thread_cache, thread);
 				free(kernel_uarg);
 
@@ -1150,6 +1347,52 @@ sys_errno_t sys_thread_get_id(uspace_ptr_thread_id_t uspace_thread_id)
 	    sizeof(THREAD->tid));
 }
 
+/** Syscall for setting CPU affinity of a thread.
+ *
+ * @param uspace_thread_id Userspace address of the ID of the thread. The
+ *                         thread must belong to the current task.
+ * @param uspace_mask      Userspace address of the CPU mask (see
+ *                         cpu_affinity_from_uspace()).
+ * @param size             Size of the CPU mask in bytes. Zero removes
+ *                         any restriction.
+ *
+ * @return 0 on success or an error code from @ref errno.h.
+ *
+ */
+sys_errno_t sys_thread_set_affinity(uspace_ptr_thread_id_t uspace_thread_id,
+    uspace_ptr_uint8_t uspace_mask, size_t size)
+{
+	thread_id_t thread_id;
+	errno_t rc = copy_from_uspace(&thread_id, uspace_thread_id,
+	    sizeof(thread_id));
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	cpu_affinity_t *affinity;
+	rc = cpu_affinity_from_uspace(uspace_mask, size, &affinity);
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	irq_spinlock_lock(&threads_lock, true);
+	thread_t *thread = thread_find_by_id(thread_id);
+	if ((thread != NULL) && (thread->task == TASK))
+		thread = thread_try_ref(thread);
+	else
+		thread = NULL;
+	irq_spinlock_unlock(&threads_lock, true);
+
+	if (thread == NULL) {
+		cpu_affinity_put(affinity);
+		return (sys_errno_t) ENOENT;
+	}
+
+	thread_set_affinity(thread, affinity);
+
+	thread_put(thread);
+	cpu_affinity_put(affinity);
+	return EOK;
+}
+
 /** Syscall wrapper for sleeping. */
 sys_errno_t sys_thread_usleep(uint32_t usec)
 {
@@ -315,6 +315,28 @@ void waitq_wake_one(waitq_t *wq)
 	irq_spinlock_unlock(&wq->lock, true);
 }
 
+/**
+ * Like waitq_wake_one(), but the woken up thread runs next on the current
+ * CPU once the current thread blocks. See thread_wakeup_handoff().
+ */
+void waitq_wake_one_handoff(waitq_t *wq)
+{
+	irq_spinlock_lock(&wq->lock, true);
+
+	if (!wq->closed) {
+		if (wq->wakeup_balance < 0 || list_empty(&wq->sleepers)) {
+			wq->wakeup_balance++;
+		} else {
+			thread_t *thread = list_get_instance(
+			    list_first(&wq->sleepers), thread_t, wq_link);
+			list_remove(&thread->wq_link);
+			thread_wakeup_handoff(thread);
+		}
+	}
+
+	irq_spinlock_unlock(&wq->lock, true);
+}
+
 static void _wake_all(waitq_t *wq)
 {
 	while (!list_empty(&wq->sleepers))
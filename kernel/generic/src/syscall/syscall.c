@@ -65,11 +65,13 @@ static syshandler_t syscall_table[] = {
 	[SYS_THREAD_GET_ID] = (syshandler_t) sys_thread_get_id,
 	[SYS_THREAD_USLEEP] = (syshandler_t) sys_thread_usleep,
 	[SYS_THREAD_UDELAY] = (syshandler_t) sys_thread_udelay,
+	[SYS_THREAD_SET_AFFINITY] = (syshandler_t) sys_thread_set_affinity,
 
 	[SYS_TASK_GET_ID] = (syshandler_t) sys_task_get_id,
 	[SYS_TASK_SET_NAME] = (syshandler_t) sys_task_set_name,
 	[SYS_TASK_KILL] = (syshandler_t) sys_task_kill,
 	[SYS_TASK_EXIT] = (syshandler_t) sys_task_exit,
+	[SYS_TASK_SET_AFFINITY] = (syshandler_t) sys_task_set_affinity,
 	[SYS_PROGRAM_SPAWN_LOADER] = (syshandler_t) sys_program_spawn_loader,
 
 	/* Synchronization related syscalls. */
@@ -85,6 +87,7 @@ static syshandler_t syscall_table[] = {
 	[SYS_AS_AREA_CHANGE_FLAGS] = (syshandler_t) sys_as_area_change_flags,
 	[SYS_AS_AREA_GET_INFO] = (syshandler_t) sys_as_area_get_info,
 	[SYS_AS_AREA_DESTROY] = (syshandler_t) sys_as_area_destroy,
+	[SYS_AS_AREA_DISCARD] = (syshandler_t) sys_as_area_discard,
 
 	/* Page mapping related syscalls. */
 	[SYS_PAGE_FIND_MAPPING] = (syshandler_t) sys_page_find_mapping,
@@ -100,6 +103,8 @@ static syshandler_t syscall_table[] = {
 	[SYS_IPC_POKE] = (syshandler_t) sys_ipc_poke,
 	[SYS_IPC_HANGUP] = (syshandler_t) sys_ipc_hangup,
 	[SYS_IPC_CONNECT_KBOX] = (syshandler_t) sys_ipc_connect_kbox,
+	[SYS_IPC_SUBMIT] = (syshandler_t) sys_ipc_submit,
+	[SYS_IPC_WAIT_MULTI] = (syshandler_t) sys_ipc_wait_multi,
 
 	/* Event notification syscalls. */
 	[SYS_IPC_EVENT_SUBSCRIBE] = (syshandler_t) sys_ipc_event_subscribe,
@@ -160,6 +165,14 @@ sysarg_t syscall_handler(sysarg_t a1, sysarg_t a2, sysarg_t a3,
 		udebug_syscall_event(a1, a2, a3, a4, a5, a6, id, 0, false);
 #endif
 
+	/*
+	 * A thread handed off by an earlier system call is only worth keeping
+	 * aside for a system call which is going to block.
+	 */
+	if ((THREAD->handoff != NULL) && (id != SYS_IPC_WAIT) &&
+	    (id != SYS_IPC_WAIT_MULTI) && (id != SYS_WAITQ_SLEEP))
+		thread_handoff_release();
+
 	sysarg_t rc;
 	if (id < sizeof_array(syscall_table)) {
 		rc = syscall_table[id](a1, a2, a3, a4, a5, a6);
@@ -43,6 +43,7 @@
 #include <synch/mutex.h>
 #include <time/clock.h>
 #include <mm/frame.h>
+#include <mm/slab.h>
 #include <proc/task.h>
 #include <proc/thread.h>
 #include <interrupt.h>
@@ -50,8 +51,10 @@
 #include <str.h>
 #include <errno.h>
 #include <cpu.h>
+#include <cpu/affinity.h>
 #include <arch.h>
 #include <stdlib.h>
+#include <macros.h>
 
 /** Bits of fixed-point precision for load */
 #define LOAD_FIXED_SHIFT  11
@@ -124,6 +127,16 @@ static void *get_stats_cpus(struct sysinfo_item *item, size_t *size,
 
 		stats_cpus[i].busy_cycles = atomic_time_read(&cpus[i].busy_cycles);
 		stats_cpus[i].idle_cycles = atomic_time_read(&cpus[i].idle_cycles);
+
+		stats_cpus[i].steals = atomic_load(&cpus[i].steals);
+		stats_cpus[i].steals_failed = atomic_load(&cpus[i].steals_failed);
+		stats_cpus[i].migrations = atomic_load(&cpus[i].migrations);
+
+		stats_cpus[i].tlb_shootdowns =
+		    atomic_load(&cpus[i].tlb_shootdowns);
+		stats_cpus[i].tlb_ipis_sent = atomic_load(&cpus[i].tlb_ipis_sent);
+		stats_cpus[i].tlb_ipis_received =
+		    atomic_load(&cpus[i].tlb_ipis_received);
 	}
 
 	return ((void *) stats_cpus);
@@ -153,11 +166,11 @@ static size_t get_task_virtmem(as_t *as)
 	/* Walk areas in the address space and count pages */
 	as_area_t *area = as_area_first(as);
 	while (area != NULL) {
-		if (mutex_trylock(&area->lock) != EOK)
-			continue;
+		if (mutex_trylock(&area->lock) == EOK) {
+			pages += area->pages;
+			mutex_unlock(&area->lock);
+		}
 
-		pages += area->pages;
-		mutex_unlock(&area->lock);
 		area = as_area_next(area);
 	}
 
@@ -190,11 +203,11 @@ static size_t get_task_resmem(as_t *as)
 	/* Walk areas in the address space and count pages */
 	as_area_t *area = as_area_first(as);
 	while (area != NULL) {
-		if (mutex_trylock(&area->lock) != EOK)
-			continue;
+		if (mutex_trylock(&area->lock) == EOK) {
+			pages += area->used_space.pages;
+			mutex_unlock(&area->lock);
+		}
 
-		pages += area->used_space.pages;
-		mutex_unlock(&area->lock);
 		area = as_area_next(area);
 	}
 
@@ -224,6 +237,7 @@ static void produce_stats_task(task_t *task, stats_task_t *stats_task)
 	task_get_accounting(task, &(stats_task->ucycles),
 	    &(stats_task->kcycles));
 	stats_task->ipc_info = task->ipc_info;
+	stats_task->affinity = cpu_affinity_summary(task->affinity);
 }
 
 /** Get task statistics
@@ -312,6 +326,8 @@ static void produce_stats_thread(thread_t *thread, stats_thread_t *stats_thread)
 		stats_thread->cpu = thread->cpu->id;
 	} else
 		stats_thread->on_cpu = false;
+
+	stats_thread->affinity = cpu_affinity_summary(thread->affinity);
 }
 
 /** Get thread statistics
@@ -759,6 +775,40 @@ static sysinfo_return_t get_stats_exception(const char *name, bool dry_run,
 	return ret;
 }
 
+/** Get statistics of all slab caches
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing several stats_slab_t structures.
+ *         If the return value is not NULL, it should be freed
+ *         in the context of the sysinfo request.
+ */
+static void *get_stats_slabs(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	/* Count the caches first, we must not allocate while walking them */
+	size_t count = slab_stats_get(NULL, 0);
+
+	*size = sizeof(stats_slab_t) * count;
+	if (dry_run)
+		return NULL;
+
+	stats_slab_t *stats_slabs = (stats_slab_t *) malloc(*size);
+	if (stats_slabs == NULL) {
+		*size = 0;
+		return NULL;
+	}
+
+	/* Caches might have been destroyed in the meantime */
+	count = min(count, slab_stats_get(stats_slabs, count));
+	*size = sizeof(stats_slab_t) * count;
+
+	return ((void *) stats_slabs);
+}
+
 /** Get physical memory statistics
  *
  * @param item    Sysinfo item (unused).
@@ -871,6 +921,7 @@ void stats_init(void)
 
 	sysinfo_set_item_gen_data("system.cpus", NULL, get_stats_cpus, NULL);
 	sysinfo_set_item_gen_data("system.physmem", NULL, get_stats_physmem, NULL);
+	sysinfo_set_item_gen_data("system.slabs", NULL, get_stats_slabs, NULL);
 	sysinfo_set_item_gen_data("system.load", NULL, get_stats_load, NULL);
 	sysinfo_set_item_gen_data("system.tasks", NULL, get_stats_tasks, NULL);
 	sysinfo_set_item_gen_data("system.threads", NULL, get_stats_threads, NULL);
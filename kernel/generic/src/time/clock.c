@@ -59,10 +59,14 @@
 #include <ddi/ddi.h>
 #include <arch/cycle.h>
 #include <preemption.h>
+#include <assert.h>
 
 /* Pointer to variable with uptime */
 uptime_t *uptime;
 
+/** Tickless idle support of the clock source, NULL if there is none. */
+clock_tickless_ops_t *clock_tickless_ops = NULL;
+
 /** Physical memory area of the real time clock */
 static parea_t clock_parea;
 
@@ -146,38 +150,7 @@ void clock(void)
 	/* Account CPU usage */
 	cpu_update_accounting();
 
-	/*
-	 * To avoid lock ordering problems,
-	 * run all expired timeouts as you visit them.
-	 *
-	 */
-
-	irq_spinlock_lock(&CPU->timeoutlock, false);
-
-	link_t *cur;
-	while ((cur = list_first(&CPU->timeout_active_list)) != NULL) {
-		timeout_t *timeout = list_get_instance(cur, timeout_t, link);
-
-		if (current_clock_tick <= timeout->deadline) {
-			break;
-		}
-
-		list_remove(cur);
-		timeout_handler_t handler = timeout->handler;
-		void *arg = timeout->arg;
-		atomic_bool *finished = &timeout->finished;
-
-		irq_spinlock_unlock(&CPU->timeoutlock, false);
-
-		handler(arg);
-
-		/* Signal that the handler is finished. */
-		atomic_store_explicit(finished, true, memory_order_release);
-
-		irq_spinlock_lock(&CPU->timeoutlock, false);
-	}
-
-	irq_spinlock_unlock(&CPU->timeoutlock, false);
+	timeout_run_expired();
 
 	/*
 	 * Do CPU usage accounting and find out whether to preempt THREAD.
@@ -185,6 +158,13 @@ void clock(void)
 	 */
 
 	if (THREAD) {
+		/*
+		 * Do not keep a handed off thread aside for longer than a tick
+		 * if THREAD does not block.
+		 */
+		if (THREAD->handoff != NULL)
+			thread_handoff_release();
+
 		if (current_clock_tick >= CPU->preempt_deadline && PREEMPTION_ENABLED) {
 			scheduler();
 #ifdef CONFIG_UDEBUG
@@ -200,5 +180,67 @@ void clock(void)
 	}
 }
 
+/** Stop the periodic clock before the CPU goes idle
+ *
+ * Program the clock source to skip all ticks until the nearest
+ * timeout of the CPU is due, if the clock source supports it.
+ * Must be paired with clock_idle_exit() once the CPU wakes up.
+ *
+ */
+void clock_idle_enter(void)
+{
+	assert(interrupts_disabled());
+
+	if (clock_tickless_ops == NULL)
+		return;
+
+	/* The boot CPU keeps the uptime counters fresh for the others. */
+	if ((CPU->id == 0) && (config.cpu_active > 1))
+		return;
+
+	uint64_t now = CPU->current_clock_tick;
+	deadline_t deadline = timeout_next_deadline();
+
+	/* clock() runs the timeout on the tick following its deadline. */
+	uint64_t ticks = CLOCK_IDLE_MAX_TICKS;
+	if (deadline < now + ticks)
+		ticks = (deadline < now) ? 1 : deadline + 1 - now;
+
+	/* The next periodic tick is just as good. */
+	if (ticks <= 1)
+		return;
+
+	CPU->tickless = true;
+
+	/*
+	 * A thread queued on this CPU before tickless became visible
+	 * might not have sent a wakeup IPI, see thread_ready().
+	 */
+	memory_barrier();
+	if (atomic_load(&CPU->nrdy) > 0) {
+		CPU->tickless = false;
+		return;
+	}
+
+	clock_tickless_ops->idle_enter(ticks);
+}
+
+/** Resume the periodic clock after the CPU wakes up
+ *
+ * Ticks skipped while idle are accounted as missed by the next clock
+ * interrupt, which comes right away if the CPU slept past the tick
+ * that would have been due.
+ *
+ */
+void clock_idle_exit(void)
+{
+	assert(interrupts_disabled());
+
+	if (CPU->tickless) {
+		CPU->tickless = false;
+		clock_tickless_ops->idle_exit();
+	}
+}
+
 /** @}
  */
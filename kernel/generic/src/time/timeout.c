@@ -37,7 +37,10 @@
  */
 
 #include <time/timeout.h>
+#include <time/timeout_wheel.h>
 #include <typedefs.h>
+#include <bitops.h>
+#include <macros.h>
 #include <config.h>
 #include <panic.h>
 #include <synch/spinlock.h>
@@ -54,7 +57,156 @@
 void timeout_init(void)
 {
 	irq_spinlock_initialize(&CPU->timeoutlock, "cpu.timeoutlock");
-	list_initialize(&CPU->timeout_active_list);
+
+	timeout_wheel_t *wheel = &CPU->timeout_wheel;
+
+	wheel->tick = CPU->current_clock_tick;
+	wheel->count = 0;
+
+	for (unsigned int level = 0; level < TIMEOUT_WHEEL_LEVELS; level++) {
+		wheel->bitmap[level] = 0;
+
+		for (unsigned int i = 0; i < TIMEOUT_WHEEL_SLOTS; i++)
+			list_initialize(&wheel->slot[level][i]);
+	}
+}
+
+/** Number of ticks spanned by the first @a level levels of the wheel. */
+static inline uint64_t wheel_span(unsigned int level)
+{
+	return UINT64_C(1) << (TIMEOUT_WHEEL_BITS * level);
+}
+
+/** Rotate the slot bitmap so that slot @a first becomes bit 0. */
+static inline uint64_t wheel_rotate(uint64_t bitmap, unsigned int first)
+{
+	return (bitmap >> first) | (bitmap << ((TIMEOUT_WHEEL_SLOTS - first) &
+	    TIMEOUT_WHEEL_MASK));
+}
+
+/** Insert timeout into the wheel
+ *
+ * The level is chosen by the distance of the deadline from the current
+ * wheel position, the slot by the bits of the deadline resolved by that
+ * level. Overdue timeouts go to the slot of the current tick so that
+ * they fire on the next clock interrupt.
+ *
+ * @param wheel   Timing wheel, with the respective timeoutlock held.
+ * @param timeout Timeout with the deadline set.
+ *
+ */
+static void wheel_insert(timeout_wheel_t *wheel, timeout_t *timeout)
+{
+	uint64_t deadline = max(timeout->deadline, wheel->tick);
+	uint64_t delta = deadline - wheel->tick;
+
+	unsigned int level = 0;
+	if (delta > 0)
+		level = fnzb64(delta) / TIMEOUT_WHEEL_BITS;
+
+	if (level >= TIMEOUT_WHEEL_LEVELS) {
+		/* Park it at the farthest point of the wheel. */
+		level = TIMEOUT_WHEEL_LEVELS - 1;
+		deadline = wheel->tick + wheel_span(TIMEOUT_WHEEL_LEVELS) - 1;
+	}
+
+	unsigned int idx = (deadline >> (TIMEOUT_WHEEL_BITS * level)) &
+	    TIMEOUT_WHEEL_MASK;
+
+	timeout->slot = level * TIMEOUT_WHEEL_SLOTS + idx;
+	list_append(&timeout->link, &wheel->slot[level][idx]);
+	wheel->bitmap[level] |= UINT64_C(1) << idx;
+	wheel->count++;
+}
+
+/** Remove timeout from the wheel
+ *
+ * @param wheel   Timing wheel, with the respective timeoutlock held.
+ * @param timeout Timeout linked to the wheel.
+ *
+ */
+static void wheel_remove(timeout_wheel_t *wheel, timeout_t *timeout)
+{
+	unsigned int level = timeout->slot / TIMEOUT_WHEEL_SLOTS;
+	unsigned int idx = timeout->slot % TIMEOUT_WHEEL_SLOTS;
+
+	list_remove(&timeout->link);
+	if (list_empty(&wheel->slot[level][idx]))
+		wheel->bitmap[level] &= ~(UINT64_C(1) << idx);
+	wheel->count--;
+}
+
+/** Move timeouts due within the next wheel rotation to the lower levels
+ *
+ * Called whenever the wheel position changes. A slot of level n is
+ * cascaded when the position crosses a multiple of 64^n whose level n
+ * digit matches the slot.
+ *
+ */
+static void wheel_cascade(timeout_wheel_t *wheel)
+{
+	for (unsigned int level = 1; level < TIMEOUT_WHEEL_LEVELS; level++) {
+		if ((wheel->tick & (wheel_span(level) - 1)) != 0)
+			break;
+
+		unsigned int idx = (wheel->tick >> (TIMEOUT_WHEEL_BITS * level)) &
+		    TIMEOUT_WHEEL_MASK;
+		if ((wheel->bitmap[level] & (UINT64_C(1) << idx)) == 0)
+			continue;
+
+		list_t *slot = &wheel->slot[level][idx];
+		link_t *cur;
+		while ((cur = list_first(slot)) != NULL) {
+			timeout_t *timeout = list_get_instance(cur, timeout_t, link);
+			wheel_remove(wheel, timeout);
+			wheel_insert(wheel, timeout);
+		}
+	}
+}
+
+/** Find the next wheel position where anything needs to be done
+ *
+ * The slot of the current position is assumed to be empty.
+ *
+ * @return First position after wheel->tick where a level 0 slot needs
+ *         to be run or a higher level slot needs to be cascaded.
+ *         UINT64_MAX if the wheel is empty.
+ *
+ */
+static uint64_t wheel_next_event(timeout_wheel_t *wheel)
+{
+	uint64_t next = UINT64_MAX;
+
+	if (wheel->count == 0)
+		return next;
+
+	for (unsigned int level = 0; level < TIMEOUT_WHEEL_LEVELS; level++) {
+		if (wheel->bitmap[level] == 0)
+			continue;
+
+		/* Index of the first multiple of 64^level after wheel->tick. */
+		uint64_t first = (wheel->tick >> (TIMEOUT_WHEEL_BITS * level)) + 1;
+		uint64_t pending = wheel_rotate(wheel->bitmap[level],
+		    first & TIMEOUT_WHEEL_MASK);
+		uint64_t event = (first + fnzb64(pending & -pending)) <<
+		    (TIMEOUT_WHEEL_BITS * level);
+
+		next = min(next, event);
+	}
+
+	return next;
+}
+
+/** Advance the wheel position towards @a now
+ *
+ * Positions where nothing needs to be done are skipped at once, so
+ * catching up after a long tickless sleep is cheap.
+ *
+ */
+static void wheel_advance(timeout_wheel_t *wheel, uint64_t now)
+{
+	wheel->tick = min(wheel_next_event(wheel), now);
+	wheel_cascade(wheel);
 }
 
 /** Initialize timeout
@@ -92,21 +244,7 @@ static void timeout_register_deadline_locked(timeout_t *timeout, deadline_t dead
 		.finished = ATOMIC_VAR_INIT(false),
 	};
 
-	/* Insert timeout into the active timeouts list according to timeout->deadline. */
-
-	link_t *last = list_last(&CPU->timeout_active_list);
-	if (last == NULL || timeout->deadline >= list_get_instance(last, timeout_t, link)->deadline) {
-		list_append(&timeout->link, &CPU->timeout_active_list);
-	} else {
-		for (link_t *cur = list_first(&CPU->timeout_active_list); cur != NULL;
-		    cur = list_next(cur, &CPU->timeout_active_list)) {
-
-			if (timeout->deadline < list_get_instance(cur, timeout_t, link)->deadline) {
-				list_insert_before(&timeout->link, cur);
-				break;
-			}
-		}
-	}
+	wheel_insert(&CPU->timeout_wheel, timeout);
 }
 
 /** Register timeout
@@ -158,7 +296,7 @@ bool timeout_unregister(timeout_t *timeout)
 
 	bool success = link_in_use(&timeout->link);
 	if (success) {
-		list_remove(&timeout->link);
+		wheel_remove(&timeout->cpu->timeout_wheel, timeout);
 	}
 
 	irq_spinlock_unlock(&timeout->cpu->timeoutlock, true);
@@ -172,5 +310,80 @@ bool timeout_unregister(timeout_t *timeout)
 	return success;
 }
 
+/** Find the earliest deadline of the current CPU
+ *
+ * Only call when interrupts are disabled. The result is conservative,
+ * it may be earlier than the nearest actual deadline when the wheel
+ * needs to cascade timeouts from its higher levels first.
+ *
+ * @return Deadline after which clock() must run on this CPU again.
+ *         DEADLINE_NEVER if there are no timeouts registered.
+ *
+ */
+deadline_t timeout_next_deadline(void)
+{
+	timeout_wheel_t *wheel = &CPU->timeout_wheel;
+
+	irq_spinlock_lock(&CPU->timeoutlock, false);
+
+	deadline_t deadline;
+	if (wheel->count == 0)
+		deadline = DEADLINE_NEVER;
+	else if (!list_empty(&wheel->slot[0][wheel->tick & TIMEOUT_WHEEL_MASK]))
+		deadline = wheel->tick;
+	else
+		deadline = wheel_next_event(wheel);
+
+	irq_spinlock_unlock(&CPU->timeoutlock, false);
+
+	return deadline;
+}
+
+/** Run expired timeouts
+ *
+ * Run handlers of all timeouts of the current CPU whose deadline
+ * precedes the current clock tick. Only call from clock().
+ *
+ */
+void timeout_run_expired(void)
+{
+	timeout_wheel_t *wheel = &CPU->timeout_wheel;
+	uint64_t now = CPU->current_clock_tick;
+
+	/*
+	 * To avoid lock ordering problems,
+	 * run all expired timeouts as you visit them.
+	 *
+	 */
+
+	irq_spinlock_lock(&CPU->timeoutlock, false);
+
+	while (wheel->tick < now) {
+		link_t *cur = list_first(&wheel->slot[0][wheel->tick & TIMEOUT_WHEEL_MASK]);
+		if (cur == NULL) {
+			wheel_advance(wheel, now);
+			continue;
+		}
+
+		timeout_t *timeout = list_get_instance(cur, timeout_t, link);
+
+		wheel_remove(wheel, timeout);
+		timeout_handler_t handler = timeout->handler;
+		void *arg = timeout->arg;
+		atomic_bool *finished = &timeout->finished;
+
+		irq_spinlock_unlock(&CPU->timeoutlock, false);
+
+		handler(arg);
+
+		/* Signal that the handler is finished. */
+		atomic_store_explicit(finished, true, memory_order_release);
+
+		irq_spinlock_lock(&CPU->timeoutlock, false);
+	}
+
+	irq_spinlock_unlock(&CPU->timeoutlock, false);
+}
+
 /** @}
  */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <arch.h>
+#include <arch/cycle.h>
+#include <cap/cap.h>
+#include <proc/task.h>
+#include <stdlib.h>
+
+#define LOOKUPS  1000000
+
+static const size_t table_sizes[] = { 10, 1000, 100000 };
+
+/*
+ * Measure how long it takes to translate a capability handle to a kernel
+ * object with kobject_get() while the calling task holds a given number of
+ * published capabilities.
+ */
+static const char *lookup_bench(size_t count)
+{
+	const char *err = NULL;
+	size_t published = 0;
+
+	cap_handle_t *handles = malloc(count * sizeof(cap_handle_t));
+	kobject_t **kobjs = malloc(count * sizeof(kobject_t *));
+	if (!handles || !kobjs) {
+		err = "Not enough memory for the handle arrays";
+		goto out;
+	}
+
+	for (; published < count; published++) {
+		kobjs[published] = kobject_alloc(0);
+		if (!kobjs[published]) {
+			err = "Unable to allocate kernel object";
+			break;
+		}
+
+		if (cap_alloc(TASK, &handles[published]) != EOK) {
+			kobject_free(kobjs[published]);
+			err = "Unable to allocate capability";
+			break;
+		}
+
+		/*
+		 * The reference held by the capability is never dropped by
+		 * kobject_put(), so the raw object is never destroyed.
+		 */
+		kobject_initialize(kobjs[published], KOBJECT_TYPE_WAITQ, NULL);
+		cap_publish(TASK, handles[published], kobjs[published]);
+	}
+
+	if (err)
+		goto cleanup;
+
+	uint64_t start = get_cycle();
+
+	for (size_t i = 0; i < LOOKUPS; i++) {
+		/* Stride through the table so that all leaves are touched. */
+		size_t idx = (i * 7919) % count;
+		kobject_t *kobj = kobject_get(TASK, handles[idx],
+		    KOBJECT_TYPE_WAITQ);
+		if (kobj != kobjs[idx]) {
+			err = "kobject_get() returned a wrong object";
+			goto cleanup;
+		}
+		kobject_put(kobj);
+	}
+
+	uint64_t cycles = get_cycle() - start;
+
+	TPRINTF("%zu capabilities: %d lookups in %" PRIu64 " cycles, "
+	    "%" PRIu64 " cycles per lookup\n", count, LOOKUPS, cycles,
+	    cycles / LOOKUPS);
+
+cleanup:
+	for (size_t i = 0; i < published; i++) {
+		kobject_t *kobj = cap_unpublish(TASK, handles[i],
+		    KOBJECT_TYPE_WAITQ);
+		assert(kobj == kobjs[i]);
+		kobject_free(kobj);
+		cap_free(TASK, handles[i]);
+	}
+
+	/* Do not leave the kernel console task with a huge table. */
+	caps_task_shrink(TASK);
+
+out:
+	if (kobjs)
+		free(kobjs);
+	if (handles)
+		free(handles);
+	return err;
+}
+
+const char *test_cap1(void)
+{
+	for (size_t i = 0; i < sizeof(table_sizes) / sizeof(table_sizes[0]); i++) {
+		const char *err = lookup_bench(table_sizes[i]);
+		if (err)
+			return err;
+	}
+
+	return NULL;
+}
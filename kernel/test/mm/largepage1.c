@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <mm/as.h>
+#include <mm/page.h>
+#include <mm/frame.h>
+#include <genarch/mm/page_pt.h>
+#include <genarch/mm/page_ht.h>
+#include <arch/mm/page.h>
+#include <typedefs.h>
+
+/** Check that the pages of [base, base + size) map the frames from frame.
+ *
+ * @param hole Page which must not be mapped or zero.
+ */
+static const char *check_mapping(as_t *as, uintptr_t base, uintptr_t frame,
+    size_t size, uintptr_t hole)
+{
+	for (uintptr_t off = 0; off < size; off += PAGE_SIZE) {
+		pte_t pte;
+		bool found = page_mapping_find(as, base + off, false, &pte);
+
+		if (base + off == hole) {
+			if (found && PTE_VALID(&pte))
+				return "Removed page is still mapped";
+			continue;
+		}
+
+		if (!found || !PTE_VALID(&pte) || !PTE_PRESENT(&pte))
+			return "Page of the large mapping not found";
+
+		if (PTE_GET_FRAME(&pte) != frame + off)
+			return "Page of the large mapping maps a wrong frame";
+	}
+
+	return NULL;
+}
+
+/** Check that a fault in a large-page anonymous area maps a large page. */
+static const char *test_anon_fault(size_t size)
+{
+	as_t *as = as_create(0);
+	if (as == NULL)
+		return "Cannot create address space";
+
+	uintptr_t base = 16 * size;
+	const char *err = NULL;
+
+	as_area_t *area = as_area_create(as, AS_AREA_READ | AS_AREA_WRITE |
+	    AS_AREA_CACHEABLE | AS_AREA_LARGE_PAGES, 2 * size,
+	    AS_AREA_ATTR_NONE, &anon_backend, NULL, &base, 0);
+	if (area == NULL) {
+		as_release(as);
+		return "Cannot create address space area";
+	}
+
+	mutex_lock(&as->lock);
+	mutex_lock(&area->lock);
+	page_table_lock(as, false);
+
+	TPRINTF("Faulting in page %p of a large-page area.\n",
+	    (void *) (base + PAGE_SIZE));
+	if (area->backend->page_fault(area, base + PAGE_SIZE,
+	    PF_ACCESS_WRITE) != AS_PF_OK) {
+		err = "Page fault not serviced";
+		goto out;
+	}
+
+	pte_t pte;
+	if (!page_mapping_find(as, base, false, &pte) || !PTE_VALID(&pte)) {
+		err = "Large page not mapped by the fault";
+		goto out;
+	}
+
+	err = check_mapping(as, base, PTE_GET_FRAME(&pte), size, 0);
+	if (err != NULL)
+		goto out;
+
+	if (page_mapping_find(as, base + size, false, &pte) &&
+	    PTE_VALID(&pte))
+		err = "Fault mapped beyond the large page";
+
+out:
+	page_table_unlock(as, false);
+	mutex_unlock(&area->lock);
+	mutex_unlock(&as->lock);
+
+	as_area_destroy(as, base);
+	as_release(as);
+
+	return err;
+}
+
+const char *test_largepage1(void)
+{
+	size_t size = page_mapping_large_size();
+	if (size == 0) {
+		TPRINTF("Large pages not supported.\n");
+		return NULL;
+	}
+
+	size_t count = size >> FRAME_WIDTH;
+	uintptr_t frame = frame_alloc(count, FRAME_LOWMEM | FRAME_ATOMIC,
+	    size - 1);
+	if (frame == 0) {
+		TPRINTF("Cannot allocate %zu contiguous frames.\n", count);
+		return NULL;
+	}
+
+	as_t *as = as_create(0);
+	if (as == NULL) {
+		frame_free(frame, count);
+		return "Cannot create address space";
+	}
+
+	uintptr_t base = 16 * size;
+	uintptr_t hole = base + size / 2;
+	const char *err;
+
+	page_table_lock(as, true);
+
+	TPRINTF("Mapping large page %p to %p.\n", (void *) base,
+	    (void *) frame);
+	page_mapping_insert_large(as, base, frame,
+	    PAGE_USER | PAGE_READ | PAGE_WRITE | PAGE_CACHEABLE);
+
+	err = check_mapping(as, base, frame, size, 0);
+	if (err != NULL)
+		goto out;
+
+	TPRINTF("Removing page %p from the large mapping.\n", (void *) hole);
+	page_mapping_remove(as, hole);
+
+	err = check_mapping(as, base, frame, size, hole);
+	if (err != NULL)
+		goto out;
+
+	TPRINTF("Removing the rest of the large mapping.\n");
+	for (uintptr_t off = 0; off < size; off += PAGE_SIZE)
+		page_mapping_remove(as, base + off);
+
+	for (uintptr_t off = 0; off < size; off += PAGE_SIZE) {
+		pte_t pte;
+		if (page_mapping_find(as, base + off, false, &pte) &&
+		    PTE_VALID(&pte)) {
+			err = "Page still mapped after removing the mapping";
+			break;
+		}
+	}
+
+out:
+	if (err != NULL) {
+		for (uintptr_t off = 0; off < size; off += PAGE_SIZE)
+			page_mapping_remove(as, base + off);
+	}
+
+	page_table_unlock(as, true);
+	as_release(as);
+	frame_free(frame, count);
+
+	if (err != NULL)
+		return err;
+
+	/* The frames are free again, so the fault should find them. */
+	return test_anon_fault(size);
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <mm/frame.h>
+#include <mm/km.h>
+#include <mm/page.h>
+#include <stdlib.h>
+#include <mem.h>
+#include <atomic.h>
+#include <arch.h>
+#include <arch/cycle.h>
+#include <cpu.h>
+#include <proc/thread.h>
+
+/** Pages faulted in by each thread before they are all freed again. */
+#define PAGES   1024
+#define ROUNDS  16
+
+static atomic_size_t threads_ready;
+static atomic_bool go;
+static atomic_size_t threads_finished;
+static atomic_size_t threads_failed;
+
+typedef struct {
+	bool running;
+	uint64_t cycles;
+} faulter_t;
+
+static faulter_t *faulters;
+
+/*
+ * Each thread does the same frame work the anonymous memory backend
+ * does on a page fault: allocate a frame, map it temporarily, zero it.
+ * The frames are kept until the whole "area" is faulted in and then
+ * released, as on as_area_destroy().
+ */
+static void faulter(void *arg)
+{
+	size_t idx = (size_t) arg;
+
+	uintptr_t *frames = malloc(PAGES * sizeof(uintptr_t));
+	if (frames == NULL)
+		atomic_inc(&threads_failed);
+
+	atomic_inc(&threads_ready);
+	while (!atomic_load(&go))
+		scheduler();
+
+	if (frames == NULL) {
+		atomic_inc(&threads_finished);
+		return;
+	}
+
+	uint64_t start = get_cycle();
+
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		for (size_t i = 0; i < PAGES; i++) {
+			uintptr_t kpage = km_temporary_page_get(&frames[i],
+			    FRAME_NO_RESERVE);
+			memsetb((void *) kpage, PAGE_SIZE, 0);
+			km_temporary_page_put(kpage);
+		}
+
+		for (size_t i = 0; i < PAGES; i++)
+			frame_free_noreserve(frames[i], 1);
+	}
+
+	faulters[idx].cycles = get_cycle() - start;
+
+	free(frames);
+	atomic_inc(&threads_finished);
+}
+
+const char *test_pagefault1(void)
+{
+	faulters = malloc(config.cpu_count * sizeof(faulter_t));
+	if (faulters == NULL)
+		return "Unable to allocate memory";
+
+	memsetb(faulters, config.cpu_count * sizeof(faulter_t), 0);
+
+	atomic_store(&threads_ready, 0);
+	atomic_store(&go, false);
+	atomic_store(&threads_finished, 0);
+	atomic_store(&threads_failed, 0);
+
+	/* One faulting thread per active CPU */
+	size_t total = 0;
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		if (!cpus[i].active)
+			continue;
+
+		thread_t *thread = thread_create(faulter, (void *) i, TASK,
+		    THREAD_FLAG_NONE, "faulter");
+		if (!thread) {
+			TPRINTF("Could not create thread for cpu%zu\n", i);
+			continue;
+		}
+
+		thread_wire(thread, &cpus[i]);
+		thread_ready(thread);
+		faulters[i].running = true;
+		total++;
+	}
+
+	if (total == 0) {
+		free(faulters);
+		return "Unable to create any thread";
+	}
+
+	while (atomic_load(&threads_ready) < total)
+		thread_usleep(10000);
+
+	atomic_store(&go, true);
+
+	while (atomic_load(&threads_finished) < total)
+		thread_usleep(100000);
+
+	if (atomic_load(&threads_failed) > 0) {
+		free(faulters);
+		return "Unable to allocate memory";
+	}
+
+	uint64_t faults = (uint64_t) PAGES * ROUNDS;
+	uint64_t sum = 0;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		if (!faulters[i].running)
+			continue;
+
+		TPRINTF("cpu%zu: %" PRIu64 " faults in %" PRIu64 " cycles, "
+		    "%" PRIu64 " cycles per fault\n", i, faults,
+		    faulters[i].cycles, faulters[i].cycles / faults);
+		sum += faulters[i].cycles / faults;
+	}
+
+	TPRINTF("%zu CPUs: %" PRIu64 " cycles per fault on average\n",
+	    total, sum / total);
+
+	free(faulters);
+	return NULL;
+}
@@ -40,11 +40,14 @@ bool test_quiet;
 
 test_t tests[] = {
 #include <atomic/atomic1.def>
+#include <cap/cap1.def>
 #include <debug/mips1.def>
 #include <fault/fault1.def>
 #include <mm/falloc1.def>
 #include <mm/falloc2.def>
 #include <mm/mapping1.def>
+#include <mm/largepage1.def>
+#include <mm/pagefault1.def>
 #include <mm/slab1.def>
 #include <mm/slab2.def>
 #include <synch/semaphore1.def>
@@ -55,6 +58,8 @@ test_t tests[] = {
 #include <print/print4.def>
 #include <print/print5.def>
 #include <thread/thread1.def>
+#include <thread/sched1.def>
+#include <time/timeout1.def>
 	{
 		.name = NULL,
 		.desc = NULL,
@@ -57,11 +57,14 @@ typedef struct {
 } test_t;
 
 extern const char *test_atomic1(void);
+extern const char *test_cap1(void);
 extern const char *test_mips1(void);
 extern const char *test_fault1(void);
 extern const char *test_falloc1(void);
 extern const char *test_falloc2(void);
 extern const char *test_mapping1(void);
+extern const char *test_largepage1(void);
+extern const char *test_pagefault1(void);
 extern const char *test_purge1(void);
 extern const char *test_slab1(void);
 extern const char *test_slab2(void);
@@ -73,6 +76,8 @@ extern const char *test_print3(void);
 extern const char *test_print4(void);
 extern const char *test_print5(void);
 extern const char *test_thread1(void);
+extern const char *test_sched1(void);
+extern const char *test_timeout1(void);
 
 extern test_t tests[];
 
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <atomic.h>
+#include <arch.h>
+#include <arch/cycle.h>
+#include <bitops.h>
+#include <cpu.h>
+#include <interrupt.h>
+#include <proc/scheduler.h>
+#include <proc/thread.h>
+
+#define THREADS     4
+#define ITERATIONS  100000
+
+/** Number of run queue selections timed by each of the methods. */
+#define SELECTIONS  100000
+
+static atomic_size_t threads_finished;
+
+/*
+ * All yielders run wired to the same CPU, so their cycle counters
+ * are mutually comparable.
+ */
+static uint64_t start_cycle[THREADS];
+static uint64_t end_cycle[THREADS];
+
+static void yielder(void *arg)
+{
+	size_t idx = (size_t) arg;
+
+	start_cycle[idx] = get_cycle();
+
+	/*
+	 * Each voluntary preemption lowers the priority of the thread by one
+	 * level, so the yielders soon end up in the lowest-priority run queue
+	 * and every scheduler() invocation has to skip all the empty ones.
+	 */
+	for (size_t i = 0; i < ITERATIONS; i++)
+		scheduler();
+
+	end_cycle[idx] = get_cycle();
+	atomic_inc(&threads_finished);
+}
+
+/** Select a run queue by locking every queue in turn.
+ *
+ * This is how the scheduler used to look for the highest-priority
+ * non-empty run queue. It serves as the baseline.
+ */
+static int select_linear(cpu_t *cpu)
+{
+	for (int i = 0; i < RQ_COUNT; i++) {
+		irq_spinlock_lock(&cpu->rq[i].lock, false);
+		size_t n = cpu->rq[i].n;
+		irq_spinlock_unlock(&cpu->rq[i].lock, false);
+
+		if (n > 0)
+			return i;
+	}
+
+	return RQ_COUNT - 1;
+}
+
+/** Select a run queue using the bitmap of non-empty queues. */
+static int select_bitmap(cpu_t *cpu)
+{
+	uint32_t bitmap = atomic_load_explicit(&cpu->rq_bitmap,
+	    memory_order_relaxed);
+	int i = bitmap ? (int) fnzb32(bitmap & -bitmap) : RQ_COUNT - 1;
+
+	irq_spinlock_lock(&cpu->rq[i].lock, false);
+	size_t n = cpu->rq[i].n;
+	irq_spinlock_unlock(&cpu->rq[i].lock, false);
+
+	return n > 0 ? i : RQ_COUNT - 1;
+}
+
+/** Time run queue selection with interrupts disabled.
+ *
+ * With no ready threads, the linear scan has to lock all the queues,
+ * just as it did when the yielders sat in the lowest-priority queue.
+ */
+static uint64_t time_selection(int (*select)(cpu_t *))
+{
+	volatile int sink = 0;
+
+	ipl_t ipl = interrupts_disable();
+	uint64_t start = get_cycle();
+	for (size_t i = 0; i < SELECTIONS; i++)
+		sink += select(CPU);
+	uint64_t end = get_cycle();
+	interrupts_restore(ipl);
+
+	(void) sink;
+	return (end - start) / SELECTIONS;
+}
+
+const char *test_sched1(void)
+{
+	size_t total = 0;
+
+	atomic_store(&threads_finished, 0);
+
+	/* Whatever CPU we run on now, let all the yielders share it. */
+	cpu_t *cpu = CPU;
+
+	for (size_t i = 0; i < THREADS; i++) {
+		thread_t *thread = thread_create(yielder, (void *) i, TASK,
+		    THREAD_FLAG_NONE, "yielder");
+		if (!thread) {
+			TPRINTF("Could not create thread %zu\n", i);
+			break;
+		}
+
+		thread_wire(thread, cpu);
+		thread_ready(thread);
+		total++;
+	}
+
+	if (total == 0)
+		return "Unable to create any thread";
+
+	while (atomic_load(&threads_finished) < total)
+		thread_usleep(100000);
+
+	uint64_t first = start_cycle[0];
+	uint64_t last = end_cycle[0];
+	for (size_t i = 1; i < total; i++) {
+		if (start_cycle[i] < first)
+			first = start_cycle[i];
+		if (end_cycle[i] > last)
+			last = end_cycle[i];
+	}
+
+	uint64_t switches = (uint64_t) total * ITERATIONS;
+	uint64_t cycles = last - first;
+
+	TPRINTF("cpu%u: %" PRIu64 " scheduler() calls in %" PRIu64 " cycles, "
+	    "%" PRIu64 " cycles per call\n", cpu->id, switches, cycles,
+	    cycles / switches);
+
+	uint64_t linear = time_selection(select_linear);
+	uint64_t bitmap = time_selection(select_bitmap);
+
+	TPRINTF("Run queue selection: %" PRIu64 " cycles by linear scan, "
+	    "%" PRIu64 " cycles by bitmap\n", linear, bitmap);
+
+	return NULL;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <atomic.h>
+#include <arch.h>
+#include <arch/cycle.h>
+#include <cpu.h>
+#include <stdlib.h>
+#include <proc/thread.h>
+#include <time/timeout.h>
+
+#define TIMEOUTS  100000
+
+/** Seconds to wait for the short timeouts to fire. */
+#define WAIT_LIMIT  10
+
+static atomic_size_t fired;
+static atomic_size_t early;
+
+static void handler(void *arg)
+{
+	timeout_t *timeout = (timeout_t *) arg;
+
+	if ((timeout->cpu != CPU) ||
+	    (CPU->current_clock_tick <= timeout->deadline))
+		atomic_inc(&early);
+
+	atomic_inc(&fired);
+}
+
+static uint32_t next_random(uint32_t *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+const char *test_timeout1(void)
+{
+	timeout_t *timeouts = malloc(TIMEOUTS * sizeof(timeout_t));
+	if (!timeouts)
+		return "Unable to allocate timeouts";
+
+	atomic_store(&fired, 0);
+	atomic_store(&early, 0);
+
+	/*
+	 * Every other timeout is due within 1.5 seconds and is let to fire,
+	 * the rest lands in the upper levels of the wheel and is cancelled.
+	 */
+	uint32_t seed = 42;
+	uint64_t start = get_cycle();
+
+	for (size_t i = 0; i < TIMEOUTS; i++) {
+		uint64_t usec;
+		if (i % 2)
+			usec = next_random(&seed) % 1500000;
+		else
+			usec = 60000000 + next_random(&seed) % 3540000000U;
+
+		timeout_initialize(&timeouts[i]);
+		timeout_register(&timeouts[i], usec, handler, &timeouts[i]);
+	}
+
+	uint64_t registered = get_cycle();
+
+	size_t cancelled = 0;
+	for (size_t i = 0; i < TIMEOUTS; i += 2) {
+		if (timeout_unregister(&timeouts[i]))
+			cancelled++;
+	}
+
+	uint64_t unregistered = get_cycle();
+
+	TPRINTF("Registered %d timeouts in %" PRIu64 " cycles, "
+	    "%" PRIu64 " cycles per timeout\n", TIMEOUTS, registered - start,
+	    (registered - start) / TIMEOUTS);
+	TPRINTF("Cancelled %zu timeouts in %" PRIu64 " cycles, "
+	    "%" PRIu64 " cycles per timeout\n", cancelled,
+	    unregistered - registered,
+	    (unregistered - registered) / (TIMEOUTS / 2));
+
+	for (unsigned int sec = 0; sec < WAIT_LIMIT; sec++) {
+		if (atomic_load(&fired) >= TIMEOUTS / 2)
+			break;
+
+		thread_sleep(1);
+	}
+
+	/* Make sure no handler can run once the array is freed. */
+	size_t pending = 0;
+	for (size_t i = 1; i < TIMEOUTS; i += 2) {
+		if (timeout_unregister(&timeouts[i]))
+			pending++;
+	}
+
+	free(timeouts);
+
+	TPRINTF("Fired %zu timeouts, %zu of them early, %zu never fired\n",
+	    atomic_load(&fired), atomic_load(&early), pending);
+
+	if (cancelled != TIMEOUTS / 2)
+		return "Failed to cancel a pending timeout";
+
+	if (pending != 0)
+		return "Timeouts did not fire in time";
+
+	if (atomic_load(&early) != 0)
+		return "Timeouts fired before their deadline";
+
+	if (atomic_load(&fired) != TIMEOUTS / 2)
+		return "Cancelled timeouts fired";
+
+	return NULL;
+}
@@ -50,14 +50,17 @@
 
 #define HEADER_TABLE     "Filesystem           Size           Used      Available Used%% Mounted on"
 #define HEADER_TABLE_BLK "Filesystem  Blk. Size     Total        Used   Available Used%% Mounted on"
+#define HEADER_TABLE_CACHE "Filesystem          Dirty    Flushes     Blocks  Avg. [us]  Max. [us] Mounted on"
 
 #define PERCENTAGE(x, tot) (tot ? (100ULL * (x) / (tot)) : 0)
 
 static bool display_blocks;
+static bool display_cache;
 
 static errno_t size_to_human_readable(uint64_t, size_t, char **);
 static void print_header(void);
 static errno_t print_statfs(vfs_statfs_t *, char *, char *);
+static errno_t print_cache_stats(vfs_statfs_t *, char *, char *);
 static void print_usage(void);
 
 int main(int argc, char *argv[])
@@ -67,9 +70,10 @@ int main(int argc, char *argv[])
 	errno_t rc;
 
 	display_blocks = false;
+	display_cache = false;
 
 	/* Parse command-line options */
-	while ((optres = getopt(argc, argv, "ubh")) != -1) {
+	while ((optres = getopt(argc, argv, "ubch")) != -1) {
 		switch (optres) {
 		case 'h':
 			print_usage();
@@ -79,6 +83,10 @@ int main(int argc, char *argv[])
 			display_blocks = true;
 			break;
 
+		case 'c':
+			display_cache = true;
+			break;
+
 		case '?':
 			fprintf(stderr, "Unrecognized option: -%c\n", optopt);
 			errflg++;
@@ -108,7 +116,13 @@ int main(int argc, char *argv[])
 	print_header();
 	list_foreach(mtab_list, link, mtab_ent_t, mtab_ent) {
 		if (vfs_statfs_path(mtab_ent->mp, &st) == 0) {
-			rc = print_statfs(&st, mtab_ent->fs_name, mtab_ent->mp);
+			if (display_cache) {
+				rc = print_cache_stats(&st, mtab_ent->fs_name,
+				    mtab_ent->mp);
+			} else {
+				rc = print_statfs(&st, mtab_ent->fs_name,
+				    mtab_ent->mp);
+			}
 			if (rc != EOK)
 				return 1;
 		} else {
@@ -132,7 +146,9 @@ static errno_t size_to_human_readable(uint64_t nblocks, size_t block_size, char
 
 static void print_header(void)
 {
-	if (!display_blocks)
+	if (display_cache)
+		printf(HEADER_TABLE_CACHE);
+	else if (!display_blocks)
 		printf(HEADER_TABLE);
 	else
 		printf(HEADER_TABLE_BLK);
@@ -189,12 +205,40 @@ error:
 	return ENOMEM;
 }
 
+static errno_t print_cache_stats(vfs_statfs_t *st, char *name,
+    char *mountpoint)
+{
+	vfs_cache_stats_t *cs = &st->f_cache;
+	uint64_t avg = cs->flushes ? cs->flush_time / cs->flushes : 0;
+	char *str;
+	errno_t rc;
+
+	printf("%10s", name);
+
+	/* Amount of data waiting to be written back */
+	rc = size_to_human_readable(cs->dirty_bytes, 1, &str);
+	if (rc != EOK) {
+		printf("\nError: Out of memory.\n");
+		return ENOMEM;
+	}
+	printf(" %14s", str);
+	free(str);
+
+	/* Write-back transfers / Blocks written / Avg. time / Max. time */
+	printf(" %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %s\n",
+	    cs->flushes, cs->flushed_blocks, avg, cs->flush_time_max,
+	    mountpoint);
+
+	return EOK;
+}
+
 static void print_usage(void)
 {
 	printf("Syntax: %s [<options>] \n", NAME);
 	printf("Options:\n");
 	printf("  -h Print help\n");
 	printf("  -b Print exact block sizes and numbers\n");
+	printf("  -c Print block cache write-back statistics\n");
 }
 
 /** @}
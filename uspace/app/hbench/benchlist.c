@@ -38,13 +38,22 @@
 #include "hbench.h"
 
 benchmark_t *benchmarks[] = {
+	&benchmark_data_read,
+	&benchmark_data_write,
 	&benchmark_dir_read,
 	&benchmark_fibril_mutex,
+	&benchmark_fibril_mutex_mt,
+	&benchmark_fibril_sleep,
 	&benchmark_file_read,
 	&benchmark_malloc1,
 	&benchmark_malloc2,
+	&benchmark_malloc1_mt,
+	&benchmark_malloc2_mt,
 	&benchmark_ns_ping,
-	&benchmark_ping_pong
+	&benchmark_path_lookup,
+	&benchmark_ping_pong,
+	&benchmark_ping_pong_pipelined,
+	&benchmark_ring_write
 };
 
 size_t benchmark_count = sizeof(benchmarks) / sizeof(benchmarks[0]);
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <str.h>
+#include <str_error.h>
+#include <stdio.h>
+#include <vfs/vfs.h>
+#include "../hbench.h"
+
+/** Directory under which the benchmark creates its directory chain. */
+#define LOOKUP_ROOT "/tmp/hbench_lookup"
+
+/** Number of nested directories below LOOKUP_ROOT. */
+#define LOOKUP_DEPTH 8
+
+static char lookup_path[256];
+
+/** Build path of the directory at the given nesting level. */
+static void lookup_path_build(int depth)
+{
+	str_cpy(lookup_path, sizeof(lookup_path), LOOKUP_ROOT);
+	for (int i = 0; i < depth; i++) {
+		char component[8];
+		snprintf(component, sizeof(component), "/d%d", i);
+		str_append(lookup_path, sizeof(lookup_path), component);
+	}
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	if (bench_env_param_get(env, "path", NULL) != NULL)
+		return true;
+
+	for (int depth = 0; depth <= LOOKUP_DEPTH; depth++) {
+		lookup_path_build(depth);
+		errno_t rc = vfs_link_path(lookup_path, KIND_DIRECTORY, NULL);
+		if (rc != EOK && rc != EEXIST) {
+			return bench_run_fail(run, "failed to create %s: %s",
+			    lookup_path, str_error(rc));
+		}
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	if (bench_env_param_get(env, "path", NULL) != NULL)
+		return true;
+
+	for (int depth = LOOKUP_DEPTH; depth >= 0; depth--) {
+		lookup_path_build(depth);
+		errno_t rc = vfs_unlink_path(lookup_path);
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed to remove %s: %s",
+			    lookup_path, str_error(rc));
+		}
+	}
+
+	return true;
+}
+
+/** Execute path lookup benchmark.
+ *
+ * Each iteration resolves a deep path and stats the result, so the benchmark
+ * measures mostly the VFS path lookup.
+ */
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	lookup_path_build(LOOKUP_DEPTH);
+	const char *path = bench_env_param_get(env, "path", lookup_path);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		vfs_stat_t st;
+		errno_t rc = vfs_stat_path(path, &st);
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed to stat %s: %s",
+			    path, str_error(rc));
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_path_lookup = {
+	.name = "path_lookup",
+	.desc = "Stat a deeply nested path (use 'path' param to alter the default).",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
@@ -99,6 +99,11 @@ typedef struct {
 
 extern void bench_run_init(bench_run_t *, char *, size_t);
 extern bool bench_run_fail(bench_run_t *, const char *, ...);
+extern bool bench_param_size(bench_env_t *, bench_run_t *, const char *,
+    const char *, size_t *);
+extern bool bench_setup_runners(bench_env_t *, bench_run_t *);
+extern bool bench_run_workers(bench_run_t *, size_t, size_t,
+    errno_t (*)(void *), void *, size_t);
 
 /*
  * We keep the following two functions inline to ensure that we start
@@ -131,13 +136,22 @@ extern benchmark_t *benchmarks[];
 extern size_t benchmark_count;
 
 /* Put your benchmark descriptors here (and also to benchlist.c). */
+extern benchmark_t benchmark_data_read;
+extern benchmark_t benchmark_data_write;
 extern benchmark_t benchmark_dir_read;
 extern benchmark_t benchmark_fibril_mutex;
+extern benchmark_t benchmark_fibril_mutex_mt;
+extern benchmark_t benchmark_fibril_sleep;
 extern benchmark_t benchmark_file_read;
 extern benchmark_t benchmark_malloc1;
 extern benchmark_t benchmark_malloc2;
+extern benchmark_t benchmark_malloc1_mt;
+extern benchmark_t benchmark_malloc2_mt;
 extern benchmark_t benchmark_ns_ping;
+extern benchmark_t benchmark_path_lookup;
 extern benchmark_t benchmark_ping_pong;
+extern benchmark_t benchmark_ping_pong_pipelined;
+extern benchmark_t benchmark_ring_write;
 
 #endif
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ipc_test.h>
+#include <async.h>
+#include <errno.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Transfers of at least four pages are copied directly between the client
+ * and the server by the kernel, smaller ones go through a kernel buffer.
+ * Use the 'size' parameter to compare the two.
+ */
+#define DEFAULT_SIZE  "65536"
+
+/*
+ * Records in a ring are limited to half of its capacity, make the ring
+ * large enough for four of them.
+ */
+#define RING_RECORDS  4
+
+static ipc_test_t *test = NULL;
+static async_ring_t *ring = NULL;
+static void *buf = NULL;
+static size_t buf_size;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *size_str = bench_env_param_get(env, "size", DEFAULT_SIZE);
+
+	errno_t rc = str_size_t(size_str, NULL, 10, true, &buf_size);
+	if ((rc != EOK) || (buf_size == 0) || (buf_size > DATA_XFER_LOAN_LIMIT)) {
+		return bench_run_fail(run, "invalid transfer size '%s'",
+		    size_str);
+	}
+
+	buf = calloc(1, buf_size);
+	if (buf == NULL) {
+		return bench_run_fail(run, "failed to allocate %zuB buffer",
+		    buf_size);
+	}
+
+	rc = ipc_test_create(&test);
+	if (rc != EOK) {
+		free(buf);
+		buf = NULL;
+		return bench_run_fail(run,
+		    "failed contacting IPC test server (have you run /srv/test/ipc-test?): %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	ipc_test_destroy(test);
+	free(buf);
+	buf = NULL;
+	return true;
+}
+
+static bool setup_ring(bench_env_t *env, bench_run_t *run)
+{
+	if (!setup(env, run))
+		return false;
+
+	errno_t rc = ipc_test_ring_create(test,
+	    RING_RECORDS * (buf_size + sizeof(size_t)), &ring);
+	if (rc != EOK) {
+		teardown(env, run);
+		return bench_run_fail(run, "failed creating ring: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool teardown_ring(bench_env_t *env, bench_run_t *run)
+{
+	async_ring_destroy(ring);
+	ring = NULL;
+	return teardown(env, run);
+}
+
+static bool runner_write(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		errno_t rc = ipc_test_write(test, buf, buf_size);
+
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed writing data: %s (%d)",
+			    str_error(rc), rc);
+		}
+	}
+
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool runner_read(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		errno_t rc = ipc_test_read(test, buf, buf_size);
+
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed reading data: %s (%d)",
+			    str_error(rc), rc);
+		}
+	}
+
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool runner_ring_write(bench_env_t *env, bench_run_t *run,
+    uint64_t niter)
+{
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		errno_t rc = async_ring_write(ring, buf, buf_size);
+
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed writing to ring: %s (%d)",
+			    str_error(rc), rc);
+		}
+	}
+
+	/* Count the time until the server has seen all the data. */
+	errno_t rc = async_ring_drain(ring);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed draining ring: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_data_write = {
+	.name = "data_write",
+	.desc = "IPC data write bandwidth (use 'size' param to alter the transfer size).",
+	.entry = &runner_write,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_data_read = {
+	.name = "data_read",
+	.desc = "IPC data read bandwidth (use 'size' param to alter the transfer size).",
+	.entry = &runner_read,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_ring_write = {
+	.name = "ring_write",
+	.desc = "Shared memory ring bandwidth (use 'size' param to alter the record size).",
+	.entry = &runner_ring_write,
+	.setup = &setup_ring,
+	.teardown = &teardown_ring
+};
+
+/** @}
+ */
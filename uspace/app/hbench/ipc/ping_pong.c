@@ -34,6 +34,7 @@
 #include <ipc_test.h>
 #include <async.h>
 #include <errno.h>
+#include <str.h>
 #include <str_error.h>
 #include "../hbench.h"
 
@@ -75,6 +76,35 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
 	return true;
 }
 
+static bool runner_pipelined(bench_env_t *env, bench_run_t *run,
+    uint64_t niter)
+{
+	const char *str = bench_env_param_get(env, "depth", "16");
+	size_t depth;
+	errno_t rc = str_size_t(str, NULL, 10, true, &depth);
+	if ((rc != EOK) || (depth == 0) || (depth > IPC_MAX_ASYNC_CALLS)) {
+		return bench_run_fail(run, "invalid value of 'depth': %s", str);
+	}
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count += depth) {
+		size_t batch = depth;
+		if (niter - count < batch)
+			batch = niter - count;
+
+		rc = ipc_test_ping_pipelined(test, batch);
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed sending ping message: %s (%d)",
+			    str_error(rc), rc);
+		}
+	}
+
+	bench_run_stop(run);
+
+	return true;
+}
+
 benchmark_t benchmark_ping_pong = {
 	.name = "ping_pong",
 	.desc = "IPC ping-pong benchmark",
@@ -83,5 +113,14 @@ benchmark_t benchmark_ping_pong = {
 	.teardown = &teardown
 };
 
+benchmark_t benchmark_ping_pong_pipelined = {
+	.name = "ping_pong_pipelined",
+	.desc = "IPC ping-pong benchmark with several pings in flight "
+	    "(use 'depth' param to alter the default of 16).",
+	.entry = &runner_pipelined,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
 /** @}
  */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/*
+ * Multi-threaded variants of malloc1 and malloc2. Several fibrils running
+ * on several runner threads allocate and free memory at the same time, so
+ * that the scaling of the allocator with the number of threads can be
+ * measured.
+ */
+
+static errno_t malloc1_worker(void *arg)
+{
+	uint64_t niter = *(uint64_t *) arg;
+
+	for (uint64_t i = 0; i < niter; i++) {
+		void *p = malloc(1);
+		if (p == NULL)
+			return ENOMEM;
+		free(p);
+	}
+
+	return EOK;
+}
+
+static errno_t malloc2_worker(void *arg)
+{
+	uint64_t niter = *(uint64_t *) arg;
+	uint64_t count;
+	errno_t rc = EOK;
+
+	void **p = malloc(niter * sizeof(void *));
+	if (p == NULL)
+		return ENOMEM;
+
+	for (count = 0; count < niter; count++) {
+		p[count] = malloc(1);
+		if (p[count] == NULL) {
+			rc = ENOMEM;
+			break;
+		}
+	}
+
+	for (uint64_t i = 0; i < count; i++)
+		free(p[i]);
+
+	free(p);
+	return rc;
+}
+
+static bool runner_malloc1(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	size_t fibrils;
+	if (!bench_param_size(env, run, "fibrils", "4", &fibrils))
+		return false;
+
+	return bench_run_workers(run, fibrils, 0, malloc1_worker, &size, 0);
+}
+
+static bool runner_malloc2(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	size_t fibrils;
+	if (!bench_param_size(env, run, "fibrils", "4", &fibrils))
+		return false;
+
+	return bench_run_workers(run, fibrils, 0, malloc2_worker, &size, 0);
+}
+
+benchmark_t benchmark_malloc1_mt = {
+	.name = "malloc1_mt",
+	.desc = "User-space memory allocator benchmark, repeatedly allocate one block "
+	    "from several runner threads (use 'runners' and 'fibrils' params to alter the defaults).",
+	.entry = &runner_malloc1,
+	.setup = &bench_setup_runners,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_malloc2_mt = {
+	.name = "malloc2_mt",
+	.desc = "User-space memory allocator benchmark, allocate many small blocks "
+	    "from several runner threads (use 'runners' and 'fibrils' params to alter the defaults).",
+	.entry = &runner_malloc2,
+	.setup = &bench_setup_runners,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -31,7 +31,9 @@
  */
 
 #include <fibril_synch.h>
+#include <inttypes.h>
 #include <stdatomic.h>
+#include <stdlib.h>
 #include "../hbench.h"
 
 /*
@@ -97,5 +99,99 @@ benchmark_t benchmark_fibril_mutex = {
 	.teardown = NULL
 };
 
+/*
+ * Many fibrils running on several runner threads lock and unlock mutexes
+ * picked pseudo-randomly from a larger set, so that most operations do not
+ * contend with each other.
+ */
+
+typedef struct {
+	fibril_mutex_t mutex;
+	uint64_t counter;
+} mt_mutex_t;
+
+typedef struct {
+	mt_mutex_t *mutexes;
+	size_t mutex_count;
+	uint64_t niter;
+} mt_shared_t;
+
+typedef struct {
+	mt_shared_t *shared;
+	unsigned int seed;
+} mt_worker_t;
+
+static errno_t mt_worker(void *arg)
+{
+	mt_worker_t *worker = arg;
+	mt_shared_t *shared = worker->shared;
+	unsigned int seed = worker->seed;
+
+	for (uint64_t i = 0; i < shared->niter; i++) {
+		seed = seed * 1103515245 + 12345;
+		mt_mutex_t *m = &shared->mutexes[(seed >> 16) %
+		    shared->mutex_count];
+
+		fibril_mutex_lock(&m->mutex);
+		m->counter++;
+		fibril_mutex_unlock(&m->mutex);
+	}
+
+	return EOK;
+}
+
+static bool runner_mt(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	size_t fibrils;
+	size_t mutex_count;
+	if (!bench_param_size(env, run, "fibrils", "16", &fibrils) ||
+	    !bench_param_size(env, run, "mutexes", "256", &mutex_count))
+		return false;
+
+	mt_shared_t shared;
+	shared.mutexes = calloc(mutex_count, sizeof(mt_mutex_t));
+	mt_worker_t *workers = calloc(fibrils, sizeof(mt_worker_t));
+	if ((shared.mutexes == NULL) || (workers == NULL)) {
+		free(shared.mutexes);
+		free(workers);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	for (size_t i = 0; i < mutex_count; i++)
+		fibril_mutex_initialize(&shared.mutexes[i].mutex);
+	shared.mutex_count = mutex_count;
+	shared.niter = size;
+
+	for (size_t i = 0; i < fibrils; i++) {
+		workers[i].shared = &shared;
+		workers[i].seed = i;
+	}
+
+	bool ret = bench_run_workers(run, fibrils, 0, mt_worker, workers,
+	    sizeof(mt_worker_t));
+
+	uint64_t total = 0;
+	for (size_t i = 0; i < mutex_count; i++)
+		total += shared.mutexes[i].counter;
+
+	if (ret && (total != size * fibrils)) {
+		ret = bench_run_fail(run, "lost updates: %" PRIu64 " != %" PRIu64,
+		    total, size * fibrils);
+	}
+
+	free(shared.mutexes);
+	free(workers);
+	return ret;
+}
+
+benchmark_t benchmark_fibril_mutex_mt = {
+	.name = "fibril_mutex_mt",
+	.desc = "Mutex lock/unlock operations on many mutexes from several runner threads "
+	    "(use 'runners', 'fibrils' and 'mutexes' params to alter the defaults).",
+	.entry = &runner_mt,
+	.setup = &bench_setup_runners,
+	.teardown = NULL
+};
+
 /** @}
  */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/*
+ * Many fibrils sleeping at the same time with timeouts expiring in random
+ * order. Measures the cost of managing the fibril timeouts.
+ */
+
+#define DEFAULT_FIBRILS  "10000"
+#define SLEEPER_STACK_SIZE  16384
+/* Sleeps are between one microsecond and one millisecond long. */
+#define SLEEP_MAX_USEC  1000
+
+typedef struct {
+	uint64_t niter;
+	unsigned int seed;
+} sleeper_t;
+
+static errno_t sleeper_fn(void *arg)
+{
+	sleeper_t *sleeper = arg;
+	unsigned int seed = sleeper->seed;
+
+	for (uint64_t i = 0; i < sleeper->niter; i++) {
+		seed = seed * 1103515245 + 12345;
+		fibril_usleep(1 + (seed >> 16) % SLEEP_MAX_USEC);
+	}
+
+	return EOK;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	size_t count;
+	if (!bench_param_size(env, run, "fibrils", DEFAULT_FIBRILS, &count))
+		return false;
+
+	sleeper_t *sleepers = calloc(count, sizeof(sleeper_t));
+	if (sleepers == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	for (size_t i = 0; i < count; i++) {
+		sleepers[i].niter = size;
+		sleepers[i].seed = i;
+	}
+
+	bool ret = bench_run_workers(run, count, SLEEPER_STACK_SIZE, sleeper_fn,
+	    sleepers, sizeof(sleeper_t));
+
+	free(sleepers);
+	return ret;
+}
+
+benchmark_t benchmark_fibril_sleep = {
+	.name = "fibril_sleep",
+	.desc = "Many fibrils sleeping at the same time (use 'fibrils' param to alter the default).",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
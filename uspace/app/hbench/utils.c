@@ -33,10 +33,23 @@
  * @file
  */
 
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
 #include "hbench.h"
 
+/** Fibril started by bench_run_workers(). */
+typedef struct {
+	errno_t (*fn)(void *);
+	void *arg;
+	errno_t rc;
+	fibril_semaphore_t *done;
+} bench_worker_t;
+
 /** Initialize bench run structure.
  *
  * @param run Structure to intialize.
@@ -75,5 +88,128 @@ bool bench_run_fail(bench_run_t *run, const char *fmt, ...)
 	return false;
 }
 
+/** Read a positive size parameter of the benchmark.
+ *
+ * @param env Benchmark environment.
+ * @param run Current benchmark run (for error reporting).
+ * @param name Parameter name.
+ * @param def Default value used when the parameter is not set.
+ * @param value Where to store the parsed value.
+ * @return Whether the parameter has a valid value.
+ */
+bool bench_param_size(bench_env_t *env, bench_run_t *run, const char *name,
+    const char *def, size_t *value)
+{
+	const char *str = bench_env_param_get(env, name, def);
+	errno_t rc = str_size_t(str, NULL, 10, true, value);
+	if ((rc != EOK) || (*value == 0))
+		return bench_run_fail(run, "invalid value of '%s': %s", name, str);
+
+	return true;
+}
+
+/** Setup callback spawning the runner threads of a multi-threaded benchmark.
+ *
+ * The number of runners is taken from the 'runners' parameter (4 by
+ * default).
+ */
+bool bench_setup_runners(bench_env_t *env, bench_run_t *run)
+{
+	size_t runners;
+	if (!bench_param_size(env, run, "runners", "4", &runners))
+		return false;
+
+	if (fibril_set_runners(runners) < (int) runners)
+		return bench_run_fail(run, "failed spawning %zu runners", runners);
+
+	return true;
+}
+
+static errno_t bench_worker_fn(void *arg)
+{
+	bench_worker_t *worker = arg;
+
+	worker->rc = worker->fn(worker->arg);
+	fibril_semaphore_up(worker->done);
+	return EOK;
+}
+
+/** Run a function in several fibrils at once and wait for all of them.
+ *
+ * The fibrils are created before the measurement starts, so only the time
+ * between starting the first of them and the end of the last one is
+ * measured.
+ *
+ * @param run Current benchmark run.
+ * @param count Number of fibrils.
+ * @param stack_size Stack size of the fibrils, 0 for the default one.
+ * @param fn Function run by the fibrils. A failure of any of them fails
+ *        the run.
+ * @param args Array of arguments, one for each fibril.
+ * @param arg_size Size of one argument, 0 to pass @a args to all fibrils.
+ * @return Whether all fibrils ran and succeeded.
+ */
+bool bench_run_workers(bench_run_t *run, size_t count, size_t stack_size,
+    errno_t (*fn)(void *), void *args, size_t arg_size)
+{
+	bench_worker_t *workers = calloc(count, sizeof(bench_worker_t));
+	fid_t *fids = calloc(count, sizeof(fid_t));
+	if ((workers == NULL) || (fids == NULL)) {
+		free(workers);
+		free(fids);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	fibril_semaphore_t done;
+	fibril_semaphore_initialize(&done, 0);
+
+	for (size_t i = 0; i < count; i++) {
+		workers[i].fn = fn;
+		workers[i].arg = (char *) args + i * arg_size;
+		workers[i].done = &done;
+
+		if (stack_size != 0) {
+			fids[i] = fibril_create_generic(bench_worker_fn,
+			    &workers[i], stack_size);
+		} else {
+			fids[i] = fibril_create(bench_worker_fn, &workers[i]);
+		}
+
+		if (fids[i] == 0) {
+			for (size_t j = 0; j < i; j++)
+				fibril_destroy(fids[j]);
+			free(workers);
+			free(fids);
+			return bench_run_fail(run, "failed creating fibril %zu", i);
+		}
+	}
+
+	bench_run_start(run);
+	for (size_t i = 0; i < count; i++) {
+		fibril_detach(fids[i]);
+		fibril_start(fids[i]);
+	}
+
+	for (size_t i = 0; i < count; i++)
+		fibril_semaphore_down(&done);
+	bench_run_stop(run);
+
+	errno_t rc = EOK;
+	for (size_t i = 0; i < count; i++) {
+		if (workers[i].rc != EOK) {
+			rc = workers[i].rc;
+			break;
+		}
+	}
+
+	free(workers);
+	free(fids);
+
+	if (rc != EOK)
+		return bench_run_fail(run, "worker failed: %s", str_error(rc));
+
+	return true;
+}
+
 /** @}
  */
@@ -59,6 +59,7 @@ typedef enum {
 	LIST_THREADS,
 	LIST_IPCCS,
 	LIST_CPUS,
+	LIST_SLABS,
 	PRINT_LOAD,
 	PRINT_UPTIME,
 	PRINT_ARCH
@@ -172,7 +173,9 @@ static void list_cpus(void)
 		return;
 	}
 
-	printf("[id] [MHz     ] [busy cycles] [idle cycles]\n");
+	printf("[id] [MHz     ] [busy cycles] [idle cycles] [steals   ] "
+	    "[failed   ] [migrations] [shootdowns] [IPIs sent ] "
+	    "[IPIs recv ]\n");
 
 	for (size_t i = 0; i < count; i++) {
 		printf("%-4u ", cpus[i].id);
@@ -183,9 +186,14 @@ static void list_cpus(void)
 			order_suffix(cpus[i].busy_cycles, &bcycles, &bsuffix);
 			order_suffix(cpus[i].idle_cycles, &icycles, &isuffix);
 
-			printf("%10" PRIu16 " %12" PRIu64 "%c %12" PRIu64 "%c\n",
+			printf("%10" PRIu16 " %12" PRIu64 "%c %12" PRIu64 "%c "
+			    "%11" PRIu64 " %11" PRIu64 " %12" PRIu64 " "
+			    "%12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
 			    cpus[i].frequency_mhz, bcycles, bsuffix,
-			    icycles, isuffix);
+			    icycles, isuffix, cpus[i].steals,
+			    cpus[i].steals_failed, cpus[i].migrations,
+			    cpus[i].tlb_shootdowns, cpus[i].tlb_ipis_sent,
+			    cpus[i].tlb_ipis_received);
 		} else
 			printf("inactive\n");
 	}
@@ -193,6 +201,30 @@ static void list_cpus(void)
 	free(cpus);
 }
 
+static void list_slabs(void)
+{
+	size_t count;
+	stats_slab_t *slabs = stats_get_slabs(&count);
+
+	if (slabs == NULL) {
+		fprintf(stderr, "%s: Unable to get slab statistics\n", NAME);
+		return;
+	}
+
+	printf("[cache name          ] [size  ] [slabs ] [cached] [alloc ] "
+	    "[magsz ] [depot accesses] [contention]\n");
+
+	for (size_t i = 0; i < count; i++) {
+		printf("%-22s %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %8" PRIu64
+		    " %8" PRIu64 " %16" PRIu64 " %12" PRIu64 "\n",
+		    slabs[i].name, slabs[i].size, slabs[i].slabs,
+		    slabs[i].cached, slabs[i].allocated, slabs[i].magazine_size,
+		    slabs[i].depot_accesses, slabs[i].depot_contention);
+	}
+
+	free(slabs);
+}
+
 static void print_load(void)
 {
 	size_t count;
@@ -367,7 +399,7 @@ static void print_arch(void)
 static void usage(const char *name)
 {
 	printf(
-	    "Usage: %s [-t task_id] [-i task_id] [-at] [-ai] [-c] [-l] [-u] [-d]\n"
+	    "Usage: %s [-t task_id] [-i task_id] [-at] [-ai] [-c] [-s] [-l] [-u] [-d]\n"
 	    "\n"
 	    "Options:\n"
 	    "\t-t task_id | --task=task_id\n"
@@ -385,6 +417,9 @@ static void usage(const char *name)
 	    "\t-c | --cpus\n"
 	    "\t\tList CPUs\n"
 	    "\n"
+	    "\t-s | --slabs\n"
+	    "\t\tList kernel slab caches\n"
+	    "\n"
 	    "\t-l | --load\n"
 	    "\t\tPrint system load\n"
 	    "\n"
@@ -468,6 +503,12 @@ int main(int argc, char *argv[])
 			continue;
 		}
 
+		/* Slab caches */
+		if ((off = arg_parse_short_long(argv[i], "-s", "--slabs")) != -1) {
+			output_toggle = LIST_SLABS;
+			continue;
+		}
+
 		/* Load */
 		if ((off = arg_parse_short_long(argv[i], "-l", "--load")) != -1) {
 			output_toggle = PRINT_LOAD;
@@ -500,6 +541,9 @@ int main(int argc, char *argv[])
 	case LIST_CPUS:
 		list_cpus();
 		break;
+	case LIST_SLABS:
+		list_slabs();
+		break;
 	case PRINT_LOAD:
 		print_load();
 		break;
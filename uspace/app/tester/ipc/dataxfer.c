@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <as.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <ipc_test.h>
+#include "../tester.h"
+
+/** Transfer size, large enough for the kernel to loan the buffer. */
+#define XFER_SIZE  DATA_XFER_LIMIT
+/** Time the service takes to answer delayed transfers. */
+#define XFER_DELAY  (100 * 1000)
+
+/** Transfer running in a separate fibril. */
+typedef struct {
+	ipc_test_t *test;
+	void *buf;
+	bool read;
+	errno_t rc;
+	bool done;
+	fibril_mutex_t lock;
+	fibril_condvar_t cv;
+} xfer_t;
+
+static void *buf_create(void)
+{
+	void *buf = as_area_create(AS_AREA_ANY, XFER_SIZE,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	return (buf == AS_MAP_FAILED) ? NULL : buf;
+}
+
+static void pattern_fill(uint8_t *buf, size_t size, uint8_t seed)
+{
+	for (size_t i = 0; i < size; i++)
+		buf[i] = (uint8_t) (i * 7 + seed);
+}
+
+static bool pattern_check(const uint8_t *buf, size_t size, uint8_t seed)
+{
+	for (size_t i = 0; i < size; i++) {
+		if (buf[i] != (uint8_t) (i * 7 + seed))
+			return false;
+	}
+
+	return true;
+}
+
+static errno_t xfer_fibril(void *arg)
+{
+	xfer_t *xfer = (xfer_t *) arg;
+	errno_t rc;
+
+	if (xfer->read) {
+		rc = ipc_test_read_partial(xfer->test, xfer->buf, XFER_SIZE, 0,
+		    XFER_DELAY);
+	} else {
+		rc = ipc_test_write_delayed(xfer->test, xfer->buf, XFER_SIZE,
+		    XFER_DELAY);
+	}
+
+	fibril_mutex_lock(&xfer->lock);
+	xfer->rc = rc;
+	xfer->done = true;
+	fibril_condvar_broadcast(&xfer->cv);
+	fibril_mutex_unlock(&xfer->lock);
+
+	return EOK;
+}
+
+/** Unmap the buffer of a transfer while the service is still handling it. */
+static const char *xfer_unmap(ipc_test_t *test, void *buf, bool read)
+{
+	xfer_t xfer = {
+		.test = test,
+		.buf = buf,
+		.read = read,
+		.done = false
+	};
+
+	fibril_mutex_initialize(&xfer.lock);
+	fibril_condvar_initialize(&xfer.cv);
+
+	fid_t fid = fibril_create(xfer_fibril, &xfer);
+	if (fid == 0)
+		return "Cannot create fibril.";
+	fibril_add_ready(fid);
+
+	fibril_usleep(XFER_DELAY / 4);
+	as_area_destroy(buf);
+
+	fibril_mutex_lock(&xfer.lock);
+	while (!xfer.done)
+		fibril_condvar_wait(&xfer.cv, &xfer.lock);
+	fibril_mutex_unlock(&xfer.lock);
+
+	if (xfer.rc != EOK)
+		return "Transfer with unmapped buffer failed.";
+
+	return NULL;
+}
+
+const char *test_dataxfer(void)
+{
+	ipc_test_t *test = NULL;
+	const char *err = NULL;
+	uint8_t *buf;
+	errno_t rc;
+
+	rc = ipc_test_create(&test);
+	if (rc != EOK)
+		return "Error contacting IPC test service.";
+
+	buf = buf_create();
+	if (buf == NULL) {
+		err = "Cannot create buffer.";
+		goto out;
+	}
+
+	TPRINTF("Writing and reading back %d bytes.\n", XFER_SIZE);
+	pattern_fill(buf, XFER_SIZE, 1);
+	rc = ipc_test_write(test, buf, XFER_SIZE);
+	if (rc != EOK) {
+		err = "Error writing data.";
+		goto out;
+	}
+
+	memset(buf, 0, XFER_SIZE);
+	rc = ipc_test_read(test, buf, XFER_SIZE);
+	if (rc != EOK) {
+		err = "Error reading data.";
+		goto out;
+	}
+
+	if (!pattern_check(buf, XFER_SIZE, 1)) {
+		err = "Data read back differ from data written.";
+		goto out;
+	}
+
+	TPRINTF("Reading a partial answer.\n");
+	size_t part = XFER_SIZE / 2 + 100;
+	memset(buf, 0xee, XFER_SIZE);
+	rc = ipc_test_read_partial(test, buf, XFER_SIZE, part, 0);
+	if (rc != EOK) {
+		err = "Error reading partial data.";
+		goto out;
+	}
+
+	if (!pattern_check(buf, part, 1)) {
+		err = "Partial answer carries wrong data.";
+		goto out;
+	}
+
+	for (size_t i = part; i < XFER_SIZE; i++) {
+		if (buf[i] != 0xee) {
+			err = "Partial answer overwrote data past its end.";
+			goto out;
+		}
+	}
+
+	TPRINTF("Unmapping the buffer during a write.\n");
+	pattern_fill(buf, XFER_SIZE, 2);
+	err = xfer_unmap(test, buf, false);
+	buf = NULL;
+	if (err != NULL)
+		goto out;
+
+	buf = buf_create();
+	if (buf == NULL) {
+		err = "Cannot create buffer.";
+		goto out;
+	}
+
+	rc = ipc_test_read(test, buf, XFER_SIZE);
+	if (rc != EOK) {
+		err = "Error reading data.";
+		goto out;
+	}
+
+	if (!pattern_check(buf, XFER_SIZE, 2)) {
+		err = "Data written from an unmapped buffer differ.";
+		goto out;
+	}
+
+	TPRINTF("Unmapping the buffer during a read.\n");
+	err = xfer_unmap(test, buf, true);
+	buf = NULL;
+
+out:
+	if (buf != NULL)
+		as_area_destroy(buf);
+	ipc_test_destroy(test);
+	return err;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <as.h>
+#include <errno.h>
+#include "../tester.h"
+
+#define AREA_PAGES  8
+
+/* Pages 2 to 5 are discarded, the rest is kept. */
+#define DISCARD_FIRST  2
+#define DISCARD_PAGES  4
+
+static bool discarded(size_t page)
+{
+	return (page >= DISCARD_FIRST) && (page < DISCARD_FIRST + DISCARD_PAGES);
+}
+
+const char *test_discard1(void)
+{
+	size_t size = AREA_PAGES * PAGE_SIZE;
+	uint8_t *area = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED)
+		return "Cannot allocate memory";
+
+	TPRINTF("Filling area...\n");
+	for (size_t i = 0; i < size; i++)
+		area[i] = (uint8_t) (i / PAGE_SIZE + 1);
+
+	TPRINTF("Discarding pages...\n");
+	errno_t rc = as_area_discard(area + DISCARD_FIRST * PAGE_SIZE,
+	    DISCARD_PAGES * PAGE_SIZE);
+	if (rc != EOK) {
+		as_area_destroy(area);
+		return "Failed to discard pages";
+	}
+
+	const char *err = NULL;
+
+	TPRINTF("Verifying mapping...\n");
+	for (size_t page = 0; page < AREA_PAGES; page++) {
+		rc = as_get_physical_mapping(area + page * PAGE_SIZE, NULL);
+		if ((rc == EOK) == discarded(page)) {
+			err = "Unexpected mapping state";
+			goto out;
+		}
+	}
+
+	TPRINTF("Verifying content...\n");
+	for (size_t i = 0; i < size; i++) {
+		uint8_t expected = discarded(i / PAGE_SIZE) ? 0 :
+		    (uint8_t) (i / PAGE_SIZE + 1);
+		if (area[i] != expected) {
+			err = "Unexpected content";
+			goto out;
+		}
+	}
+
+	TPRINTF("Discarding unaligned range...\n");
+	rc = as_area_discard(area + 1, PAGE_SIZE);
+	if (rc != EINVAL)
+		err = "Discarded unaligned range";
+
+out:
+	as_area_destroy(area);
+	return err;
+}
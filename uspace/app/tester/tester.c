@@ -68,12 +68,14 @@ test_t tests[] = {
 #include "float/float2.def"
 #include "vfs/vfs1.def"
 #include "ipc/sharein.def"
+#include "ipc/dataxfer.def"
 #include "ipc/starve.def"
 #include "loop/loop1.def"
 #include "mm/malloc1.def"
 #include "mm/malloc2.def"
 #include "mm/malloc3.def"
 #include "mm/mapping1.def"
+#include "mm/discard1.def"
 #include "mm/pager1.def"
 #include "hw/serial/serial1.def"
 #include "chardev/chardev1.def"
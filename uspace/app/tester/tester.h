@@ -99,12 +99,14 @@ extern const char *test_float2(void);
 extern const char *test_vfs1(void);
 extern const char *test_ping_pong(void);
 extern const char *test_sharein(void);
+extern const char *test_dataxfer(void);
 extern const char *test_starve_ipc(void);
 extern const char *test_loop1(void);
 extern const char *test_malloc1(void);
 extern const char *test_malloc2(void);
 extern const char *test_malloc3(void);
 extern const char *test_mapping1(void);
+extern const char *test_discard1(void);
 extern const char *test_pager1(void);
 extern const char *test_serial1(void);
 extern const char *test_devman1(void);
@@ -419,6 +419,9 @@ static inline void print_table(const table_t *table)
 			order_suffix(val, &val, &suffix);
 			printf("%*" PRIu64 "%c", width, val, suffix);
 			break;
+		case FIELD_UINT_HEX:
+			printf("%*" PRIx64, width, field->uint);
+			break;
 		case FIELD_PERCENT:
 			width -= 5; /* nnn.% */
 			if (width > 2) {
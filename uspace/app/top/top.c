@@ -68,6 +68,7 @@ static const column_t task_columns[] = {
 	{ "%virt",    'V',  7 },
 	{ "%user",    'U',  7 },
 	{ "%kern",    'K',  7 },
+	{ "affinity", 'a', 10 },
 	{ "name",     'd',  0 },
 };
 
@@ -80,6 +81,7 @@ enum {
 	TASK_COL_PERCENT_VIRTUAL,
 	TASK_COL_PERCENT_USER,
 	TASK_COL_PERCENT_KERNEL,
+	TASK_COL_AFFINITY,
 	TASK_COL_NAME,
 	TASK_NUM_COLUMNS,
 };
@@ -376,6 +378,7 @@ static int cmp_data(void *a, void *b, void *arg)
 		return 0;
 	case FIELD_UINT_SUFFIX_BIN: /* fallthrough */
 	case FIELD_UINT_SUFFIX_DEC: /* fallthrough */
+	case FIELD_UINT_HEX: /* fallthrough */
 	case FIELD_UINT:
 		if (fa->uint > fb->uint)
 			return 1 * sort_reverse;
@@ -437,6 +440,8 @@ static const char *fill_task_table(data_t *data)
 		field[TASK_COL_PERCENT_USER].fixed = perc->ucycles;
 		field[TASK_COL_PERCENT_KERNEL].type = FIELD_PERCENT;
 		field[TASK_COL_PERCENT_KERNEL].fixed = perc->kcycles;
+		field[TASK_COL_AFFINITY].type = FIELD_UINT_HEX;
+		field[TASK_COL_AFFINITY].uint = task->affinity;
 		field[TASK_COL_NAME].type = FIELD_STRING;
 		field[TASK_COL_NAME].string = task->name;
 		field += TASK_NUM_COLUMNS;
@@ -84,6 +84,7 @@ typedef enum {
 	FIELD_UINT,
 	FIELD_UINT_SUFFIX_BIN,
 	FIELD_UINT_SUFFIX_DEC,
+	FIELD_UINT_HEX,
 	FIELD_PERCENT,
 	FIELD_STRING
 } field_type_t;
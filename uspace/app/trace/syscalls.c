@@ -46,11 +46,13 @@ const sc_desc_t syscall_desc[] = {
 	[SYS_THREAD_GET_ID] = { "thread_get_id", 1, V_ERRNO },
 	[SYS_THREAD_USLEEP] = { "thread_usleep", 1, V_ERRNO },
 	[SYS_THREAD_UDELAY] = { "thread_udelay", 1, V_ERRNO },
+	[SYS_THREAD_SET_AFFINITY] = { "thread_set_affinity", 3, V_ERRNO },
 
 	[SYS_TASK_GET_ID] = { "task_get_id", 1, V_ERRNO },
 	[SYS_TASK_SET_NAME] = { "task_set_name", 2, V_ERRNO },
 	[SYS_TASK_KILL] = { "task_kill", 1, V_ERRNO },
 	[SYS_TASK_EXIT] = { "task_exit", 1, V_ERRNO },
+	[SYS_TASK_SET_AFFINITY] = { "task_set_affinity", 2, V_ERRNO },
 	[SYS_PROGRAM_SPAWN_LOADER] = { "program_spawn_loader", 2, V_ERRNO },
 
 	/* Synchronization related syscalls. */
@@ -66,6 +68,7 @@ const sc_desc_t syscall_desc[] = {
 	[SYS_AS_AREA_CHANGE_FLAGS] = { "as_area_change_flags", 2, V_ERRNO },
 	[SYS_AS_AREA_GET_INFO] = { "as_area_get_info", 2, V_ERRNO },
 	[SYS_AS_AREA_DESTROY] = { "as_area_destroy", 1, V_ERRNO },
+	[SYS_AS_AREA_DISCARD] = { "as_area_discard", 2, V_ERRNO },
 
 	/* Page mapping related syscalls. */
 	[SYS_PAGE_FIND_MAPPING] = { "page_find_mapping", 2, V_ERRNO },
@@ -81,6 +84,8 @@ const sc_desc_t syscall_desc[] = {
 	[SYS_IPC_POKE] = { "ipc_poke", 0, V_ERRNO },
 	[SYS_IPC_HANGUP] = { "ipc_hangup", 1, V_ERRNO },
 	[SYS_IPC_CONNECT_KBOX] = { "ipc_connect_kbox", 2, V_ERRNO },
+	[SYS_IPC_SUBMIT] = { "ipc_submit", 2, V_ERRNO },
+	[SYS_IPC_WAIT_MULTI] = { "ipc_wait_multi", 5, V_ERRNO },
 
 	/* Event notification syscalls. */
 	[SYS_IPC_EVENT_SUBSCRIBE] = { "ipc_event_subscribe", 2, V_ERRNO },
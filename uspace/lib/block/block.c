@@ -43,6 +43,7 @@
 #include <as.h>
 #include <assert.h>
 #include <bd.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <adt/list.h>
 #include <adt/hash_table.h>
@@ -54,24 +55,96 @@
 #include <str_error.h>
 #include <offset.h>
 #include <inttypes.h>
+#include <time.h>
 #include "block.h"
 
 #define MAX_WRITE_RETRIES 10
 
+/** Number of sequential streams tracked per device for readahead. */
+#define RA_STREAMS		4
+/** Initial readahead window (in blocks). */
+#define RA_WINDOW_MIN		4
+/** Maximum readahead window (in blocks). */
+#define RA_WINDOW_MAX		64
+/** Maximum size of a single readahead transfer (in bytes). */
+#define RA_MAX_BYTES		(64 * 1024)
+
+/** Default memory budget of a block cache (in bytes). */
+#define CACHE_BUDGET		(2 * 1024 * 1024)
+/** Minimum number of blocks a cache may hold regardless of its budget. */
+#define CACHE_MIN_BLOCKS	20
+/** Share of the cache given to the probationary queue (A1in). */
+#define CACHE_A1IN_RATIO	4
+/** Share of the cache remembered in the ghost queue (A1out). */
+#define CACHE_A1OUT_RATIO	2
+
+/** Maximum number of blocks written back by a single transfer. */
+#define WB_CLUSTER_MAX		64
+/** Maximum size of a single write-back transfer (in bytes). */
+#define WB_MAX_BYTES		(64 * 1024)
+/** Age after which a dirty block is written back (in microseconds). */
+#define WB_MAX_AGE		(5 * 1000 * 1000)
+/** Period of the write-back flusher (in microseconds). */
+#define WB_INTERVAL		(1000 * 1000)
+/** Number of dirty blocks which wakes up the write-back flusher. */
+#define WB_HI_WATERMARK(cache)	max((cache)->max_blocks / 8, 12)
+/** Number of dirty blocks the write-back flusher tries to get down to. */
+#define WB_LO_WATERMARK(cache)	max((cache)->max_blocks / 32, 4)
+
 /** Lock protecting the device connection list */
 static FIBRIL_MUTEX_INITIALIZE(dcl_lock);
 /** Device connection list head. */
 static LIST_INITIALIZE(dcl);
 
+/** Sequential access stream used for readahead. */
+typedef struct {
+	aoff64_t next;            /**< Next block expected in the stream. */
+	aoff64_t ra_end;          /**< First block not yet read ahead. */
+	unsigned window;          /**< Current readahead window. */
+	unsigned stamp;           /**< Time of the last access. */
+} ra_stream_t;
+
 typedef struct {
 	fibril_mutex_t lock;
 	size_t lblock_size;       /**< Logical block size. */
 	unsigned blocks_cluster;  /**< Physical blocks per block_t */
-	unsigned block_count;     /**< Total number of blocks. */
+	unsigned max_blocks;      /**< Number of blocks within the budget. */
 	unsigned blocks_cached;   /**< Number of cached blocks. */
 	hash_table_t block_hash;
-	list_t free_list;
 	enum cache_mode mode;
+
+	/*
+	 * Blocks are kept on two queues managed by the 2Q replacement policy.
+	 * Newly cached blocks enter the probationary queue (A1in) and only
+	 * blocks which are referenced again after being evicted from it, as
+	 * remembered by the ghost queue (A1out), or which hold metadata make
+	 * it to the main queue (Am). A1in is a FIFO, so its blocks stay in
+	 * place, in use or not, until they are evicted or promoted. Am is an
+	 * LRU of the unused hot blocks.
+	 */
+	list_t a1in_list;         /**< Probationary blocks, oldest first. */
+	list_t am_list;           /**< Unused hot blocks, least recent first. */
+	unsigned a1in_count;      /**< Number of cached probationary blocks. */
+	hash_table_t ghost_hash;  /**< Ghost entries hashed by block address. */
+	list_t ghost_list;        /**< Ghost entries, oldest first. */
+	unsigned ghost_count;     /**< Number of ghost entries. */
+
+	ra_stream_t ra_streams[RA_STREAMS];
+	unsigned ra_clock;        /**< Stream access clock. */
+	unsigned ra_limit;        /**< Current upper bound on the window. */
+	unsigned ra_pending;      /**< Number of readahead fibrils running. */
+	fibril_condvar_t ra_cv;   /**< Signalled when a readahead finishes. */
+
+	list_t dirty_list;        /**< Dirty blocks, oldest first. */
+	unsigned dirty_count;     /**< Number of blocks on the dirty list. */
+	bool flusher_running;     /**< Write-back flusher is running. */
+	bool flusher_stop;        /**< Write-back flusher should terminate. */
+	fibril_condvar_t flusher_cv; /**< Wakes up the write-back flusher. */
+	unsigned writebacks;      /**< Number of write-back transfers in flight. */
+	unsigned flush_waiters;   /**< Number of fibrils waiting in block_flush(). */
+	/** Signalled when a write-back finishes or a dirty block is released. */
+	fibril_condvar_t flush_cv;
+	vfs_cache_stats_t stats;  /**< Write-back statistics. */
 } cache_t;
 
 typedef struct {
@@ -267,6 +340,498 @@ static const hash_table_ops_t cache_ops = {
 	.remove_callback = NULL
 };
 
+/** Address of a block recently evicted from the probationary queue. */
+typedef struct {
+	ht_link_t hash_link;
+	link_t link;
+	aoff64_t lba;
+} ghost_t;
+
+static size_t ghost_hash(const ht_link_t *item)
+{
+	ghost_t *g = hash_table_get_inst(item, ghost_t, hash_link);
+	return g->lba;
+}
+
+static bool ghost_key_equal(const void *key, const ht_link_t *item)
+{
+	const aoff64_t *lba = key;
+	ghost_t *g = hash_table_get_inst(item, ghost_t, hash_link);
+	return g->lba == *lba;
+}
+
+static const hash_table_ops_t ghost_ops = {
+	.hash = ghost_hash,
+	.key_hash = cache_key_hash,
+	.key_equal = ghost_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static void ghost_remove(cache_t *cache, ghost_t *g)
+{
+	hash_table_remove_item(&cache->ghost_hash, &g->hash_link);
+	list_remove(&g->link);
+	cache->ghost_count--;
+	free(g);
+}
+
+/** Remember the address of a block evicted from the probationary queue.
+ *
+ * The cache lock must be held.
+ */
+static void ghost_add(cache_t *cache, aoff64_t lba)
+{
+	if (cache->ghost_count >= cache->max_blocks / CACHE_A1OUT_RATIO) {
+		ghost_remove(cache, list_get_instance(
+		    list_first(&cache->ghost_list), ghost_t, link));
+	}
+
+	ghost_t *g = malloc(sizeof(ghost_t));
+	if (!g)
+		return;
+
+	g->lba = lba;
+	hash_table_insert(&cache->ghost_hash, &g->hash_link);
+	list_append(&g->link, &cache->ghost_list);
+	cache->ghost_count++;
+}
+
+/** Forget the ghost of a block which is about to be cached again.
+ *
+ * The cache lock must be held.
+ *
+ * @return		True if the block was recently evicted.
+ */
+static bool ghost_take(cache_t *cache, aoff64_t lba)
+{
+	ht_link_t *hlink = hash_table_find(&cache->ghost_hash, &lba);
+	if (!hlink)
+		return false;
+
+	ghost_remove(cache, hash_table_get_inst(hlink, ghost_t, hash_link));
+	return true;
+}
+
+/** Account a newly instantiated block.
+ *
+ * The cache lock must be held.
+ *
+ * @param hot		Put the block on the main queue rather than on the
+ *			probationary one.
+ */
+static void cache_block_add(cache_t *cache, block_t *b, bool hot)
+{
+	b->hot = hot;
+	if (!hot) {
+		list_append(&b->free_link, &cache->a1in_list);
+		cache->a1in_count++;
+	}
+}
+
+/** Account a block which is about to leave the cache.
+ *
+ * Blocks evicted from the probationary queue are remembered in the ghost
+ * queue so that they are considered hot should they be needed again soon.
+ * The cache lock must be held.
+ *
+ * @param evict		The block is being evicted to make room for another.
+ */
+static void cache_block_remove(cache_t *cache, block_t *b, bool evict)
+{
+	list_remove(&b->free_link);
+	if (b->hot)
+		return;
+
+	cache->a1in_count--;
+	if (evict && !b->readahead)
+		ghost_add(cache, b->lba);
+}
+
+/** Promote a block to the main queue.
+ *
+ * The cache lock must be held.
+ */
+static void cache_block_promote(cache_t *cache, block_t *b)
+{
+	if (b->hot)
+		return;
+
+	b->hot = true;
+	cache->a1in_count--;
+	list_remove(&b->free_link);
+	if (b->refcnt == 0)
+		list_append(&b->free_link, &cache->am_list);
+}
+
+/** Take a block which is about to be used off the main queue.
+ *
+ * Probationary blocks keep their place in the FIFO.
+ * The cache lock must be held.
+ */
+static void cache_acquire(cache_t *cache, block_t *b)
+{
+	if (b->hot)
+		list_remove(&b->free_link);
+}
+
+/** Put a hot block which is no longer in use on the main queue.
+ *
+ * The cache lock must be held.
+ */
+static void cache_release(cache_t *cache, block_t *b)
+{
+	if (b->hot)
+		list_append(&b->free_link, &cache->am_list);
+}
+
+/** Find the oldest unused probationary block.
+ *
+ * The cache lock must be held.
+ */
+static block_t *cache_a1in_first(cache_t *cache)
+{
+	list_foreach(cache->a1in_list, free_link, block_t, b) {
+		if (b->refcnt == 0)
+			return b;
+	}
+
+	return NULL;
+}
+
+/** Choose an unused block to evict.
+ *
+ * The probationary queue is drained first for as long as it holds more than
+ * its share of the cache so that blocks accessed only once cannot push the
+ * frequently used ones out.
+ *
+ * The cache lock must be held.
+ *
+ * @return		Unused block or NULL if all blocks are in use.
+ */
+static block_t *cache_victim(cache_t *cache)
+{
+	block_t *b = NULL;
+
+	if (cache->a1in_count > cache->max_blocks / CACHE_A1IN_RATIO ||
+	    list_empty(&cache->am_list))
+		b = cache_a1in_first(cache);
+	if (!b && !list_empty(&cache->am_list)) {
+		b = list_get_instance(list_first(&cache->am_list), block_t,
+		    free_link);
+	}
+	if (!b)
+		b = cache_a1in_first(cache);
+
+	return b;
+}
+
+/** Compute the number of blocks which fit in a memory budget. */
+static unsigned cache_budget_blocks(cache_t *cache, size_t budget)
+{
+	return max(budget / cache->lblock_size, CACHE_MIN_BLOCKS);
+}
+
+/** Start tracking a dirty block.
+ *
+ * Wakes up the write-back flusher if there are too many dirty blocks.
+ * The cache lock and the block lock must be held.
+ */
+static void block_dirty_track(cache_t *cache, block_t *b)
+{
+	if (link_in_use(&b->dirty_link))
+		return;
+
+	getuptime(&b->dirty_time);
+	list_append(&b->dirty_link, &cache->dirty_list);
+	if (++cache->dirty_count >= WB_HI_WATERMARK(cache))
+		fibril_condvar_broadcast(&cache->flusher_cv);
+}
+
+/** Stop tracking a block which is no longer dirty.
+ *
+ * The cache lock must be held.
+ */
+static void block_dirty_untrack(cache_t *cache, block_t *b)
+{
+	if (!link_in_use(&b->dirty_link))
+		return;
+
+	list_remove(&b->dirty_link);
+	cache->dirty_count--;
+}
+
+/** Find an unused dirty block which can join a write-back cluster.
+ *
+ * The cache lock must be held.
+ *
+ * @return		Locked block or NULL if there is no such block.
+ */
+static block_t *cache_flush_candidate(cache_t *cache, aoff64_t lba)
+{
+	ht_link_t *hlink = hash_table_find(&cache->block_hash, &lba);
+	if (!hlink)
+		return NULL;
+
+	block_t *b = hash_table_get_inst(hlink, block_t, hash_link);
+	if (b->refcnt > 0 || !fibril_mutex_trylock(&b->lock))
+		return NULL;
+
+	if (!b->dirty || b->toxic) {
+		fibril_mutex_unlock(&b->lock);
+		return NULL;
+	}
+
+	return b;
+}
+
+/** Write back a cluster of adjacent dirty blocks.
+ *
+ * The cluster is grown from @a seed in both directions for as long as the
+ * neighbouring blocks are cached, dirty and unused, and is written back by
+ * a single transfer. The blocks are referenced while the transfer is in
+ * progress so that they cannot be recycled, but the cache lock is dropped.
+ *
+ * The cache lock and the lock of @a seed must be held. Only the cache lock is
+ * held on return.
+ *
+ * @param devcon	Device connection.
+ * @param seed		Dirty block with no references.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t cache_flush_cluster(devcon_t *devcon, block_t *seed)
+{
+	cache_t *cache = devcon->cache;
+	block_t *blocks[WB_CLUSTER_MAX];
+	size_t max_cnt = min(max(WB_MAX_BYTES / cache->lblock_size, 1),
+	    WB_CLUSTER_MAX);
+	size_t cnt = 0;
+	block_t *b;
+
+	blocks[cnt++] = seed;
+	while (cnt < max_cnt && blocks[cnt - 1]->lba > 0) {
+		b = cache_flush_candidate(cache, blocks[cnt - 1]->lba - 1);
+		if (!b)
+			break;
+		blocks[cnt++] = b;
+	}
+
+	/* Put the blocks collected so far in ascending order. */
+	for (size_t i = 0; i < cnt / 2; i++) {
+		b = blocks[i];
+		blocks[i] = blocks[cnt - 1 - i];
+		blocks[cnt - 1 - i] = b;
+	}
+
+	while (cnt < max_cnt) {
+		b = cache_flush_candidate(cache, blocks[cnt - 1]->lba + 1);
+		if (!b)
+			break;
+		blocks[cnt++] = b;
+	}
+
+	void *buf = malloc(cnt * cache->lblock_size);
+	if (!buf) {
+		/* Fall back to writing the seed block alone, in place. */
+		for (size_t i = 0; i < cnt; i++) {
+			if (blocks[i] != seed)
+				fibril_mutex_unlock(&blocks[i]->lock);
+		}
+		blocks[0] = seed;
+		cnt = 1;
+	}
+
+	/*
+	 * Take a snapshot of the blocks and mark them clean. Anyone who gets
+	 * hold of a block from now on and modifies it will dirty it again.
+	 */
+	for (size_t i = 0; i < cnt; i++) {
+		b = blocks[i];
+		assert(b->refcnt == 0);
+
+		if (buf) {
+			memcpy(buf + i * cache->lblock_size, b->data,
+			    cache->lblock_size);
+		}
+		b->dirty = false;
+		b->refcnt++;
+		cache_acquire(cache, b);
+		block_dirty_untrack(cache, b);
+		fibril_mutex_unlock(&b->lock);
+	}
+	cache->writebacks++;
+	fibril_mutex_unlock(&cache->lock);
+
+	struct timespec start, end;
+	getuptime(&start);
+	errno_t rc = write_blocks(devcon, blocks[0]->pba,
+	    cnt * cache->blocks_cluster, buf ? buf : seed->data,
+	    cnt * cache->lblock_size);
+	getuptime(&end);
+	free(buf);
+
+	fibril_mutex_lock(&cache->lock);
+
+	uint64_t duration = NSEC2USEC(ts_sub_diff(&end, &start));
+	cache->stats.flushes++;
+	cache->stats.flushed_blocks += cnt;
+	cache->stats.flush_time += duration;
+	if (duration > cache->stats.flush_time_max)
+		cache->stats.flush_time_max = duration;
+
+	for (size_t i = 0; i < cnt; i++) {
+		b = blocks[i];
+
+		fibril_mutex_lock(&b->lock);
+		if (rc != EOK) {
+			/* Keep the block around for another try. */
+			if (b->write_failures < MAX_WRITE_RETRIES) {
+				b->write_failures++;
+				b->dirty = true;
+			} else {
+				printf("Too many errors writing block %"
+				    PRIuOFF64 "from device handle %" PRIun "\n"
+				    "SEVERE DATA LOSS POSSIBLE\n",
+				    b->lba, devcon->service_id);
+			}
+		} else
+			b->write_failures = 0;
+
+		if (b->dirty)
+			block_dirty_track(cache, b);
+		if (--b->refcnt == 0)
+			cache_release(cache, b);
+		fibril_mutex_unlock(&b->lock);
+	}
+
+	cache->writebacks--;
+	if (cache->flush_waiters > 0)
+		fibril_condvar_broadcast(&cache->flush_cv);
+
+	return rc;
+}
+
+/** Write back dirty blocks.
+ *
+ * Dirty blocks within the given range are written back, oldest first, in
+ * clusters of adjacent blocks. In the background mode, only the blocks which
+ * have been dirty for too long are written back, unless there are too many
+ * dirty blocks, in which case the oldest blocks are written back until the
+ * low watermark is reached. Blocks which are in use are skipped.
+ *
+ * The cache lock must be held. It is dropped while writing.
+ *
+ * @param devcon	Device connection.
+ * @param ba		First logical block of the range.
+ * @param cnt		Number of blocks in the range.
+ * @param background	Write back only the blocks which are due.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t cache_flush(devcon_t *devcon, aoff64_t ba, aoff64_t cnt,
+    bool background)
+{
+	cache_t *cache = devcon->cache;
+	unsigned rounds = cache->dirty_count;
+	bool pressure = cache->dirty_count >= WB_HI_WATERMARK(cache);
+	struct timespec deadline;
+	errno_t rc = EOK;
+
+	getuptime(&deadline);
+	ts_add_diff(&deadline, -USEC2NSEC(WB_MAX_AGE));
+
+	while (rounds-- > 0) {
+		block_t *seed = NULL;
+
+		list_foreach_safe(cache->dirty_list, cur, next) {
+			block_t *b = list_get_instance(cur, block_t,
+			    dirty_link);
+
+			if (background && !ts_gteq(&deadline, &b->dirty_time) &&
+			    (!pressure ||
+			    cache->dirty_count <= WB_LO_WATERMARK(cache)))
+				break;
+			if (b->lba < ba || b->lba - ba >= cnt)
+				continue;
+			if (b->refcnt > 0 || !fibril_mutex_trylock(&b->lock))
+				continue;
+			if (!b->dirty || b->toxic) {
+				block_dirty_untrack(cache, b);
+				fibril_mutex_unlock(&b->lock);
+				continue;
+			}
+
+			seed = b;
+			break;
+		}
+
+		if (!seed)
+			break;
+
+		errno_t frc = cache_flush_cluster(devcon, seed);
+		if (frc != EOK)
+			rc = frc;
+	}
+
+	return rc;
+}
+
+/** Check whether block_flush() has to wait before the range is clean.
+ *
+ * This is the case if a dirty block within the range is in use, or if a
+ * write-back is in progress. Blocks being written back are not tracked as
+ * dirty any more, so any write-back in flight counts.
+ *
+ * The cache lock must be held.
+ */
+static bool cache_flush_busy(cache_t *cache, aoff64_t ba, aoff64_t cnt)
+{
+	if (cache->writebacks > 0)
+		return true;
+
+	list_foreach(cache->dirty_list, dirty_link, block_t, b) {
+		if (b->lba >= ba && b->lba - ba < cnt && b->refcnt > 0)
+			return true;
+	}
+
+	return false;
+}
+
+/** Periodically write back dirty blocks of a write-back cache. */
+static errno_t flusher_fibril(void *arg)
+{
+	devcon_t *devcon = (devcon_t *) arg;
+	cache_t *cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+	while (!cache->flusher_stop) {
+		(void) fibril_condvar_wait_timeout(&cache->flusher_cv,
+		    &cache->lock, WB_INTERVAL);
+		if (cache->flusher_stop)
+			break;
+		(void) cache_flush(devcon, 0, (aoff64_t) -1, true);
+	}
+	cache->flusher_running = false;
+	fibril_condvar_broadcast(&cache->flusher_cv);
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
+/** Initialize the block cache of a device.
+ *
+ * The cache grows on demand up to its memory budget, which is fixed for the
+ * lifetime of the cache.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param size		Logical block size.
+ * @param blocks	Budget of the cache in blocks or zero for the default
+ *			budget.
+ * @param mode		Caching mode.
+ *
+ * @return		EOK on success or an error code.
+ */
 errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
     enum cache_mode mode)
 {
@@ -281,11 +846,30 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 		return ENOMEM;
 
 	fibril_mutex_initialize(&cache->lock);
-	list_initialize(&cache->free_list);
 	cache->lblock_size = size;
-	cache->block_count = blocks;
+	cache->max_blocks = blocks ? max(blocks, CACHE_MIN_BLOCKS) :
+	    cache_budget_blocks(cache, CACHE_BUDGET);
 	cache->blocks_cached = 0;
 	cache->mode = mode;
+	list_initialize(&cache->a1in_list);
+	list_initialize(&cache->am_list);
+	cache->a1in_count = 0;
+	list_initialize(&cache->ghost_list);
+	cache->ghost_count = 0;
+	memset(cache->ra_streams, 0, sizeof(cache->ra_streams));
+	cache->ra_clock = 0;
+	cache->ra_limit = RA_WINDOW_MAX;
+	cache->ra_pending = 0;
+	fibril_condvar_initialize(&cache->ra_cv);
+	list_initialize(&cache->dirty_list);
+	cache->dirty_count = 0;
+	cache->flusher_running = false;
+	cache->flusher_stop = false;
+	fibril_condvar_initialize(&cache->flusher_cv);
+	cache->writebacks = 0;
+	cache->flush_waiters = 0;
+	fibril_condvar_initialize(&cache->flush_cv);
+	memset(&cache->stats, 0, sizeof(cache->stats));
 
 	/* Allow 1:1 or small-to-large block size translation */
 	if (cache->lblock_size % devcon->pblock_size != 0) {
@@ -300,7 +884,52 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 		return ENOMEM;
 	}
 
+	if (!hash_table_create(&cache->ghost_hash, 0, 0, &ghost_ops)) {
+		hash_table_destroy(&cache->block_hash);
+		free(cache);
+		return ENOMEM;
+	}
+
 	devcon->cache = cache;
+
+	if (mode == CACHE_MODE_WB) {
+		fid_t fid = fibril_create(flusher_fibril, devcon);
+		if (!fid) {
+			devcon->cache = NULL;
+			hash_table_destroy(&cache->ghost_hash);
+			hash_table_destroy(&cache->block_hash);
+			free(cache);
+			return ENOMEM;
+		}
+
+		cache->flusher_running = true;
+		fibril_add_ready(fid);
+	}
+
+	return EOK;
+}
+
+/** Get write-back statistics of a block cache.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param stats		Place to store the statistics.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t block_cache_get_stats(service_id_t service_id,
+    vfs_cache_stats_t *stats)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	if (!devcon || !devcon->cache)
+		return ENOENT;
+
+	cache_t *cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+	*stats = cache->stats;
+	stats->dirty_bytes = cache->dirty_count * cache->lblock_size;
+	fibril_mutex_unlock(&cache->lock);
+
 	return EOK;
 }
 
@@ -316,13 +945,28 @@ errno_t block_cache_fini(service_id_t service_id)
 		return EOK;
 	cache = devcon->cache;
 
+	/* Wait for readahead in progress to finish. */
+	fibril_mutex_lock(&cache->lock);
+	while (cache->ra_pending > 0)
+		fibril_condvar_wait(&cache->ra_cv, &cache->lock);
+
+	/* Stop the flusher and write back as much as we can in clusters. */
+	cache->flusher_stop = true;
+	fibril_condvar_broadcast(&cache->flusher_cv);
+	while (cache->flusher_running)
+		fibril_condvar_wait(&cache->flusher_cv, &cache->lock);
+	(void) cache_flush(devcon, 0, (aoff64_t) -1, false);
+	fibril_mutex_unlock(&cache->lock);
+
 	/*
 	 * We are expecting to find all blocks for this device handle on the
-	 * free list, i.e. the block reference count should be zero. Do not
-	 * bother with the cache and block locks because we are single-threaded.
+	 * replacement queues, i.e. the block reference count should be zero.
+	 * Do not bother with the cache and block locks because we are
+	 * single-threaded.
 	 */
-	while (!list_empty(&cache->free_list)) {
-		block_t *b = list_get_instance(list_first(&cache->free_list),
+	list_concat(&cache->a1in_list, &cache->am_list);
+	while (!list_empty(&cache->a1in_list)) {
+		block_t *b = list_get_instance(list_first(&cache->a1in_list),
 		    block_t, free_link);
 
 		list_remove(&b->free_link);
@@ -339,6 +983,12 @@ errno_t block_cache_fini(service_id_t service_id)
 		free(b);
 	}
 
+	while (!list_empty(&cache->ghost_list)) {
+		ghost_remove(cache, list_get_instance(
+		    list_first(&cache->ghost_list), ghost_t, link));
+	}
+
+	hash_table_destroy(&cache->ghost_hash);
 	hash_table_destroy(&cache->block_hash);
 	devcon->cache = NULL;
 	free(cache);
@@ -346,15 +996,11 @@ errno_t block_cache_fini(service_id_t service_id)
 	return EOK;
 }
 
-#define CACHE_LO_WATERMARK	10
-#define CACHE_HI_WATERMARK	20
 static bool cache_can_grow(cache_t *cache)
 {
-	if (cache->blocks_cached < CACHE_LO_WATERMARK)
+	if (cache->blocks_cached < cache->max_blocks)
 		return true;
-	if (!list_empty(&cache->free_list))
-		return false;
-	return true;
+	return cache_victim(cache) == NULL;
 }
 
 static void block_initialize(block_t *b)
@@ -364,8 +1010,258 @@ static void block_initialize(block_t *b)
 	b->write_failures = 0;
 	b->dirty = false;
 	b->toxic = false;
+	b->readahead = false;
+	b->hot = false;
 	fibril_rwlock_initialize(&b->contents_lock);
 	link_initialize(&b->free_link);
+	link_initialize(&b->dirty_link);
+}
+
+/** Readahead request handed over to the readahead fibril. */
+typedef struct {
+	devcon_t *devcon;
+	aoff64_t ba;              /**< First logical block to read. */
+	size_t cnt;               /**< Number of logical blocks to read. */
+} ra_request_t;
+
+/** Get a block for readahead.
+ *
+ * The cache may grow up to its budget. Beyond that, only the oldest unused
+ * probationary block is recycled, if it is clean, so that readahead never needs
+ * to write anything back nor evicts frequently used blocks.
+ *
+ * The cache lock must be held.
+ */
+static block_t *readahead_block_alloc(cache_t *cache)
+{
+	block_t *b;
+
+	if (cache->blocks_cached < cache->max_blocks) {
+		b = malloc(sizeof(block_t));
+		if (!b)
+			return NULL;
+		b->data = malloc(cache->lblock_size);
+		if (!b->data) {
+			free(b);
+			return NULL;
+		}
+		cache->blocks_cached++;
+		return b;
+	}
+
+	b = cache_a1in_first(cache);
+	if (!b)
+		return NULL;
+
+	fibril_mutex_lock(&b->lock);
+	bool dirty = b->dirty;
+	fibril_mutex_unlock(&b->lock);
+	if (dirty)
+		return NULL;
+
+	if (b->readahead) {
+		/* We read too far ahead, shrink the window. */
+		cache->ra_limit = max(cache->ra_limit / 2, RA_WINDOW_MIN);
+	}
+
+	block_dirty_untrack(cache, b);
+	cache_block_remove(cache, b, true);
+	hash_table_remove_item(&cache->block_hash, &b->hash_link);
+	return b;
+}
+
+/** Read a run of blocks ahead of a sequential stream. */
+static errno_t readahead_fibril(void *arg)
+{
+	ra_request_t *req = (ra_request_t *) arg;
+	devcon_t *devcon = req->devcon;
+	cache_t *cache = devcon->cache;
+	block_t *blocks[RA_WINDOW_MAX];
+	aoff64_t ba = req->ba;
+	size_t cnt = 0;
+
+	fibril_mutex_lock(&cache->lock);
+
+	/* Skip blocks which are already cached. */
+	while (req->cnt > 0 && hash_table_find(&cache->block_hash, &ba)) {
+		ba++;
+		req->cnt--;
+	}
+
+	/* Instantiate a contiguous run of blocks which are not cached. */
+	while (cnt < req->cnt) {
+		aoff64_t cba = ba + cnt;
+		if (hash_table_find(&cache->block_hash, &cba))
+			break;
+
+		block_t *b = readahead_block_alloc(cache);
+		if (!b)
+			break;
+
+		block_initialize(b);
+		b->service_id = devcon->service_id;
+		b->size = cache->lblock_size;
+		b->lba = cba;
+		b->pba = ba_ltop(devcon, b->lba);
+		b->readahead = true;
+		cache_block_add(cache, b, false);
+		hash_table_insert(&cache->block_hash, &b->hash_link);
+
+		/*
+		 * Keep the block locked until its contents are read so that
+		 * block_get() waits for the data.
+		 */
+		fibril_mutex_lock(&b->lock);
+		blocks[cnt++] = b;
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+
+	if (cnt > 0) {
+		size_t size = cnt * cache->lblock_size;
+		void *buf = malloc(size);
+		errno_t rc = ENOMEM;
+		if (buf) {
+			rc = read_blocks(devcon, blocks[0]->pba,
+			    cnt * cache->blocks_cluster, buf, size);
+		}
+
+		for (size_t i = 0; i < cnt; i++) {
+			block_t *b = blocks[i];
+
+			if (rc == EOK) {
+				memcpy(b->data, buf + i * cache->lblock_size,
+				    cache->lblock_size);
+			} else {
+				/* Fall back to reading the blocks one by one. */
+				if (read_blocks(devcon, b->pba,
+				    cache->blocks_cluster, b->data,
+				    cache->lblock_size) != EOK)
+					b->toxic = true;
+			}
+			fibril_mutex_unlock(&b->lock);
+		}
+
+		free(buf);
+	}
+
+	/* Drop the readahead references. */
+	fibril_mutex_lock(&cache->lock);
+	for (size_t i = 0; i < cnt; i++) {
+		block_t *b = blocks[i];
+
+		fibril_mutex_lock(&b->lock);
+		if (--b->refcnt == 0) {
+			if (b->toxic) {
+				cache_block_remove(cache, b, false);
+				hash_table_remove_item(&cache->block_hash,
+				    &b->hash_link);
+				fibril_mutex_unlock(&b->lock);
+				free(b->data);
+				free(b);
+				cache->blocks_cached--;
+				continue;
+			}
+			cache_release(cache, b);
+		}
+		fibril_mutex_unlock(&b->lock);
+	}
+	cache->ra_pending--;
+	fibril_condvar_broadcast(&cache->ra_cv);
+	fibril_mutex_unlock(&cache->lock);
+
+	free(req);
+	return EOK;
+}
+
+/** Account a block access for sequential stream detection.
+ *
+ * An access which continues one of the tracked streams may trigger an
+ * asynchronous read of the next window of the stream. The window doubles
+ * each time the stream catches up with the blocks read ahead for it, up to a
+ * limit which is halved whenever blocks read ahead are evicted unused.
+ *
+ * @param devcon	Device connection.
+ * @param ba		Logical address of the accessed block.
+ */
+static void readahead_access(devcon_t *devcon, aoff64_t ba)
+{
+	cache_t *cache = devcon->cache;
+	aoff64_t limit = devcon->pblocks / cache->blocks_cluster;
+
+	fibril_mutex_lock(&cache->lock);
+
+	unsigned stamp = ++cache->ra_clock;
+	ra_stream_t *stream = NULL;
+	ra_stream_t *lru = &cache->ra_streams[0];
+
+	for (unsigned i = 0; i < RA_STREAMS; i++) {
+		ra_stream_t *s = &cache->ra_streams[i];
+		if (s->window != 0 && s->next == ba) {
+			stream = s;
+			break;
+		}
+		if (s->stamp < lru->stamp)
+			lru = s;
+	}
+
+	if (stream == NULL) {
+		/* Start tracking a new stream in place of the oldest one. */
+		lru->next = ba + 1;
+		lru->ra_end = ba + 1;
+		lru->window = RA_WINDOW_MIN;
+		lru->stamp = stamp;
+		fibril_mutex_unlock(&cache->lock);
+		return;
+	}
+
+	stream->stamp = stamp;
+	stream->next = ba + 1;
+
+	if (stream->ra_end > ba + 1) {
+		/* There are still blocks read ahead in front of us. */
+		if (stream->ra_end - ba > stream->window / 2) {
+			fibril_mutex_unlock(&cache->lock);
+			return;
+		}
+		stream->window *= 2;
+	} else {
+		stream->ra_end = ba + 1;
+	}
+	stream->window = min(stream->window, cache->ra_limit);
+
+	aoff64_t start = stream->ra_end;
+	size_t cnt = min(stream->window,
+	    max(RA_MAX_BYTES / cache->lblock_size, 1));
+	if (start + 1 >= limit) {
+		fibril_mutex_unlock(&cache->lock);
+		return;
+	}
+	if (start + cnt >= limit)
+		cnt = limit - 1 - start;
+
+	ra_request_t *req = malloc(sizeof(ra_request_t));
+	if (!req) {
+		fibril_mutex_unlock(&cache->lock);
+		return;
+	}
+
+	req->devcon = devcon;
+	req->ba = start;
+	req->cnt = cnt;
+
+	fid_t fid = fibril_create(readahead_fibril, req);
+	if (!fid) {
+		fibril_mutex_unlock(&cache->lock);
+		free(req);
+		return;
+	}
+
+	stream->ra_end = start + cnt;
+	cache->ra_pending++;
+	fibril_mutex_unlock(&cache->lock);
+
+	fibril_add_ready(fid);
 }
 
 /** Instantiate a block in memory and get a reference to it.
@@ -376,7 +1272,8 @@ static void block_initialize(block_t *b)
  * @param ba			Block address (logical).
  * @param flags			If BLOCK_FLAGS_NOREAD is specified, block_get()
  * 				will not read the contents of the block from the
- *				device.
+ *				device. If BLOCK_FLAGS_META is specified, the
+ *				block is kept on the main replacement queue.
  *
  * @return			EOK on success or an error code.
  */
@@ -385,7 +1282,6 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 	devcon_t *devcon;
 	cache_t *cache;
 	block_t *b;
-	link_t *link;
 	aoff64_t p_ba;
 	errno_t rc;
 
@@ -407,6 +1303,9 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 		return EIO;
 	}
 
+	if (!(flags & BLOCK_FLAGS_NOREAD))
+		readahead_access(devcon, ba);
+
 retry:
 	rc = EOK;
 	b = NULL;
@@ -414,18 +1313,31 @@ retry:
 	fibril_mutex_lock(&cache->lock);
 	ht_link_t *hlink = hash_table_find(&cache->block_hash, &ba);
 	if (hlink) {
-	found:
 		/*
 		 * We found the block in the cache.
 		 */
 		b = hash_table_get_inst(hlink, block_t, hash_link);
-		fibril_mutex_lock(&b->lock);
 		if (b->refcnt++ == 0)
-			list_remove(&b->free_link);
+			cache_acquire(cache, b);
+		if (b->readahead) {
+			/* The readahead paid off. */
+			b->readahead = false;
+			if (cache->ra_limit < RA_WINDOW_MAX)
+				cache->ra_limit++;
+		}
+		if (flags & BLOCK_FLAGS_META)
+			cache_block_promote(cache, b);
+		fibril_mutex_unlock(&cache->lock);
+
+		/*
+		 * The block may still be being read. Our reference keeps it in
+		 * the cache, so wait for the data without holding the cache
+		 * lock, which would stall all other cache operations.
+		 */
+		fibril_mutex_lock(&b->lock);
 		if (b->toxic)
 			rc = EIO;
 		fibril_mutex_unlock(&b->lock);
-		fibril_mutex_unlock(&cache->lock);
 	} else {
 		/*
 		 * The block was not found in the cache.
@@ -448,93 +1360,62 @@ retry:
 			cache->blocks_cached++;
 		} else {
 			/*
-			 * Try to recycle a block from the free list.
+			 * Try to recycle a block chosen by the replacement
+			 * policy.
 			 */
 		recycle:
-			if (list_empty(&cache->free_list)) {
+			b = cache_victim(cache);
+			if (!b) {
 				fibril_mutex_unlock(&cache->lock);
 				rc = ENOMEM;
 				goto out;
 			}
-			link = list_first(&cache->free_list);
-			b = list_get_instance(link, block_t, free_link);
 
 			fibril_mutex_lock(&b->lock);
 			if (b->dirty) {
 				/*
 				 * The block needs to be written back to the
-				 * device before it changes identity. Do this
-				 * while not holding the cache lock so that
-				 * concurrency is not impeded. Also move the
-				 * block to the end of the free list so that we
-				 * do not slow down other instances of
-				 * block_get() draining the free list.
+				 * device before it changes identity. Write it
+				 * back together with its dirty neighbours
+				 * while not holding the cache lock and start
+				 * over as the cache may have changed in the
+				 * meantime.
 				 */
-				list_remove(&b->free_link);
-				list_append(&b->free_link, &cache->free_list);
+				(void) cache_flush_cluster(devcon, b);
 				fibril_mutex_unlock(&cache->lock);
-				rc = write_blocks(devcon, b->pba,
-				    cache->blocks_cluster, b->data, b->size);
-				if (rc != EOK) {
-					/*
-					 * We did not manage to write the block
-					 * to the device. Keep it around for
-					 * another try. Hopefully, we will grab
-					 * another block next time.
-					 */
-					if (b->write_failures < MAX_WRITE_RETRIES) {
-						b->write_failures++;
-						fibril_mutex_unlock(&b->lock);
-						goto retry;
-					} else {
-						printf("Too many errors writing block %"
-						    PRIuOFF64 "from device handle %" PRIun "\n"
-						    "SEVERE DATA LOSS POSSIBLE\n",
-						    b->lba, devcon->service_id);
-					}
-				} else
-					b->write_failures = 0;
-
-				b->dirty = false;
-				if (!fibril_mutex_trylock(&cache->lock)) {
-					/*
-					 * Somebody is probably racing with us.
-					 * Unlock the block and retry.
-					 */
-					fibril_mutex_unlock(&b->lock);
-					goto retry;
-				}
-				hlink = hash_table_find(&cache->block_hash, &ba);
-				if (hlink) {
-					/*
-					 * Someone else must have already
-					 * instantiated the block while we were
-					 * not holding the cache lock.
-					 * Leave the recycled block on the
-					 * freelist and continue as if we
-					 * found the block of interest during
-					 * the first try.
-					 */
-					fibril_mutex_unlock(&b->lock);
-					goto found;
-				}
-
+				goto retry;
 			}
 			fibril_mutex_unlock(&b->lock);
 
+			if (b->readahead) {
+				/* We read too far ahead, shrink the window. */
+				cache->ra_limit = max(cache->ra_limit / 2,
+				    RA_WINDOW_MIN);
+			}
+
 			/*
-			 * Unlink the block from the free list and the hash
-			 * table.
+			 * Unlink the block from its replacement queue and the
+			 * hash table.
 			 */
-			list_remove(&b->free_link);
+			block_dirty_untrack(cache, b);
+			cache_block_remove(cache, b, true);
 			hash_table_remove_item(&cache->block_hash, &b->hash_link);
 		}
 
+		/*
+		 * Blocks which were evicted from the probationary queue only
+		 * recently have proven to be worth keeping.
+		 */
+		bool hot = ghost_take(cache, ba);
+		if (flags & BLOCK_FLAGS_META)
+			hot = true;
+
 		block_initialize(b);
 		b->service_id = service_id;
 		b->size = cache->lblock_size;
 		b->lba = ba;
 		b->pba = ba_ltop(devcon, b->lba);
+		cache_block_add(cache, b, hot);
 		hash_table_insert(&cache->block_hash, &b->hash_link);
 
 		/*
@@ -582,6 +1463,8 @@ errno_t block_put(block_t *block)
 	devcon_t *devcon = devcon_search(block->service_id);
 	cache_t *cache;
 	unsigned blocks_cached;
+	unsigned max_blocks;
+	unsigned refcnt;
 	enum cache_mode mode;
 	errno_t rc = EOK;
 
@@ -594,21 +1477,24 @@ errno_t block_put(block_t *block)
 retry:
 	fibril_mutex_lock(&cache->lock);
 	blocks_cached = cache->blocks_cached;
+	max_blocks = cache->max_blocks;
 	mode = cache->mode;
+	refcnt = block->refcnt;
 	fibril_mutex_unlock(&cache->lock);
 
 	/*
 	 * Determine whether to sync the block. Syncing the block is best done
 	 * when not holding the cache lock as it does not impede concurrency.
 	 * Since the situation may have changed when we unlocked the cache, the
-	 * blocks_cached and mode variables are mere hints. We will recheck the
-	 * conditions later when the cache lock is held again.
+	 * blocks_cached, max_blocks, refcnt and mode variables are mere hints.
+	 * We will recheck the conditions later when the cache lock is held
+	 * again.
 	 */
 	fibril_mutex_lock(&block->lock);
 	if (block->toxic)
 		block->dirty = false;	/* will not write back toxic block */
-	if (block->dirty && (block->refcnt == 1) &&
-	    (blocks_cached > CACHE_HI_WATERMARK || mode != CACHE_MODE_WB)) {
+	if (block->dirty && (refcnt == 1) &&
+	    (blocks_cached > max_blocks || mode != CACHE_MODE_WB)) {
 		rc = write_blocks(devcon, block->pba, cache->blocks_cluster,
 		    block->data, block->size);
 		if (rc == EOK)
@@ -619,13 +1505,19 @@ retry:
 
 	fibril_mutex_lock(&cache->lock);
 	fibril_mutex_lock(&block->lock);
+	if (block->dirty)
+		block_dirty_track(cache, block);
+	else
+		block_dirty_untrack(cache, block);
+	if (block->refcnt == 1 && cache->flush_waiters > 0)
+		fibril_condvar_broadcast(&cache->flush_cv);
 	if (!--block->refcnt) {
 		/*
 		 * Last reference to the block was dropped. Either free the
 		 * block or put it on the free list. In case of an I/O error,
 		 * free the block.
 		 */
-		if ((cache->blocks_cached > CACHE_HI_WATERMARK) ||
+		if ((cache->blocks_cached > cache->max_blocks) ||
 		    (rc != EOK)) {
 			/*
 			 * Currently there are too many cached blocks or there
@@ -654,6 +1546,8 @@ retry:
 			/*
 			 * Take the block out of the cache and free it.
 			 */
+			block_dirty_untrack(cache, block);
+			cache_block_remove(cache, block, false);
 			hash_table_remove_item(&cache->block_hash, &block->hash_link);
 			fibril_mutex_unlock(&block->lock);
 			free(block->data);
@@ -663,7 +1557,7 @@ retry:
 			return rc;
 		}
 		/*
-		 * Put the block on the free list.
+		 * Put the block on its replacement queue.
 		 */
 		if (cache->mode != CACHE_MODE_WB && block->dirty) {
 			/*
@@ -675,7 +1569,7 @@ retry:
 			fibril_mutex_unlock(&cache->lock);
 			goto retry;
 		}
-		list_append(&block->free_link, &cache->free_list);
+		cache_release(cache, block);
 	}
 	fibril_mutex_unlock(&block->lock);
 	fibril_mutex_unlock(&cache->lock);
@@ -683,6 +1577,48 @@ retry:
 	return rc;
 }
 
+/** Write back dirty blocks of a write-back cache.
+ *
+ * This is meant for implementing fsync(). Dirty blocks which are in use are
+ * written back once they are released, and write-backs already in progress
+ * are waited for, so the range is clean on the device when this returns.
+ * The caller must not hold references to blocks within the range.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param ba		Address of the first block (logical).
+ * @param cnt		Number of blocks.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t block_flush(service_id_t service_id, aoff64_t ba, aoff64_t cnt)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	cache_t *cache;
+	errno_t rc = EOK;
+
+	assert(devcon);
+	assert(devcon->cache);
+
+	cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+	while (true) {
+		errno_t frc = cache_flush(devcon, ba, cnt, false);
+		if (frc != EOK)
+			rc = frc;
+
+		if (!cache_flush_busy(cache, ba, cnt))
+			break;
+
+		cache->flush_waiters++;
+		fibril_condvar_wait(&cache->flush_cv, &cache->lock);
+		cache->flush_waiters--;
+	}
+	fibril_mutex_unlock(&cache->lock);
+
+	return rc;
+}
+
 /** Read sequential data from a block device.
  *
  * @param service_id	Service ID of the block device.
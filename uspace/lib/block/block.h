@@ -44,6 +44,8 @@
 #include <adt/hash_table.h>
 #include <adt/list.h>
 #include <loc.h>
+#include <time.h>
+#include <vfs/vfs.h>
 
 /*
  * Flags that can be used with block_get().
@@ -61,15 +63,27 @@
  */
 #define BLOCK_FLAGS_NOREAD	1
 
+/**
+ * The block holds file system metadata. Such blocks bypass the probationary
+ * queue of the cache so that they are not pushed out by large sequential
+ * transfers of file data.
+ */
+#define BLOCK_FLAGS_META	2
+
 typedef struct block {
-	/** Mutex protecting the reference count. */
+	/** Mutex protecting the block state, held during I/O on the block. */
 	fibril_mutex_t lock;
-	/** Number of references to the block_t structure. */
+	/** Number of references to the block_t structure, changed only with
+	 * the cache lock held. */
 	unsigned refcnt;
 	/** If true, the block needs to be written back to the block device. */
 	bool dirty;
 	/** If true, the blcok does not contain valid data. */
 	bool toxic;
+	/** If true, the block was read ahead and has not been used yet. */
+	bool readahead;
+	/** If true, the block is on the frequently used queue of the cache. */
+	bool hot;
 	/** Readers / Writer lock protecting the contents of the block. */
 	fibril_rwlock_t contents_lock;
 	/** Service ID of service providing the block device. */
@@ -84,6 +98,10 @@ typedef struct block {
 	int write_failures;
 	/** Link for placing the block into the free block list. */
 	link_t free_link;
+	/** Link for placing the block into the dirty block list. */
+	link_t dirty_link;
+	/** Time when the block was first found dirty. */
+	struct timespec dirty_time;
 	/** Link for placing the block into the block hash table. */
 	ht_link_t hash_link;
 	/** Buffer with the block data. */
@@ -98,6 +116,7 @@ enum cache_mode {
 	CACHE_MODE_WB
 };
 
+
 extern errno_t block_init(service_id_t, size_t);
 extern void block_fini(service_id_t);
 
@@ -106,9 +125,11 @@ extern void *block_bb_get(service_id_t);
 
 extern errno_t block_cache_init(service_id_t, size_t, unsigned, enum cache_mode);
 extern errno_t block_cache_fini(service_id_t);
+extern errno_t block_cache_get_stats(service_id_t, vfs_cache_stats_t *);
 
 extern errno_t block_get(block_t **, service_id_t, aoff64_t, int);
 extern errno_t block_put(block_t *);
+extern errno_t block_flush(service_id_t, aoff64_t, aoff64_t);
 
 extern errno_t block_seqread(service_id_t, void *, size_t *, size_t *, aoff64_t *,
     void *, size_t);
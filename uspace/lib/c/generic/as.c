@@ -92,6 +92,23 @@ errno_t as_area_destroy(void *address)
 	return (errno_t) __SYSCALL1(SYS_AS_AREA_DESTROY, (sysarg_t) address);
 }
 
+/** Discard pages of an address-space area.
+ *
+ * The memory is released, but stays mapped. Anonymous memory
+ * reads back as zeros when it is accessed again.
+ *
+ * @param address Page-aligned start of the range to discard.
+ * @param size    Page-aligned size of the range to discard.
+ *
+ * @return zero on success or a code from @ref errno.h on failure.
+ *
+ */
+errno_t as_area_discard(void *address, size_t size)
+{
+	return (errno_t) __SYSCALL2(SYS_AS_AREA_DISCARD, (sysarg_t) address,
+	    (sysarg_t) size);
+}
+
 /** Change address-space area flags.
  *
  * @param address Virtual address pointing into the address space area being
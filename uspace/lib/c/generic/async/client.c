@@ -1293,6 +1293,22 @@ errno_t async_share_out_start(async_exch_t *exch, void *src, unsigned int flags)
 	    (sysarg_t) flags);
 }
 
+/** Wrapper for IPC_M_WAITQ_SHARE calls using the async framework.
+ *
+ * @param exch    Exchange for sending the message.
+ * @param whandle Wait queue to share with the recipient.
+ *
+ * @return Zero on success or an error code from errno.h.
+ *
+ */
+errno_t async_waitq_share_start(async_exch_t *exch, cap_waitq_handle_t whandle)
+{
+	if (exch == NULL)
+		return ENOENT;
+
+	return async_req_1_0(exch, IPC_M_WAITQ_SHARE, (sysarg_t) whandle);
+}
+
 /** Start IPC_M_DATA_READ using the async framework.
  *
  * @param exch    Exchange for sending the message.
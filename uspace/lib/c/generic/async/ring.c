@@ -0,0 +1,660 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Shared memory ring channels.
+ *
+ * A ring is a single-producer single-consumer queue of variable-sized
+ * records living in an address space area shared between two tasks. Once
+ * the ring is set up, records are passed without any system call as long as
+ * neither side has to wait. A side that finds the ring full (producer) or
+ * empty (consumer) announces that it is going to sleep in the shared control
+ * block and the other side rings its doorbell, a kernel wait queue shared
+ * using IPC_M_WAITQ_SHARE, after the next change.
+ *
+ * Sleeping in a wait queue blocks the whole thread, so each endpoint has a
+ * doorbell thread which does the sleeping on behalf of the fibril using the
+ * ring and turns the wakeups into fibril events.
+ *
+ * A peer may die without destroying its endpoint. To notice that, the
+ * creating side sends a call which the accepting side answers only when it
+ * destroys its endpoint, and which the kernel answers when the accepting
+ * task dies. The accepting side in turn watches its connection for a hangup.
+ *
+ * Only one fibril may use an endpoint at a time.
+ */
+
+#include <async.h>
+#include <as.h>
+#include <assert.h>
+#include <errno.h>
+#include <libc.h>
+#include <mem.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <align.h>
+#include <bitops.h>
+#include <abi/mm/as.h>
+#include <abi/synch.h>
+#include <abi/syscall.h>
+#include "../private/async.h"
+#include "../private/fibril.h"
+#include "../private/thread.h"
+
+/** Size of the blocks which the control fields are spread over. */
+#define RING_LINE  64
+
+/** Record length marking that the rest of the data area is unused. */
+#define RING_WRAP  SIZE_MAX
+
+#define RING_RECORD_SIZE(len) \
+	(sizeof(size_t) + ALIGN_UP((len), sizeof(size_t)))
+
+/** Method of the call held by the accepting side while the ring exists. */
+#define RING_M_HOLD  IPC_FIRST_USER_METHOD
+
+/** Control block at the beginning of the shared area.
+ *
+ * Both positions count bytes since the ring was created and only grow.
+ * The capacity of the ring is a power of two, so the offsets derived from
+ * the positions stay right when the positions wrap around. Each position
+ * is written by one side only and is kept in a separate cache line so that
+ * the two sides do not contend. The peer can write anything into the area,
+ * so the positions and record lengths are checked before they are used.
+ */
+typedef struct {
+	/** Position of the next record to read. Written by the consumer. */
+	atomic_size_t head __attribute__((aligned(RING_LINE)));
+	/** Consumer is about to sleep until tail moves. */
+	atomic_bool consumer_waiting;
+
+	/** Position of the next record to write. Written by the producer. */
+	atomic_size_t tail __attribute__((aligned(RING_LINE)));
+	/** Producer is about to sleep until head moves. */
+	atomic_bool producer_waiting;
+
+	/** One of the sides has destroyed its endpoint. */
+	atomic_bool closed __attribute__((aligned(RING_LINE)));
+	/** The side creating the ring is the producer. */
+	bool creator_produces;
+} ring_ctl_t;
+
+struct async_ring {
+	ring_ctl_t *ctl;
+	uint8_t *data;
+	size_t capacity;
+	bool producer;
+
+	/** Wait queue the doorbell thread sleeps in. */
+	cap_waitq_handle_t wait_wq;
+	/** Wait queue of the peer's doorbell thread. */
+	cap_waitq_handle_t wake_wq;
+
+	/** Triggered by the doorbell thread and on a hangup. */
+	fibril_event_t event;
+	/** Triggered when the doorbell thread exits. */
+	fibril_event_t exited;
+	atomic_bool stopping;
+
+	/** The peer is gone without closing the ring. */
+	atomic_bool hungup;
+	/** Call held by the accepting side. */
+	ipc_call_t hold_call;
+	/** The held call, as seen by the creating side. */
+	aid_t hold;
+	/** Hangup watch of the accepting side. */
+	async_hangup_watch_t watch;
+	/** The creating side frees the structure when both drop it. */
+	atomic_int refs;
+};
+
+static size_t ring_capacity(size_t area_size)
+{
+	return (size_t) 1 << fnzb(area_size - sizeof(ring_ctl_t));
+}
+
+/** Drop a reference to an endpoint. */
+static void ring_put(async_ring_t *ring)
+{
+	if (atomic_fetch_sub(&ring->refs, 1) == 1)
+		free(ring);
+}
+
+/** Note that the peer is gone and wake up a waiting fibril. */
+static void ring_hangup(void *arg)
+{
+	async_ring_t *ring = arg;
+
+	atomic_store(&ring->hungup, true);
+	fibril_notify(&ring->event);
+}
+
+/** Wait for the answer to the held call on the creating side.
+ *
+ * The answer comes when the peer destroys its endpoint or dies.
+ */
+static errno_t ring_hold_fibril(void *arg)
+{
+	async_ring_t *ring = arg;
+
+	async_wait_for(ring->hold, NULL);
+	ring_hangup(ring);
+	ring_put(ring);
+	return EOK;
+}
+
+/** Check whether the ring was closed or the peer is gone. */
+static bool ring_closed(async_ring_t *ring)
+{
+	return atomic_load(&ring->ctl->closed) || atomic_load(&ring->hungup);
+}
+
+static atomic_bool *ring_own_waiting(async_ring_t *ring)
+{
+	return ring->producer ? &ring->ctl->producer_waiting :
+	    &ring->ctl->consumer_waiting;
+}
+
+static atomic_bool *ring_peer_waiting(async_ring_t *ring)
+{
+	return ring->producer ? &ring->ctl->consumer_waiting :
+	    &ring->ctl->producer_waiting;
+}
+
+/** Wake up the peer if it announced it is going to sleep. */
+static void ring_kick(async_ring_t *ring)
+{
+	atomic_bool *waiting = ring_peer_waiting(ring);
+
+	if (atomic_load(waiting) && atomic_exchange(waiting, false))
+		(void) __SYSCALL1(SYS_WAITQ_WAKEUP, (sysarg_t) ring->wake_wq);
+}
+
+static void ring_doorbell(void *arg)
+{
+	async_ring_t *ring = arg;
+
+	while (true) {
+		errno_t rc = __SYSCALL3(SYS_WAITQ_SLEEP,
+		    (sysarg_t) ring->wait_wq, 0, SYNCH_FLAGS_NONE);
+		if (atomic_load(&ring->stopping))
+			break;
+		if (rc == EINTR)
+			continue;
+		if (rc != EOK)
+			break;
+
+		fibril_notify(&ring->event);
+	}
+
+	fibril_notify(&ring->event);
+	fibril_notify(&ring->exited);
+}
+
+/** Common part of setting up both endpoints. */
+static errno_t ring_start(async_ring_t *ring, void *area, size_t area_size)
+{
+	ring->ctl = area;
+	ring->data = (uint8_t *) area + sizeof(ring_ctl_t);
+	ring->capacity = ring_capacity(area_size);
+	ring->event = FIBRIL_EVENT_INIT;
+	ring->exited = FIBRIL_EVENT_INIT;
+	atomic_init(&ring->stopping, false);
+	atomic_init(&ring->hungup, false);
+
+	/* The doorbell thread notifies fibril events from outside. */
+	fibril_allow_foreign_threads();
+
+	thread_id_t tid;
+	errno_t rc = thread_create(ring_doorbell, ring, "ring doorbell", &tid);
+	if (rc != EOK)
+		return rc;
+
+	thread_detach(tid);
+	return EOK;
+}
+
+/** Create a ring channel and offer the other end over an exchange.
+ *
+ * The peer is expected to call async_ring_accept().
+ *
+ * @param exch     Exchange for sending the messages.
+ * @param size     Requested capacity of the ring in bytes.
+ * @param producer True if the caller is going to write into the ring.
+ * @param rring    Place to store the new ring endpoint.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t async_ring_create(async_exch_t *exch, size_t size, bool producer,
+    async_ring_t **rring)
+{
+	if (exch == NULL)
+		return ENOENT;
+
+	if (size < 2 * RING_RECORD_SIZE(1) || size > SIZE_MAX / 2)
+		return EINVAL;
+
+	/* The capacity is a power of two, make sure it is not smaller. */
+	size = (size_t) 1 << fnzb(2 * size - 1);
+
+	async_ring_t *ring = calloc(1, sizeof(async_ring_t));
+	if (ring == NULL)
+		return ENOMEM;
+
+	size_t area_size = ALIGN_UP(sizeof(ring_ctl_t) + size, PAGE_SIZE);
+	void *area = as_area_create(AS_AREA_ANY, area_size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED) {
+		free(ring);
+		return ENOMEM;
+	}
+
+	ring_ctl_t *ctl = area;
+	atomic_init(&ctl->head, 0);
+	atomic_init(&ctl->consumer_waiting, false);
+	atomic_init(&ctl->tail, 0);
+	atomic_init(&ctl->producer_waiting, false);
+	atomic_init(&ctl->closed, false);
+	ctl->creator_produces = producer;
+	ring->producer = producer;
+
+	errno_t rc = __SYSCALL1(SYS_WAITQ_CREATE, (sysarg_t) &ring->wait_wq);
+	if (rc != EOK)
+		goto error_area;
+
+	rc = __SYSCALL1(SYS_WAITQ_CREATE, (sysarg_t) &ring->wake_wq);
+	if (rc != EOK)
+		goto error_wait;
+
+	rc = async_share_out_start(exch, area, AS_AREA_READ | AS_AREA_WRITE |
+	    AS_AREA_CACHEABLE);
+	if (rc != EOK)
+		goto error_wake;
+
+	/* The peer takes our wait queue first and its own second. */
+	rc = async_waitq_share_start(exch, ring->wait_wq);
+	if (rc != EOK)
+		goto error_wake;
+
+	rc = async_waitq_share_start(exch, ring->wake_wq);
+	if (rc != EOK)
+		goto error_wake;
+
+	fid_t fid = fibril_create(ring_hold_fibril, ring);
+	if (fid == 0) {
+		rc = ENOMEM;
+		goto error_wake;
+	}
+
+	ring->hold = async_send_0(exch, RING_M_HOLD, NULL);
+	if (ring->hold == 0) {
+		rc = ENOMEM;
+		goto error_fibril;
+	}
+
+	rc = ring_start(ring, area, area_size);
+	if (rc != EOK)
+		goto error_hold;
+
+	/* One reference for the caller and one for the hold fibril. */
+	atomic_init(&ring->refs, 2);
+	fibril_add_ready(fid);
+
+	*rring = ring;
+	return EOK;
+
+error_hold:
+	async_forget(ring->hold);
+error_fibril:
+	fibril_destroy(fid);
+error_wake:
+	(void) __SYSCALL1(SYS_WAITQ_DESTROY, (sysarg_t) ring->wake_wq);
+error_wait:
+	(void) __SYSCALL1(SYS_WAITQ_DESTROY, (sysarg_t) ring->wait_wq);
+error_area:
+	as_area_destroy(area);
+	free(ring);
+	return rc;
+}
+
+/** Accept a ring channel offered by async_ring_create().
+ *
+ * Receives the shared area and the two wait queues from the current
+ * connection.
+ *
+ * @param rring Place to store the new ring endpoint.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t async_ring_accept(async_ring_t **rring)
+{
+	ipc_call_t call;
+	size_t area_size;
+	unsigned int flags;
+
+	if (!async_share_out_receive(&call, &area_size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (area_size < sizeof(ring_ctl_t) + 2 * RING_RECORD_SIZE(1) ||
+	    (flags & AS_AREA_WRITE) == 0) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	async_ring_t *ring = calloc(1, sizeof(async_ring_t));
+	if (ring == NULL) {
+		async_answer_0(&call, ENOMEM);
+		return ENOMEM;
+	}
+
+	void *area;
+	errno_t rc = async_share_out_finalize(&call, &area);
+	if (rc != EOK) {
+		free(ring);
+		return rc;
+	}
+
+	if (!async_waitq_share_receive(&call, &ring->wake_wq)) {
+		async_answer_0(&call, EINVAL);
+		rc = EINVAL;
+		goto error_area;
+	}
+
+	rc = async_waitq_share_finalize(&call);
+	if (rc != EOK)
+		goto error_area;
+
+	if (!async_waitq_share_receive(&call, &ring->wait_wq)) {
+		async_answer_0(&call, EINVAL);
+		rc = EINVAL;
+		goto error_wake;
+	}
+
+	rc = async_waitq_share_finalize(&call);
+	if (rc != EOK)
+		goto error_wake;
+
+	if (!async_get_call(&ring->hold_call) ||
+	    ipc_get_imethod(&ring->hold_call) != RING_M_HOLD) {
+		if (ring->hold_call.cap_handle != CAP_NIL)
+			async_answer_0(&ring->hold_call, EINVAL);
+		rc = EINVAL;
+		goto error_wait;
+	}
+
+	ring->producer = !((ring_ctl_t *) area)->creator_produces;
+
+	rc = ring_start(ring, area, area_size);
+	if (rc != EOK)
+		goto error_hold;
+
+	atomic_init(&ring->refs, 1);
+	async_hangup_watch(&ring->watch, ring_hangup, ring);
+
+	*rring = ring;
+	return EOK;
+
+error_hold:
+	async_answer_0(&ring->hold_call, rc);
+error_wait:
+	(void) __SYSCALL1(SYS_WAITQ_DESTROY, (sysarg_t) ring->wait_wq);
+error_wake:
+	(void) __SYSCALL1(SYS_WAITQ_DESTROY, (sysarg_t) ring->wake_wq);
+error_area:
+	as_area_destroy(area);
+	free(ring);
+	return rc;
+}
+
+/** Destroy a ring endpoint.
+ *
+ * The peer sees the ring as closed once it consumes the remaining records.
+ *
+ * @param ring Ring endpoint.
+ */
+void async_ring_destroy(async_ring_t *ring)
+{
+	atomic_store(&ring->ctl->closed, true);
+	ring_kick(ring);
+
+	/* Let the creating side know, even if it does not look at the ring. */
+	if (ring->hold == 0) {
+		async_hangup_unwatch(&ring->watch);
+		async_answer_0(&ring->hold_call, EOK);
+	}
+
+	atomic_store(&ring->stopping, true);
+	(void) __SYSCALL1(SYS_WAITQ_WAKEUP, (sysarg_t) ring->wait_wq);
+	fibril_wait_for(&ring->exited);
+
+	(void) __SYSCALL1(SYS_WAITQ_DESTROY, (sysarg_t) ring->wait_wq);
+	(void) __SYSCALL1(SYS_WAITQ_DESTROY, (sysarg_t) ring->wake_wq);
+	as_area_destroy(ring->ctl);
+	ring->ctl = NULL;
+
+	/*
+	 * On the creating side, the structure lives on until the peer
+	 * answers the held call.
+	 */
+	ring_put(ring);
+}
+
+/** Get the size of the largest record the ring can pass. */
+size_t async_ring_max_size(async_ring_t *ring)
+{
+	/*
+	 * Limiting records to half of the ring guarantees that a record
+	 * always fits into an empty ring, even if it has to wrap around.
+	 */
+	return ALIGN_DOWN(ring->capacity / 2, sizeof(size_t)) - sizeof(size_t);
+}
+
+/** Sleep until the peer changes the ring.
+ *
+ * The caller announces itself as waiting and checks its condition once
+ * more, as the peer might have changed the ring before it noticed.
+ *
+ * @param ring   Ring endpoint.
+ * @param pos    Position written by the peer.
+ * @param seen   Last seen value of @a pos.
+ */
+static void ring_wait(async_ring_t *ring, atomic_size_t *pos, size_t seen)
+{
+	atomic_bool *waiting = ring_own_waiting(ring);
+
+	atomic_store(waiting, true);
+
+	if (atomic_load(pos) == seen && !ring_closed(ring))
+		fibril_wait_for(&ring->event);
+	else
+		atomic_store(waiting, false);
+}
+
+/** Write a record into the ring.
+ *
+ * Waits while there is not enough free space in the ring.
+ *
+ * @param ring Producer endpoint.
+ * @param data Record data.
+ * @param size Record size, at most async_ring_max_size().
+ *
+ * @return EOK on success, ELIMIT if the record is too large, EHANGUP if
+ *         the ring was closed, EIO if the peer corrupted the ring.
+ */
+errno_t async_ring_write(async_ring_t *ring, const void *data, size_t size)
+{
+	assert(ring->producer);
+
+	if (size > async_ring_max_size(ring))
+		return ELIMIT;
+
+	ring_ctl_t *ctl = ring->ctl;
+	size_t rsize = RING_RECORD_SIZE(size);
+	size_t tail = atomic_load_explicit(&ctl->tail, memory_order_relaxed);
+
+	if (tail % sizeof(size_t) != 0)
+		return EIO;
+
+	while (true) {
+		if (ring_closed(ring))
+			return EHANGUP;
+
+		size_t off = tail % ring->capacity;
+		size_t skip = (ring->capacity - off < rsize) ?
+		    ring->capacity - off : 0;
+		size_t head = atomic_load_explicit(&ctl->head,
+		    memory_order_acquire);
+
+		if (tail - head > ring->capacity)
+			return EIO;
+
+		if (tail + skip + rsize - head <= ring->capacity) {
+			if (skip > 0) {
+				*(size_t *) (ring->data + off) = RING_WRAP;
+				off = 0;
+			}
+
+			*(size_t *) (ring->data + off) = size;
+			memcpy(ring->data + off + sizeof(size_t), data, size);
+			atomic_store(&ctl->tail, tail + skip + rsize);
+			ring_kick(ring);
+			return EOK;
+		}
+
+		ring_wait(ring, &ctl->head, head);
+	}
+}
+
+/** Read a record from the ring.
+ *
+ * Waits while the ring is empty.
+ *
+ * @param ring  Consumer endpoint.
+ * @param buf   Buffer for the record data.
+ * @param size  Size of @a buf.
+ * @param nread Place to store the size of the record.
+ *
+ * @return EOK on success, ELIMIT if the next record does not fit into
+ *         @a buf (it is left in the ring), EHANGUP if the ring was closed
+ *         and all records were read, EIO if the peer corrupted the ring.
+ */
+errno_t async_ring_read(async_ring_t *ring, void *buf, size_t size,
+    size_t *nread)
+{
+	assert(!ring->producer);
+
+	ring_ctl_t *ctl = ring->ctl;
+	size_t head = atomic_load_explicit(&ctl->head, memory_order_relaxed);
+
+	if (head % sizeof(size_t) != 0)
+		return EIO;
+
+	while (true) {
+		size_t tail = atomic_load_explicit(&ctl->tail,
+		    memory_order_acquire);
+
+		if (tail == head) {
+			if (ring_closed(ring)) {
+				/* Records written before closing count. */
+				if (atomic_load(&ctl->tail) == head)
+					return EHANGUP;
+				continue;
+			}
+
+			ring_wait(ring, &ctl->tail, head);
+			continue;
+		}
+
+		size_t used = tail - head;
+		if (used > ring->capacity)
+			return EIO;
+
+		size_t off = head % ring->capacity;
+		size_t room = ring->capacity - off;
+		size_t len = atomic_load_explicit((_Atomic size_t *)
+		    (ring->data + off), memory_order_relaxed);
+
+		if (len == RING_WRAP) {
+			if (room > used)
+				return EIO;
+
+			head += room;
+			atomic_store(&ctl->head, head);
+			continue;
+		}
+
+		/* The record must lie within the ring and within the tail. */
+		if (len > room - sizeof(size_t) || RING_RECORD_SIZE(len) > used)
+			return EIO;
+
+		if (len > size)
+			return ELIMIT;
+
+		memcpy(buf, ring->data + off + sizeof(size_t), len);
+		atomic_store(&ctl->head, head + RING_RECORD_SIZE(len));
+		ring_kick(ring);
+
+		*nread = len;
+		return EOK;
+	}
+}
+
+/** Wait until the consumer reads all records written so far.
+ *
+ * @param ring Producer endpoint.
+ *
+ * @return EOK on success, EHANGUP if the ring was closed first.
+ */
+errno_t async_ring_drain(async_ring_t *ring)
+{
+	assert(ring->producer);
+
+	ring_ctl_t *ctl = ring->ctl;
+	size_t tail = atomic_load_explicit(&ctl->tail, memory_order_relaxed);
+
+	while (true) {
+		size_t head = atomic_load_explicit(&ctl->head,
+		    memory_order_acquire);
+		if (head == tail)
+			return EOK;
+
+		if (ring_closed(ring))
+			return EHANGUP;
+
+		ring_wait(ring, &ctl->head, head);
+	}
+}
+
+/** @}
+ */
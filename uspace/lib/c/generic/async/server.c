@@ -122,6 +122,9 @@
 
 #define DPRINTF(...)  ((void) 0)
 
+/** Number of calls hung up in a single vectored submission. */
+#define HANGUP_BATCH  16
+
 /* Client connection data */
 typedef struct {
 	ht_link_t link;
@@ -148,6 +151,9 @@ typedef struct {
 	/** Channel for messages that should be delivered to this fibril. */
 	mpsc_t *msg_channel;
 
+	/** Watches notified when the client hangs up, protected by hangup_mutex. */
+	list_t hangup_watches;
+
 	/** Call data of the opening call. */
 	ipc_call_t call;
 
@@ -188,6 +194,9 @@ typedef struct {
 /** Identifier of the incoming connection handled by the current fibril. */
 static fibril_local connection_t *fibril_connection;
 
+/** Protects the hangup watches of all connections. */
+static FIBRIL_MUTEX_INITIALIZE(hangup_mutex);
+
 static void *default_client_data_constructor(void)
 {
 	return NULL;
@@ -357,21 +366,88 @@ static errno_t connection_fibril(void *arg)
 	mpsc_close(c);
 
 	/*
-	 * Answer all remaining messages with EHANGUP.
+	 * Answer all remaining messages with EHANGUP, several of them
+	 * at once.
 	 */
+	ipc_submit_t hangups[HANGUP_BATCH];
+	size_t count = 0;
 	ipc_call_t call;
-	while (mpsc_receive(c, &call, NULL) == EOK)
-		ipc_answer_0(call.cap_handle, EHANGUP);
+	while (mpsc_receive(c, &call, NULL) == EOK) {
+		hangups[count] = (ipc_submit_t) {
+			.op = IPC_SUBMIT_ANSWER,
+			.handle = call.cap_handle,
+			.args = { EHANGUP }
+		};
+
+		if (++count == HANGUP_BATCH) {
+			(void) ipc_submit(hangups, count);
+			count = 0;
+		}
+	}
+
+	if (count > 0)
+		(void) ipc_submit(hangups, count);
 
 	/*
 	 * Clean up memory.
 	 */
 out:
+	fibril_mutex_lock(&hangup_mutex);
+	list_foreach_safe(fibril_connection->hangup_watches, cur, next) {
+		async_hangup_watch_t *watch = list_get_instance(cur,
+		    async_hangup_watch_t, link);
+		list_remove(&watch->link);
+		watch->conn = NULL;
+	}
+	fibril_mutex_unlock(&hangup_mutex);
+
 	mpsc_destroy(c);
 	free(fibril_connection);
 	return EOK;
 }
 
+/** Watch the connection of the current fibril for a hangup by the client.
+ *
+ * The handler is called once the client hangs up, from the fibril that
+ * routes the calls of the connection. It must not block.
+ *
+ * @param watch    Watch structure, owned by the caller until
+ *                 async_hangup_unwatch() is called.
+ * @param handler  Function called on hangup.
+ * @param arg      Argument of @a handler.
+ */
+void async_hangup_watch(async_hangup_watch_t *watch, void (*handler)(void *),
+    void *arg)
+{
+	assert(fibril_connection);
+
+	link_initialize(&watch->link);
+	watch->handler = handler;
+	watch->arg = arg;
+
+	fibril_mutex_lock(&hangup_mutex);
+	watch->conn = fibril_connection;
+	list_append(&watch->link, &fibril_connection->hangup_watches);
+	fibril_mutex_unlock(&hangup_mutex);
+}
+
+/** Stop watching a connection for a hangup.
+ *
+ * The handler of the watch is not running and will not be called after
+ * this returns.
+ *
+ * @param watch  Watch structure set up by async_hangup_watch().
+ */
+void async_hangup_unwatch(async_hangup_watch_t *watch)
+{
+	fibril_mutex_lock(&hangup_mutex);
+	if (watch->conn != NULL) {
+		list_remove(&watch->link);
+		watch->conn = NULL;
+	}
+	fibril_mutex_unlock(&hangup_mutex);
+}
+
 /** Return label usable during replies to IPC_M_CONNECT_ME_TO. */
 sysarg_t async_get_label(void)
 {
@@ -405,6 +481,7 @@ static fid_t async_new_connection(connection_t *conn, task_id_t in_task_id,
 	conn->msg_channel = mpsc_create(sizeof(ipc_call_t));
 	conn->handler = handler;
 	conn->data = data;
+	list_initialize(&conn->hangup_watches);
 
 	if (!conn->msg_channel)
 		goto error;
@@ -545,6 +622,16 @@ static errno_t route_call(ipc_call_t *call)
 	errno_t rc = mpsc_send(conn->msg_channel, call);
 
 	if (ipc_get_imethod(call) == IPC_M_PHONE_HUNGUP) {
+		/*
+		 * Tell the watchers first, the connection fibril may be
+		 * waiting for something other than the next call.
+		 */
+		fibril_mutex_lock(&hangup_mutex);
+		list_foreach(conn->hangup_watches, link, async_hangup_watch_t,
+		    watch)
+			watch->handler(watch->arg);
+		fibril_mutex_unlock(&hangup_mutex);
+
 		/* Close the channel, but let the connection fibril answer. */
 		mpsc_close(conn->msg_channel);
 		// FIXME: Ideally, we should be able to discard/answer the
@@ -1307,6 +1394,49 @@ errno_t async_share_out_finalize(ipc_call_t *call, void **dst)
 	    (sysarg_t) dst);
 }
 
+/** Wrapper for receiving the IPC_M_WAITQ_SHARE calls using the async framework.
+ *
+ * The wait queue capability is valid only after the call is answered with
+ * async_waitq_share_finalize().
+ *
+ * @param call    Storage for the data of the IPC_M_WAITQ_SHARE call.
+ * @param whandle Storage for the received wait queue capability.
+ *
+ * @return True on success, false on failure.
+ *
+ */
+bool async_waitq_share_receive(ipc_call_t *call, cap_waitq_handle_t *whandle)
+{
+	assert(call);
+	assert(whandle);
+
+	async_get_call(call);
+
+	if (ipc_get_imethod(call) != IPC_M_WAITQ_SHARE)
+		return false;
+
+	*whandle = (cap_waitq_handle_t) ipc_get_arg1(call);
+	return true;
+}
+
+/** Wrapper for answering the IPC_M_WAITQ_SHARE calls using the async framework.
+ *
+ * @param call IPC_M_WAITQ_SHARE call to answer.
+ *
+ * @return  Zero on success or a value from @ref errno.h on failure.
+ *
+ */
+errno_t async_waitq_share_finalize(ipc_call_t *call)
+{
+	assert(call);
+
+	cap_call_handle_t chandle = call->cap_handle;
+	assert(chandle != CAP_NIL);
+	call->cap_handle = CAP_NIL;
+
+	return ipc_answer_0(chandle, EOK);
+}
+
 /** Wrapper for receiving the IPC_M_DATA_READ calls using the async framework.
  *
  * This wrapper only makes it more comfortable to receive IPC_M_DATA_READ
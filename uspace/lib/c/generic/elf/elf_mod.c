@@ -434,10 +434,12 @@ errno_t load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 
 	/*
 	 * For the course of loading, the area needs to be readable
-	 * and writeable.
+	 * and writeable. Text segments are read in completely, so have
+	 * them faulted in at once.
 	 */
 	a = as_area_create((uint8_t *) base + bias, mem_sz,
-	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE |
+	    ((entry->p_flags & PF_X) ? AS_AREA_POPULATE : 0),
 	    AS_AREA_UNPAGED);
 	if (a == AS_MAP_FAILED) {
 		DPRINTF("memory mapping failed (%p, %zu)\n",
@@ -176,6 +176,44 @@ errno_t ipc_wait(ipc_call_t *call, sysarg_t usec, unsigned int flags)
 	return __SYSCALL3(SYS_IPC_WAIT, (sysarg_t) call, usec, flags);
 }
 
+/** Wait for several calls or answers at once.
+ *
+ * Blocks like ipc_wait() until the first call or answer arrives and then
+ * receives up to @a count - 1 more that are already pending.
+ *
+ * @param calls     Array of @a count calls to fill in.
+ * @param count     Maximum number of calls and answers to receive.
+ * @param received  Place to store the number of received calls and answers.
+ * @param usec      Timeout of the wait for the first call or answer.
+ * @param flags     Flags of the wait for the first call or answer.
+ *
+ * @return Zero on success.
+ * @return Value from @ref errno.h if no call or answer was received.
+ *
+ */
+errno_t ipc_wait_multi(ipc_call_t *calls, size_t count, size_t *received,
+    sysarg_t usec, unsigned int flags)
+{
+	return __SYSCALL5(SYS_IPC_WAIT_MULTI, (sysarg_t) calls, count,
+	    (sysarg_t) received, usec, flags);
+}
+
+/** Make and answer several calls in a single system call.
+ *
+ * The outcome of each entry is stored in its rc member.
+ *
+ * @param ops    Array of submission entries.
+ * @param count  Number of entries.
+ *
+ * @return Zero if all entries were processed.
+ * @return Value from @ref errno.h if the array could not be accessed.
+ *
+ */
+errno_t ipc_submit(ipc_submit_t *ops, size_t count)
+{
+	return (errno_t) __SYSCALL2(SYS_IPC_SUBMIT, (sysarg_t) ops, count);
+}
+
 /** Hang up a phone.
  *
  * @param phandle  Handle of the phone to be hung up.
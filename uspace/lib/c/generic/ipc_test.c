@@ -111,6 +111,44 @@ errno_t ipc_test_ping(ipc_test_t *test)
 	return EOK;
 }
 
+/** Several pings in flight at the same time.
+ *
+ * All pings are sent before waiting for the first answer.
+ *
+ * @param test IPC test service
+ * @param count Number of pings, at most IPC_MAX_ASYNC_CALLS
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_ping_pipelined(ipc_test_t *test, size_t count)
+{
+	async_exch_t *exch;
+	aid_t req[IPC_MAX_ASYNC_CALLS];
+	errno_t retval;
+	errno_t rc = EOK;
+	size_t sent;
+
+	if (count > IPC_MAX_ASYNC_CALLS)
+		return EINVAL;
+
+	exch = async_exchange_begin(test->sess);
+	for (sent = 0; sent < count; sent++) {
+		req[sent] = async_send_0(exch, IPC_TEST_PING, NULL);
+		if (req[sent] == 0) {
+			rc = ENOMEM;
+			break;
+		}
+	}
+	async_exchange_end(exch);
+
+	for (size_t i = 0; i < sent; i++) {
+		async_wait_for(req[i], &retval);
+		if (retval != EOK && rc == EOK)
+			rc = retval;
+	}
+
+	return rc;
+}
+
 /** Get size of shared read-only memory area.
  *
  * @param test IPC test service
@@ -220,5 +258,128 @@ errno_t ipc_test_share_in_rw(ipc_test_t *test, size_t size, void **rptr)
 	return EOK;
 }
 
+/** Write data to the IPC test service.
+ *
+ * @param test IPC test service
+ * @param data Data to write
+ * @param size Size of the data
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_write(ipc_test_t *test, const void *data, size_t size)
+{
+	return ipc_test_write_delayed(test, data, size, 0);
+}
+
+/** Write data to the IPC test service which accepts it after a delay.
+ *
+ * @param test IPC test service
+ * @param data Data to write
+ * @param size Size of the data
+ * @param delay Time the service waits before accepting the data
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_write_delayed(ipc_test_t *test, const void *data,
+    size_t size, usec_t delay)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	aid_t req;
+	errno_t rc;
+
+	exch = async_exchange_begin(test->sess);
+	req = async_send_1(exch, IPC_TEST_WRITE, delay, &answer);
+	rc = async_data_write_start(exch, data, size);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	return rc;
+}
+
+/** Read data from the IPC test service.
+ *
+ * @param test IPC test service
+ * @param buf Buffer for the data
+ * @param size Size of the buffer
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_read(ipc_test_t *test, void *buf, size_t size)
+{
+	return ipc_test_read_partial(test, buf, size, 0, 0);
+}
+
+/** Read part of the data from the IPC test service after a delay.
+ *
+ * @param test IPC test service
+ * @param buf Buffer for the data
+ * @param size Size of the buffer
+ * @param part Maximum number of bytes the service sends or zero for no limit
+ * @param delay Time the service waits before sending the data
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_read_partial(ipc_test_t *test, void *buf, size_t size,
+    size_t part, usec_t delay)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	aid_t req;
+	errno_t rc;
+
+	exch = async_exchange_begin(test->sess);
+	req = async_send_2(exch, IPC_TEST_READ, delay, part, &answer);
+	rc = async_data_read_start(exch, buf, size);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	return rc;
+}
+
+/** Create a ring channel to the IPC test service.
+ *
+ * The service consumes and discards everything written into the ring.
+ *
+ * @param test IPC test service
+ * @param size Capacity of the ring in bytes
+ * @param rring Place to store the producer end of the ring
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_ring_create(ipc_test_t *test, size_t size,
+    async_ring_t **rring)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	async_ring_t *ring;
+	aid_t req;
+	errno_t rc;
+
+	exch = async_exchange_begin(test->sess);
+	req = async_send_0(exch, IPC_TEST_RING, &answer);
+	rc = async_ring_create(exch, size, true, &ring);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK) {
+		async_ring_destroy(ring);
+		return rc;
+	}
+
+	*rring = ring;
+	return EOK;
+}
+
 /** @}
  */
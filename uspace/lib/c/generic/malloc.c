@@ -77,6 +77,53 @@
  */
 #define SHRINK_GRANULARITY  (64 * PAGE_SIZE)
 
+/** Heap trim granularity
+ *
+ * Whole pages inside a free block are released
+ * to the kernel once at least this many bytes
+ * have been freed into the block and only if
+ * the pages span at least this many bytes. This
+ * keeps small free blocks from having their pages
+ * discarded and faulted in again all the time.
+ *
+ */
+#define TRIM_GRANULARITY  (16 * PAGE_SIZE)
+
+/** Largest size served from the size class free lists
+ *
+ * Small blocks are allocated in size classes spaced
+ * by BASE_ALIGN. Freed small blocks are not merged
+ * back into the heap, but kept on per-runner caches
+ * and on central free lists of their class.
+ *
+ */
+#define SMALL_MAX  256
+
+/** Number of size classes. */
+#define SIZE_CLASS_COUNT  (SMALL_MAX / BASE_ALIGN)
+
+/** Size class value of blocks not belonging to any class. */
+#define SIZE_CLASS_NONE  0
+
+/** Net size of blocks of a size class. */
+#define SIZE_CLASS_SIZE(cls)  (((size_t) (cls) + 1) * BASE_ALIGN)
+
+/** Maximum number of blocks of one class in a runner cache. */
+#define CACHE_LIMIT  32
+
+/** Number of blocks moved between a runner cache and the central lists. */
+#define CACHE_BATCH  16
+
+/** Maximum number of blocks of one class on the central free list
+ *
+ * Surplus blocks are returned to the heap.
+ *
+ */
+#define CENTRAL_LIMIT  64
+
+/** Smallest size allocated in a dedicated address space area. */
+#define LARGE_MIN  (16 * PAGE_SIZE)
+
 /** Overhead of each heap block. */
 #define STRUCT_OVERHEAD \
 	(sizeof(heap_block_head_t) + sizeof(heap_block_foot_t))
@@ -128,6 +175,13 @@
 	((heap_block_foot_t *) \
 	    (((uintptr_t) (head)) + (head)->size - sizeof(heap_block_foot_t)))
 
+/** Get header of heap block from the address of its data.
+ *
+ */
+#define DATA_HEAD(addr) \
+	((heap_block_head_t *) \
+	    (((uintptr_t) (addr)) - sizeof(heap_block_head_t)))
+
 /** Heap area.
  *
  * The memory managed by the heap allocator is divided into
@@ -153,6 +207,9 @@ typedef struct heap_area {
 	/** Next heap area */
 	struct heap_area *next;
 
+	/** Area holding just a single large block */
+	bool large;
+
 	/** A magic value */
 	uint32_t magic;
 } heap_area_t;
@@ -167,6 +224,15 @@ typedef struct {
 	/* Indication of a free block */
 	bool free;
 
+	/* Size class of a small block plus one, or SIZE_CLASS_NONE */
+	uint8_t size_class;
+
+	/* Indication of a small block on a free list */
+	bool cached;
+
+	/* Bytes freed into a free block since its pages were discarded */
+	uint32_t untrimmed;
+
 	/** Heap area this block belongs to */
 	heap_area_t *area;
 
@@ -191,9 +257,37 @@ static heap_area_t *first_heap_area = NULL;
 /** Last heap area */
 static heap_area_t *last_heap_area = NULL;
 
+/** First area with a large block */
+static heap_area_t *first_large_area = NULL;
+
 /** Next heap block to examine (next fit algorithm) */
 static heap_block_head_t *next_fit = NULL;
 
+/** Free list of small blocks of one size class
+ *
+ * The blocks stay marked as used in the heap, but have the
+ * cached flag set. The first word of the data of each block
+ * links the next block.
+ *
+ */
+typedef struct {
+	void *head;
+	size_t count;
+} class_list_t;
+
+/** Runner cache of small blocks
+ *
+ * Only the fibril currently running on the runner
+ * thread accesses the cache, so it needs no locking.
+ *
+ */
+typedef struct malloc_cache {
+	class_list_t lists[SIZE_CLASS_COUNT];
+} malloc_cache_t;
+
+/** Central free lists of small blocks */
+static class_list_t class_lists[SIZE_CLASS_COUNT];
+
 /** Futex for thread-safe heap manipulation */
 static fibril_rmutex_t malloc_mutex;
 
@@ -237,6 +331,9 @@ static void block_init(void *addr, size_t size, bool free, heap_area_t *area)
 
 	head->size = size;
 	head->free = free;
+	head->size_class = SIZE_CLASS_NONE;
+	head->cached = false;
+	head->untrimmed = 0;
 	head->area = area;
 	head->magic = HEAP_BLOCK_HEAD_MAGIC;
 
@@ -246,6 +343,26 @@ static void block_init(void *addr, size_t size, bool free, heap_area_t *area)
 	foot->magic = HEAP_BLOCK_FOOT_MAGIC;
 }
 
+/** Change the size of a heap block
+ *
+ * Unlike block_init(), the other properties of the block
+ * are kept, so this can be used on used blocks.
+ * Should be called only inside the critical section.
+ *
+ * @param head Header of the block.
+ * @param size New size of the block including the header and the footer.
+ *
+ */
+static void block_resize(heap_block_head_t *head, size_t size)
+{
+	head->size = size;
+
+	heap_block_foot_t *foot = BLOCK_FOOT(head);
+
+	foot->size = size;
+	foot->magic = HEAP_BLOCK_FOOT_MAGIC;
+}
+
 /** Check a heap block
  *
  * Verifies that the structures related to a heap block still contain
@@ -307,6 +424,7 @@ static bool area_create(size_t size)
 	area->end = (void *) ((uintptr_t) astart + asize);
 	area->prev = NULL;
 	area->next = NULL;
+	area->large = false;
 	area->magic = HEAP_AREA_MAGIC;
 
 	void *block = (void *) AREA_FIRST_BLOCK_HEAD(area);
@@ -473,8 +591,7 @@ static void heap_shrink(heap_area_t *area)
 
 					block_check((void *) prev_head);
 
-					block_init(prev_head, prev_head->size + excess,
-					    prev_head->free, area);
+					block_resize(prev_head, prev_head->size + excess);
 				}
 			}
 		}
@@ -523,8 +640,13 @@ static void split_mark(heap_block_head_t *cur, const size_t size)
 	if (cur->size > split_limit) {
 		/* Block big enough -> split. */
 		void *next = ((void *) cur) + size;
+		uint32_t untrimmed = cur->untrimmed;
+
 		block_init(next, cur->size - size, true, cur->area);
 		block_init(cur, size, false, cur->area);
+
+		/* The pages not yet discarded stay with the free part. */
+		((heap_block_head_t *) next)->untrimmed = untrimmed;
 	} else {
 		/* Block too small -> use as is. */
 		cur->free = false;
@@ -604,6 +726,7 @@ static void *malloc_area(heap_area_t *area, heap_block_head_t *first_block,
 
 						size_t reduced_size = cur->size - excess;
 						heap_block_head_t *next_head = ((void *) cur) + excess;
+						uint32_t untrimmed = cur->untrimmed;
 
 						if ((!prev_head->free) &&
 						    (excess >= STRUCT_OVERHEAD)) {
@@ -622,11 +745,11 @@ static void *malloc_area(heap_area_t *area, heap_block_head_t *first_block,
 							 * excess is small. Therefore just enlarge
 							 * the previous block.
 							 */
-							block_init(prev_head, prev_head->size + excess,
-							    prev_head->free, area);
+							block_resize(prev_head, prev_head->size + excess);
 						}
 
 						block_init(next_head, reduced_size, true, area);
+						next_head->untrimmed = untrimmed;
 						split_mark(next_head, real_size);
 
 						next_fit = next_head;
@@ -647,12 +770,14 @@ static void *malloc_area(heap_area_t *area, heap_block_head_t *first_block,
 						/* Check for current block size again */
 						if (cur->size >= real_size + excess) {
 							size_t reduced_size = cur->size - excess;
+							uint32_t untrimmed = cur->untrimmed;
 							cur = (heap_block_head_t *)
 							    (AREA_FIRST_BLOCK_HEAD(area) + excess);
 
 							block_init((void *) AREA_FIRST_BLOCK_HEAD(area),
 							    excess, true, area);
 							block_init(cur, reduced_size, true, area);
+							cur->untrimmed = untrimmed;
 							split_mark(cur, real_size);
 
 							next_fit = cur;
@@ -772,6 +897,445 @@ static void *malloc_internal(const size_t size, const size_t align)
 	return heap_grow_and_alloc(gross_size, falign);
 }
 
+/** Release whole pages of a free block to the kernel
+ *
+ * Should be called only inside the critical section.
+ * The header and the footer of the block are kept,
+ * only the pages in between are discarded.
+ *
+ * @param head Header of the free block.
+ *
+ */
+static void block_trim(heap_block_head_t *head)
+{
+	uintptr_t start = ALIGN_UP((uintptr_t) head +
+	    sizeof(heap_block_head_t), PAGE_SIZE);
+	uintptr_t end = ALIGN_DOWN((uintptr_t) BLOCK_FOOT(head), PAGE_SIZE);
+
+	if ((end > start) && (end - start >= TRIM_GRANULARITY))
+		(void) as_area_discard((void *) start, end - start);
+
+	head->untrimmed = 0;
+}
+
+/** Return a heap block to the heap
+ *
+ * Should be called only inside the critical section.
+ *
+ * @param head Header of the block.
+ *
+ */
+static void block_free(heap_block_head_t *head)
+{
+	block_check(head);
+	malloc_assert(!head->free);
+
+	heap_area_t *area = head->area;
+
+	area_check(area);
+	malloc_assert((void *) head >= (void *) AREA_FIRST_BLOCK_HEAD(area));
+	malloc_assert((void *) head < area->end);
+
+	/*
+	 * Count the bytes freed into the resulting free block, so that
+	 * its pages can be discarded without looking at the rest of
+	 * the heap.
+	 */
+	size_t untrimmed = head->size;
+
+	/* Mark the block itself as free. */
+	head->free = true;
+	head->size_class = SIZE_CLASS_NONE;
+
+	/* Look at the next block. If it is free, merge the two. */
+	heap_block_head_t *next_head =
+	    (heap_block_head_t *) (((void *) head) + head->size);
+
+	if ((void *) next_head < area->end) {
+		block_check(next_head);
+		if (next_head->free) {
+			untrimmed += next_head->untrimmed;
+			block_init(head, head->size + next_head->size, true, area);
+		}
+	}
+
+	/* Look at the previous block. If it is free, merge the two. */
+	if ((void *) head > (void *) AREA_FIRST_BLOCK_HEAD(area)) {
+		heap_block_foot_t *prev_foot =
+		    (heap_block_foot_t *) (((void *) head) - sizeof(heap_block_foot_t));
+
+		heap_block_head_t *prev_head =
+		    (heap_block_head_t *) (((void *) head) - prev_foot->size);
+
+		block_check(prev_head);
+
+		if (prev_head->free) {
+			untrimmed += prev_head->untrimmed;
+			block_init(prev_head, prev_head->size + head->size, true,
+			    area);
+			head = prev_head;
+		}
+	}
+
+	head->untrimmed = min(untrimmed, UINT32_MAX);
+
+	/* A free block at the end of the area is left to heap_shrink(). */
+	if ((head->untrimmed >= TRIM_GRANULARITY) &&
+	    ((void *) head + head->size < area->end))
+		block_trim(head);
+
+	heap_shrink(area);
+}
+
+/** Get the size class of a small block
+ *
+ * @param size Net size of the block (at most SMALL_MAX).
+ *
+ * @return Index of the size class.
+ *
+ */
+static inline unsigned int size_class(size_t size)
+{
+	return (size == 0) ? 0 : (size - 1) / BASE_ALIGN;
+}
+
+static void class_list_push(class_list_t *list, void *addr)
+{
+	*((void **) addr) = list->head;
+	list->head = addr;
+	list->count++;
+}
+
+static void *class_list_pop(class_list_t *list)
+{
+	void *addr = list->head;
+
+	if (addr != NULL) {
+		list->head = *((void **) addr);
+		list->count--;
+	}
+
+	return addr;
+}
+
+/** Get the cache of the current runner thread
+ *
+ * The cache is allocated on first use.
+ *
+ * @return Cache of the current runner or NULL if the thread
+ *         is not a runner or the cache cannot be allocated.
+ *
+ */
+static malloc_cache_t *cache_get(void)
+{
+	malloc_cache_t **slot = fibril_malloc_cache();
+	if (slot == NULL)
+		return NULL;
+
+	if (*slot == NULL) {
+		heap_lock();
+		malloc_cache_t *cache =
+		    malloc_internal(sizeof(malloc_cache_t), BASE_ALIGN);
+		heap_unlock();
+
+		if (cache != NULL) {
+			memset(cache, 0, sizeof(malloc_cache_t));
+			*slot = cache;
+		}
+	}
+
+	return *slot;
+}
+
+/** Allocate a small block from the central free lists
+ *
+ * Should be called only inside the critical section.
+ * If the free list of the class is empty, a new block
+ * is allocated from the heap.
+ *
+ * @param cls Size class of the block.
+ *
+ * @return Address of the allocated block or NULL on not enough memory.
+ *
+ */
+static void *class_alloc_central(unsigned int cls)
+{
+	void *addr = class_list_pop(&class_lists[cls]);
+	if (addr != NULL)
+		return addr;
+
+	addr = malloc_internal(SIZE_CLASS_SIZE(cls), BASE_ALIGN);
+	if (addr != NULL)
+		DATA_HEAD(addr)->size_class = cls + 1;
+
+	return addr;
+}
+
+/** Put a small block on the central free lists
+ *
+ * Should be called only inside the critical section.
+ * Blocks in excess of CENTRAL_LIMIT are returned to the heap.
+ *
+ * @param cls  Size class of the block.
+ * @param addr Address of the block.
+ *
+ */
+static void class_free_central(unsigned int cls, void *addr)
+{
+	class_list_t *list = &class_lists[cls];
+
+	class_list_push(list, addr);
+
+	while (list->count > CENTRAL_LIMIT) {
+		heap_block_head_t *head = DATA_HEAD(class_list_pop(list));
+
+		head->cached = false;
+		block_free(head);
+	}
+}
+
+/** Allocate a small block
+ *
+ * The block is taken from the cache of the current runner.
+ * An empty cache is refilled from the central free lists
+ * by a batch of blocks at once.
+ *
+ * @param size Number of bytes to allocate (at most SMALL_MAX).
+ *
+ * @return Allocated memory or NULL.
+ *
+ */
+static void *class_alloc(size_t size)
+{
+	unsigned int cls = size_class(size);
+	malloc_cache_t *cache = cache_get();
+
+	if (cache == NULL) {
+		heap_lock();
+		void *addr = class_alloc_central(cls);
+		heap_unlock();
+
+		if (addr != NULL)
+			DATA_HEAD(addr)->cached = false;
+
+		return addr;
+	}
+
+	class_list_t *list = &cache->lists[cls];
+
+	if (list->head == NULL) {
+		heap_lock();
+
+		for (unsigned int i = 0; i < CACHE_BATCH; i++) {
+			void *addr = class_alloc_central(cls);
+			if (addr == NULL)
+				break;
+
+			class_list_push(list, addr);
+		}
+
+		heap_unlock();
+	}
+
+	void *addr = class_list_pop(list);
+	if (addr != NULL)
+		DATA_HEAD(addr)->cached = false;
+
+	return addr;
+}
+
+/** Free a small block
+ *
+ * The block is put into the cache of the current runner.
+ * An overfull cache returns a batch of blocks to the central
+ * free lists at once.
+ *
+ * @param head Header of the block.
+ *
+ */
+static void class_free(heap_block_head_t *head)
+{
+	unsigned int cls = head->size_class - 1;
+	void *addr = ((void *) head) + sizeof(heap_block_head_t);
+	malloc_cache_t *cache = cache_get();
+
+	malloc_assert(cls < SIZE_CLASS_COUNT);
+
+	/* Catch double free, the cache is not checked otherwise. */
+	malloc_assert(!head->cached);
+	head->cached = true;
+
+	if (cache == NULL) {
+		heap_lock();
+		block_check(head);
+		class_free_central(cls, addr);
+		heap_unlock();
+
+		return;
+	}
+
+	class_list_t *list = &cache->lists[cls];
+
+	class_list_push(list, addr);
+
+	if (list->count > CACHE_LIMIT) {
+		heap_lock();
+
+		for (unsigned int i = 0; i < CACHE_BATCH; i++) {
+			addr = class_list_pop(list);
+			block_check(DATA_HEAD(addr));
+			class_free_central(cls, addr);
+		}
+
+		heap_unlock();
+	}
+}
+
+/** Release the cache of a runner thread that exits
+ *
+ * The cached blocks are put on the central free lists
+ * and the cache itself is returned to the heap.
+ *
+ * @param cache Cache of the runner.
+ *
+ */
+void __malloc_cache_fini(malloc_cache_t *cache)
+{
+	heap_lock();
+
+	for (unsigned int cls = 0; cls < SIZE_CLASS_COUNT; cls++) {
+		void *addr;
+
+		while ((addr = class_list_pop(&cache->lists[cls])) != NULL) {
+			block_check(DATA_HEAD(addr));
+			class_free_central(cls, addr);
+		}
+	}
+
+	block_free(DATA_HEAD(cache));
+
+	heap_unlock();
+}
+
+/** Calculate the size of an area holding a single large block
+ *
+ * @param size Number of bytes of the block.
+ *
+ * @return Page-aligned size of the area or 0 on overflow.
+ *
+ */
+static size_t large_area_size(size_t size)
+{
+	size_t offset = AREA_FIRST_BLOCK_HEAD(0);
+	size_t asize = ALIGN_UP(offset + GROSS_SIZE(size), PAGE_SIZE);
+
+	/* Check for integer overflow. */
+	if (asize < size)
+		return 0;
+
+	return asize;
+}
+
+/** Allocate a large block
+ *
+ * Each large block is allocated in a dedicated address
+ * space area, which is destroyed when the block is freed.
+ *
+ * @param size Number of bytes to allocate.
+ *
+ * @return Allocated memory or NULL.
+ *
+ */
+static void *large_alloc(size_t size)
+{
+	size_t asize = large_area_size(size);
+	if (asize == 0)
+		return NULL;
+
+	void *astart = as_area_create(AS_AREA_ANY, asize,
+	    AS_AREA_WRITE | AS_AREA_READ | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (astart == AS_MAP_FAILED)
+		return NULL;
+
+	heap_area_t *area = (heap_area_t *) astart;
+
+	area->start = astart;
+	area->end = (void *) ((uintptr_t) astart + asize);
+	area->prev = NULL;
+	area->large = true;
+	area->magic = HEAP_AREA_MAGIC;
+
+	void *block = (void *) AREA_FIRST_BLOCK_HEAD(area);
+	block_init(block, (size_t) (area->end - block), false, area);
+
+	heap_lock();
+
+	area->next = first_large_area;
+	if (first_large_area != NULL)
+		first_large_area->prev = area;
+	first_large_area = area;
+
+	heap_unlock();
+
+	return block + sizeof(heap_block_head_t);
+}
+
+/** Free a large block
+ *
+ * @param head Header of the block.
+ *
+ */
+static void large_free(heap_block_head_t *head)
+{
+	heap_area_t *area = head->area;
+
+	heap_lock();
+
+	block_check(head);
+	area_check(area);
+
+	if (area->prev != NULL)
+		area->prev->next = area->next;
+	else
+		first_large_area = area->next;
+
+	if (area->next != NULL)
+		area->next->prev = area->prev;
+
+	heap_unlock();
+
+	as_area_destroy(area->start);
+}
+
+/** Resize a large block in place
+ *
+ * @param head Header of the block.
+ * @param size New number of bytes of the block.
+ *
+ * @return True if successful.
+ *
+ */
+static bool large_resize(heap_block_head_t *head, size_t size)
+{
+	heap_area_t *area = head->area;
+
+	size_t asize = large_area_size(size);
+	if (asize == 0)
+		return false;
+
+	if (as_area_resize(area->start, asize, 0) != EOK)
+		return false;
+
+	heap_lock();
+
+	area->end = (void *) ((uintptr_t) area->start + asize);
+	block_resize(head, (size_t) (area->end - (void *) head));
+
+	heap_unlock();
+
+	return true;
+}
+
 /** Allocate memory by number of elements
  *
  * @param nmemb Number of members to allocate.
@@ -801,6 +1365,12 @@ void *calloc(const size_t nmemb, const size_t size)
  */
 void *malloc(const size_t size)
 {
+	if (size <= SMALL_MAX)
+		return class_alloc(size);
+
+	if (size >= LARGE_MIN)
+		return large_alloc(size);
+
 	heap_lock();
 	void *block = malloc_internal(size, BASE_ALIGN);
 	heap_unlock();
@@ -824,6 +1394,10 @@ void *memalign(const size_t align, const size_t size)
 	size_t palign =
 	    1 << (fnzb(max(sizeof(void *), align) - 1) + 1);
 
+	/* Base alignment is provided by all blocks. */
+	if (palign <= BASE_ALIGN)
+		return malloc(size);
+
 	heap_lock();
 	void *block = malloc_internal(size, palign);
 	heap_unlock();
@@ -849,11 +1423,40 @@ void *realloc(void *const addr, const size_t size)
 	if (addr == NULL)
 		return malloc(size);
 
-	heap_lock();
-
 	/* Calculate the position of the header. */
-	heap_block_head_t *head =
-	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
+	heap_block_head_t *head = DATA_HEAD(addr);
+
+	malloc_assert(head->magic == HEAP_BLOCK_HEAD_MAGIC);
+
+	if (head->size_class != SIZE_CLASS_NONE) {
+		/* Small blocks are never resized, just moved. */
+		size_t class_size = SIZE_CLASS_SIZE(head->size_class - 1);
+		if (size <= class_size)
+			return addr;
+
+		void *ptr = malloc(size);
+		if (ptr != NULL) {
+			memcpy(ptr, addr, class_size);
+			class_free(head);
+		}
+
+		return ptr;
+	}
+
+	if (head->area->large) {
+		if ((size >= LARGE_MIN) && (large_resize(head, size)))
+			return addr;
+
+		void *ptr = malloc(size);
+		if (ptr != NULL) {
+			memcpy(ptr, addr, min(NET_SIZE(head->size), size));
+			large_free(head);
+		}
+
+		return ptr;
+	}
+
+	heap_lock();
 
 	block_check(head);
 	malloc_assert(!head->free);
@@ -876,9 +1479,11 @@ void *realloc(void *const addr, const size_t size)
 			 * Split the original block to a full block
 			 * and a trailing free block.
 			 */
+			heap_block_head_t *tail = (void *) head + real_size;
+
 			block_init((void *) head, real_size, false, area);
-			block_init((void *) head + real_size,
-			    orig_size - real_size, true, area);
+			block_init(tail, orig_size - real_size, true, area);
+			tail->untrimmed = min(orig_size - real_size, UINT32_MAX);
 			heap_shrink(area);
 		}
 
@@ -958,52 +1563,97 @@ void free(void *const addr)
 	if (addr == NULL)
 		return;
 
-	heap_lock();
-
 	/* Calculate the position of the header. */
-	heap_block_head_t *head =
-	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
+	heap_block_head_t *head = DATA_HEAD(addr);
 
-	block_check(head);
-	malloc_assert(!head->free);
-
-	heap_area_t *area = head->area;
+	malloc_assert(head->magic == HEAP_BLOCK_HEAD_MAGIC);
 
-	area_check(area);
-	malloc_assert((void *) head >= (void *) AREA_FIRST_BLOCK_HEAD(area));
-	malloc_assert((void *) head < area->end);
+	if (head->size_class != SIZE_CLASS_NONE) {
+		class_free(head);
+		return;
+	}
 
-	/* Mark the block itself as free. */
-	head->free = true;
+	if (head->area->large) {
+		large_free(head);
+		return;
+	}
 
-	/* Look at the next block. If it is free, merge the two. */
-	heap_block_head_t *next_head =
-	    (heap_block_head_t *) (((void *) head) + head->size);
+	heap_lock();
+	block_free(head);
+	heap_unlock();
+}
 
-	if ((void *) next_head < area->end) {
-		block_check(next_head);
-		if (next_head->free)
-			block_init(head, head->size + next_head->size, true, area);
+/** Check consistency of a heap area and its blocks
+ *
+ * Should be called only inside the critical section.
+ *
+ * @param area Heap area to check.
+ *
+ * @return NULL if consistent or address of the first problem found.
+ *
+ */
+static void *heap_area_check(heap_area_t *area)
+{
+	/* Check heap area consistency */
+	if ((area->magic != HEAP_AREA_MAGIC) ||
+	    ((void *) area != area->start) ||
+	    (area->start >= area->end) ||
+	    (((uintptr_t) area->start % PAGE_SIZE) != 0) ||
+	    (((uintptr_t) area->end % PAGE_SIZE) != 0))
+		return (void *) area;
+
+	/* Walk all heap blocks */
+	for (heap_block_head_t *head = (heap_block_head_t *)
+	    AREA_FIRST_BLOCK_HEAD(area); (void *) head < area->end;
+	    head = (heap_block_head_t *) (((void *) head) + head->size)) {
+
+		/* Check heap block consistency */
+		if (head->magic != HEAP_BLOCK_HEAD_MAGIC)
+			return (void *) head;
+
+		heap_block_foot_t *foot = BLOCK_FOOT(head);
+
+		if ((foot->magic != HEAP_BLOCK_FOOT_MAGIC) ||
+		    (head->size != foot->size))
+			return (void *) foot;
+
+		/* Only used small blocks can be on the free lists */
+		if ((head->cached) &&
+		    ((head->free) || (head->size_class == SIZE_CLASS_NONE)))
+			return (void *) head;
 	}
 
-	/* Look at the previous block. If it is free, merge the two. */
-	if ((void *) head > (void *) AREA_FIRST_BLOCK_HEAD(area)) {
-		heap_block_foot_t *prev_foot =
-		    (heap_block_foot_t *) (((void *) head) - sizeof(heap_block_foot_t));
+	return NULL;
+}
 
-		heap_block_head_t *prev_head =
-		    (heap_block_head_t *) (((void *) head) - prev_foot->size);
+/** Check consistency of the central free lists of small blocks
+ *
+ * Should be called only inside the critical section.
+ *
+ * @return NULL if consistent or address of the first problem found.
+ *
+ */
+static void *class_lists_check(void)
+{
+	for (unsigned int cls = 0; cls < SIZE_CLASS_COUNT; cls++) {
+		size_t count = 0;
 
-		block_check(prev_head);
+		for (void *addr = class_lists[cls].head; addr != NULL;
+		    addr = *((void **) addr)) {
+			heap_block_head_t *head = DATA_HEAD(addr);
 
-		if (prev_head->free)
-			block_init(prev_head, prev_head->size + head->size, true,
-			    area);
-	}
+			if ((head->magic != HEAP_BLOCK_HEAD_MAGIC) ||
+			    (!head->cached) || (head->size_class != cls + 1))
+				return (void *) head;
 
-	heap_shrink(area);
+			count++;
+		}
 
-	heap_unlock();
+		if (count != class_lists[cls].count)
+			return (void *) &class_lists[cls];
+	}
+
+	return NULL;
 }
 
 void *heap_check(void)
@@ -1015,44 +1665,27 @@ void *heap_check(void)
 		return (void *) -1;
 	}
 
-	/* Walk all heap areas */
-	for (heap_area_t *area = first_heap_area; area != NULL;
-	    area = area->next) {
-
-		/* Check heap area consistency */
-		if ((area->magic != HEAP_AREA_MAGIC) ||
-		    ((void *) area != area->start) ||
-		    (area->start >= area->end) ||
-		    (((uintptr_t) area->start % PAGE_SIZE) != 0) ||
-		    (((uintptr_t) area->end % PAGE_SIZE) != 0)) {
-			heap_unlock();
-			return (void *) area;
-		}
+	void *prob = NULL;
 
-		/* Walk all heap blocks */
-		for (heap_block_head_t *head = (heap_block_head_t *)
-		    AREA_FIRST_BLOCK_HEAD(area); (void *) head < area->end;
-		    head = (heap_block_head_t *) (((void *) head) + head->size)) {
-
-			/* Check heap block consistency */
-			if (head->magic != HEAP_BLOCK_HEAD_MAGIC) {
-				heap_unlock();
-				return (void *) head;
-			}
+	/*
+	 * Walk all heap areas. Small blocks on the free lists
+	 * stay marked as used, so they are checked as well.
+	 */
+	for (heap_area_t *area = first_heap_area;
+	    (area != NULL) && (prob == NULL); area = area->next)
+		prob = heap_area_check(area);
 
-			heap_block_foot_t *foot = BLOCK_FOOT(head);
+	/* Walk all areas with large blocks */
+	for (heap_area_t *area = first_large_area;
+	    (area != NULL) && (prob == NULL); area = area->next)
+		prob = heap_area_check(area);
 
-			if ((foot->magic != HEAP_BLOCK_FOOT_MAGIC) ||
-			    (head->size != foot->size)) {
-				heap_unlock();
-				return (void *) foot;
-			}
-		}
-	}
+	if (prob == NULL)
+		prob = class_lists_check();
 
 	heap_unlock();
 
-	return NULL;
+	return prob;
 }
 
 /** @}
@@ -106,6 +106,20 @@ extern async_port_handler_t async_get_port_handler(iface_t, port_id_t, void **);
 
 extern void async_reply_received(ipc_call_t *);
 
+/** Watch for a hangup of the connection handled by a fibril. */
+typedef struct {
+	/** Member of the list of watches of the connection. */
+	link_t link;
+	/** Watched connection or NULL once it is gone. */
+	void *conn;
+	void (*handler)(void *);
+	void *arg;
+} async_hangup_watch_t;
+
+extern void async_hangup_watch(async_hangup_watch_t *, void (*)(void *),
+    void *);
+extern void async_hangup_unwatch(async_hangup_watch_t *);
+
 #endif
 
 /** @}
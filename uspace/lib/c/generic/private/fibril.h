@@ -61,6 +61,8 @@ struct fibril {
 	errno_t retval;
 
 	fibril_t *thread_ctx;
+	/* Runner whose helper fibril this is, if any. */
+	struct fibril_runner *runner;
 
 	bool is_running : 1;
 	bool is_writer : 1;
@@ -76,7 +78,9 @@ struct fibril {
 extern fibril_t *fibril_alloc(void);
 extern void fibril_setup(fibril_t *);
 extern void fibril_teardown(fibril_t *f);
+extern void fibril_thread_teardown(void);
 extern fibril_t *fibril_self(void);
+extern struct malloc_cache **fibril_malloc_cache(void);
 
 extern void __fibrils_init(void);
 extern void __fibrils_fini(void);
@@ -84,6 +88,7 @@ extern void __fibrils_fini(void);
 extern void fibril_wait_for(fibril_event_t *);
 extern errno_t fibril_wait_timeout(fibril_event_t *, const struct timespec *);
 extern void fibril_notify(fibril_event_t *);
+extern void fibril_allow_foreign_threads(void);
 
 extern errno_t fibril_ipc_wait(ipc_call_t *, const struct timespec *);
 extern void fibril_ipc_poke(void);
@@ -38,6 +38,9 @@
 extern void __malloc_init(void);
 extern void __malloc_fini(void);
 
+struct malloc_cache;
+extern void __malloc_cache_fini(struct malloc_cache *);
+
 #endif
 
 /** @}
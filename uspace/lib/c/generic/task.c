@@ -91,6 +91,23 @@ errno_t task_kill(task_id_t task_id)
 	return (errno_t) __SYSCALL1(SYS_TASK_KILL, (sysarg_t) &task_id);
 }
 
+/** Set CPU affinity of the current task.
+ *
+ * The affinity applies to all threads of the task and is inherited by
+ * threads and tasks created later.
+ *
+ * @param mask CPU mask. The bit (i % 8) of the byte (i / 8) allows
+ *             the CPU with ID i.
+ * @param size Size of the mask in bytes. Zero removes any restriction.
+ *
+ * @return Zero on success or an error code.
+ */
+errno_t task_set_affinity(const uint8_t *mask, size_t size)
+{
+	return (errno_t) __SYSCALL2(SYS_TASK_SET_AFFINITY, (sysarg_t) mask,
+	    (sysarg_t) size);
+}
+
 /** Create a new task by running an executable from the filesystem.
  *
  * This is really just a convenience wrapper over the more complicated
@@ -35,6 +35,7 @@
  */
 
 #include <adt/list.h>
+#include <adt/odict.h>
 #include <fibril.h>
 #include <stack.h>
 #include <tls.h>
@@ -52,13 +53,19 @@
 #include "../private/futex.h"
 #include "../private/fibril.h"
 #include "../private/libc.h"
+#include "../private/malloc.h"
 
 #define DPRINTF(...) ((void)0)
+
+/** Maximum number of calls received by one IPC wait. */
+#define IPC_WAIT_BATCH  8
+/** Number of threads that can receive a batch of calls at the same time. */
+#define IPC_BATCH_COUNT  4
 #undef READY_DEBUG
 
-/** Member of timeout_list. */
+/** Member of timeout_dict. */
 typedef struct {
-	link_t link;
+	odlink_t link;
 	struct timespec expires;
 	fibril_event_t *event;
 } _timeout_t;
@@ -76,6 +83,23 @@ typedef struct {
 	ipc_call_t call;
 } _ipc_buffer_t;
 
+/** Receive buffer of one multi-call IPC wait. */
+typedef struct {
+	link_t link;
+	ipc_call_t calls[IPC_WAIT_BATCH];
+} _ipc_batch_t;
+
+/** Runner thread with its local list of ready fibrils. */
+typedef struct fibril_runner {
+	/** Member of runner_list. */
+	link_t link;
+	/** Protects ready_list. */
+	futex_t futex;
+	list_t ready_list;
+	/** Cache of small heap blocks, allocated by malloc on first use. */
+	struct malloc_cache *malloc_cache;
+} _runner_t;
+
 typedef enum {
 	SWITCH_FROM_DEAD,
 	SWITCH_FROM_HELPER,
@@ -84,20 +108,27 @@ typedef enum {
 } _switch_type_t;
 
 static bool multithreaded = false;
+static atomic_int runner_count = 1;
 
 /* This futex serializes access to global data. */
 static futex_t fibril_futex;
 static futex_t ready_semaphore;
 static long ready_st_count;
 
+/* Protects ready_list and runner_list, locked before the futex of a runner. */
+static futex_t runner_futex;
+/* Ready fibrils not pushed by any runner. */
 static LIST_INITIALIZE(ready_list);
+static LIST_INITIALIZE(runner_list);
 static LIST_INITIALIZE(fibril_list);
-static LIST_INITIALIZE(timeout_list);
+/* Pending timeouts ordered by expiration time. */
+static odict_t timeout_dict;
 
 static futex_t ipc_lists_futex;
 static LIST_INITIALIZE(ipc_waiter_list);
 static LIST_INITIALIZE(ipc_buffer_list);
 static LIST_INITIALIZE(ipc_buffer_free_list);
+static LIST_INITIALIZE(ipc_batch_free_list);
 
 /* Only used as unique markers for triggered events. */
 static fibril_t _fibril_event_triggered;
@@ -112,6 +143,8 @@ static inline void _ready_debug_check(void)
 	assert(!multithreaded);
 	long count = (long) list_count(&ready_list) +
 	    (long) list_count(&ipc_buffer_free_list);
+	list_foreach(runner_list, link, _runner_t, r)
+		count += (long) list_count(&r->ready_list);
 	assert(ready_st_count == count);
 #endif
 }
@@ -136,8 +169,80 @@ static inline errno_t _ready_down(const struct timespec *expires)
 	return EOK;
 }
 
+/** Take up to @a max more tokens from ready_semaphore, without blocking. */
+static size_t _ready_down_extra(size_t max)
+{
+	size_t n = 0;
+
+	if (multithreaded) {
+		/* Avoid the system call of a failed futex_trydown(). */
+		while (n < max && atomic_load_explicit(&ready_semaphore.val,
+		    memory_order_relaxed) > 0 && futex_trydown(&ready_semaphore))
+			n++;
+	} else {
+		while (n < max && ready_st_count > 0) {
+			ready_st_count--;
+			n++;
+		}
+	}
+
+	return n;
+}
+
 static atomic_int threads_in_ipc_wait;
 
+/** Get the runner of the current thread, if it has a ready list already. */
+static _runner_t *_runner_self(void)
+{
+	fibril_t *ctx = fibril_self()->thread_ctx;
+	return ctx ? ctx->runner : NULL;
+}
+
+/**
+ * Take a ready fibril. The current runner's own list is tried first, then
+ * the list of fibrils pushed by no runner, and finally the lists of other
+ * runners.
+ */
+static fibril_t *_ready_list_take(void)
+{
+	_runner_t *self = _runner_self();
+	fibril_t *f;
+
+	if (self) {
+		futex_lock(&self->futex);
+		f = list_pop(&self->ready_list, fibril_t, link);
+		futex_unlock(&self->futex);
+		if (f)
+			return f;
+	}
+
+	futex_lock(&runner_futex);
+
+	f = list_pop(&ready_list, fibril_t, link);
+	if (f) {
+		futex_unlock(&runner_futex);
+		return f;
+	}
+
+	list_foreach(runner_list, link, _runner_t, r) {
+		if (r == self)
+			continue;
+
+		futex_lock(&r->futex);
+		f = list_pop(&r->ready_list, fibril_t, link);
+		futex_unlock(&r->futex);
+		if (f) {
+			/* Move the victim to the end to spread the stealing. */
+			list_remove(&r->link);
+			list_append(&r->link, &runner_list);
+			break;
+		}
+	}
+
+	futex_unlock(&runner_futex);
+	return f;
+}
+
 /** Function that spans the whole life-cycle of a fibril.
  *
  * Each fibril begins execution in this function. Then the function implementing
@@ -237,24 +342,30 @@ static fibril_t *_fibril_trigger_internal(fibril_event_t *event, fibril_t *reaso
 	return f;
 }
 
-static errno_t _ipc_wait(ipc_call_t *call, const struct timespec *expires)
+static errno_t _ipc_wait(ipc_call_t *calls, size_t count, size_t *received,
+    const struct timespec *expires)
 {
 	if (!expires)
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NONE);
+		return ipc_wait_multi(calls, count, received, SYNCH_NO_TIMEOUT,
+		    SYNCH_FLAGS_NONE);
 
 	if (expires->tv_sec == 0)
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NON_BLOCKING);
+		return ipc_wait_multi(calls, count, received, SYNCH_NO_TIMEOUT,
+		    SYNCH_FLAGS_NON_BLOCKING);
 
 	struct timespec now;
 	getuptime(&now);
 
 	if (ts_gteq(&now, expires))
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NON_BLOCKING);
+		return ipc_wait_multi(calls, count, received, SYNCH_NO_TIMEOUT,
+		    SYNCH_FLAGS_NON_BLOCKING);
 
-	return ipc_wait(call, NSEC2USEC(ts_sub_diff(expires, &now)),
-	    SYNCH_FLAGS_NONE);
+	return ipc_wait_multi(calls, count, received,
+	    NSEC2USEC(ts_sub_diff(expires, &now)), SYNCH_FLAGS_NONE);
 }
 
+static void _ready_list_push(fibril_t *);
+
 /*
  * Waits until a ready fibril is added to the list, or an IPC message arrives.
  * Returns NULL on timeout and may also return NULL if returning from IPC
@@ -282,14 +393,29 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 	 * for each entry of the call buffer.
 	 */
 
-	if (!locked)
-		futex_lock(&fibril_futex);
-	fibril_t *f = list_pop(&ready_list, fibril_t, link);
-	if (!f)
+	/*
+	 * The ready lists have locks of their own. A fibril found there has
+	 * its context saved already, because the fibril_futex is held until
+	 * the switch away from it is complete.
+	 */
+	fibril_t *f = _ready_list_take();
+	size_t tokens = 1;
+	_ipc_batch_t *batch = NULL;
+	if (!f) {
 		atomic_fetch_add_explicit(&threads_in_ipc_wait, 1,
 		    memory_order_relaxed);
-	if (!locked)
-		futex_unlock(&fibril_futex);
+
+		/*
+		 * No fibril is ready, so each token we can still get stands
+		 * for a free call buffer. Take a few more to receive several
+		 * calls at once.
+		 */
+		futex_lock(&ipc_lists_futex);
+		batch = list_pop(&ipc_batch_free_list, _ipc_batch_t, link);
+		futex_unlock(&ipc_lists_futex);
+		if (batch)
+			tokens += _ready_down_extra(IPC_WAIT_BATCH - 1);
+	}
 
 	if (f)
 		return f;
@@ -298,29 +424,32 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 		assert(list_empty(&ipc_buffer_list));
 
 	/* No fibril is ready, IPC wait it is. */
-	ipc_call_t call = { 0 };
-	rc = _ipc_wait(&call, expires);
+	ipc_call_t call;
+	ipc_call_t *calls = batch ? batch->calls : &call;
+	size_t received = 0;
+	rc = _ipc_wait(calls, tokens, &received, expires);
 
 	atomic_fetch_sub_explicit(&threads_in_ipc_wait, 1,
 	    memory_order_relaxed);
 
-	if (rc != EOK && rc != ENOENT) {
-		/* Return token. */
-		_ready_up();
-		return NULL;
+	if (rc == ENOENT) {
+		/*
+		 * We might get ENOENT due to a poke.
+		 * In that case, we propagate the null call out of
+		 * fibril_ipc_wait(), because poke must result in that call
+		 * returning.
+		 */
+		memset(&calls[0], 0, sizeof(calls[0]));
+		received = 1;
+	} else if (rc != EOK) {
+		received = 0;
 	}
 
-	/*
-	 * We might get ENOENT due to a poke.
-	 * In that case, we propagate the null call out of fibril_ipc_wait(),
-	 * because poke must result in that call returning.
-	 */
-
 	/*
 	 * If a fibril is already waiting for IPC, we wake up the fibril,
 	 * and return the token to ready_semaphore.
 	 * If there is no fibril waiting, we pop a buffer bucket and
-	 * put our call there. The token then returns when the bucket is
+	 * put the call there. The token then returns when the bucket is
 	 * returned.
 	 */
 
@@ -329,21 +458,39 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 
 	futex_lock(&ipc_lists_futex);
 
-	_ipc_waiter_t *w = list_pop(&ipc_waiter_list, _ipc_waiter_t, link);
-	if (w) {
-		*w->call = call;
-		w->rc = rc;
-		/* We switch to the woken up fibril immediately if possible. */
-		f = _fibril_trigger_internal(&w->event, _EVENT_TRIGGERED);
+	for (size_t i = 0; i < received; i++) {
+		/* Only the first call can be a poke. */
+		errno_t call_rc = (i == 0) ? rc : EOK;
+
+		_ipc_waiter_t *w = list_pop(&ipc_waiter_list, _ipc_waiter_t, link);
+		if (w) {
+			*w->call = calls[i];
+			w->rc = call_rc;
+			fibril_t *wf = _fibril_trigger_internal(&w->event,
+			    _EVENT_TRIGGERED);
+
+			/* Switch to the first woken fibril immediately. */
+			if (!f)
+				f = wf;
+			else
+				_ready_list_push(wf);
+
+			/* Return token. */
+			_ready_up();
+		} else {
+			_ipc_buffer_t *buf = list_pop(&ipc_buffer_free_list, _ipc_buffer_t, link);
+			assert(buf);
+			*buf = (_ipc_buffer_t) { .call = calls[i], .rc = call_rc };
+			list_append(&buf->link, &ipc_buffer_list);
+		}
+	}
 
-		/* Return token. */
+	/* Return the tokens of unused buffers. */
+	for (size_t i = received; i < tokens; i++)
 		_ready_up();
-	} else {
-		_ipc_buffer_t *buf = list_pop(&ipc_buffer_free_list, _ipc_buffer_t, link);
-		assert(buf);
-		*buf = (_ipc_buffer_t) { .call = call, .rc = rc };
-		list_append(&buf->link, &ipc_buffer_list);
-	}
+
+	if (batch)
+		list_append(&batch->link, &ipc_batch_free_list);
 
 	futex_unlock(&ipc_lists_futex);
 
@@ -364,10 +511,21 @@ static void _ready_list_push(fibril_t *f)
 	if (!f)
 		return;
 
-	futex_assert_is_locked(&fibril_futex);
-
-	/* Enqueue in ready_list. */
-	list_append(&f->link, &ready_list);
+	/*
+	 * Enqueue in the ready list of the current runner. The woken fibril
+	 * is likely to use data that the current fibril has just touched.
+	 * Idle runners steal from the lists of other runners.
+	 */
+	_runner_t *r = _runner_self();
+	if (r) {
+		futex_lock(&r->futex);
+		list_append(&f->link, &r->ready_list);
+		futex_unlock(&r->futex);
+	} else {
+		futex_lock(&runner_futex);
+		list_append(&f->link, &ready_list);
+		futex_unlock(&runner_futex);
+	}
 	_ready_up();
 
 	if (atomic_load_explicit(&threads_in_ipc_wait, memory_order_relaxed)) {
@@ -422,9 +580,9 @@ static struct timespec *_handle_expired_timeouts(struct timespec *next_timeout)
 
 	futex_lock(&fibril_futex);
 
-	while (!list_empty(&timeout_list)) {
-		link_t *cur = list_first(&timeout_list);
-		_timeout_t *to = list_get_instance(cur, _timeout_t, link);
+	odlink_t *cur;
+	while ((cur = odict_first(&timeout_dict)) != NULL) {
+		_timeout_t *to = odict_get_instance(cur, _timeout_t, link);
 
 		if (ts_gt(&to->expires, &ts)) {
 			*next_timeout = to->expires;
@@ -432,7 +590,7 @@ static struct timespec *_handle_expired_timeouts(struct timespec *next_timeout)
 			return next_timeout;
 		}
 
-		list_remove(&to->link);
+		odict_remove(&to->link);
 
 		_ready_list_push(_fibril_trigger_internal(
 		    to->event, _EVENT_TIMED_OUT));
@@ -520,6 +678,18 @@ static errno_t _helper_fibril_fn(void *arg)
 
 	(void) arg;
 
+	/* The helper fibril never exits, so the runner can be kept here. */
+	_runner_t runner;
+	if (futex_initialize(&runner.futex, 1) != EOK)
+		abort();
+	list_initialize(&runner.ready_list);
+	runner.malloc_cache = NULL;
+
+	futex_lock(&runner_futex);
+	list_append(&runner.link, &runner_list);
+	fibril_self()->runner = &runner;
+	futex_unlock(&runner_futex);
+
 	struct timespec next_timeout;
 	while (true) {
 		struct timespec *to = _handle_expired_timeouts(&next_timeout);
@@ -595,22 +765,30 @@ void fibril_destroy(fid_t fid)
 	fibril_teardown(fibril);
 }
 
+static void *_timeout_getkey(odlink_t *odlink)
+{
+	return &odict_get_instance(odlink, _timeout_t, link)->expires;
+}
+
+static int _timeout_cmp(void *a, void *b)
+{
+	struct timespec *ta = a;
+	struct timespec *tb = b;
+
+	if (ts_gt(ta, tb))
+		return 1;
+	if (ts_gt(tb, ta))
+		return -1;
+	return 0;
+}
+
 static void _insert_timeout(_timeout_t *timeout)
 {
 	futex_assert_is_locked(&fibril_futex);
 	assert(timeout);
 
-	link_t *tmp = timeout_list.head.next;
-	while (tmp != &timeout_list.head) {
-		_timeout_t *cur = list_get_instance(tmp, _timeout_t, link);
-
-		if (ts_gteq(&cur->expires, &timeout->expires))
-			break;
-
-		tmp = tmp->next;
-	}
-
-	list_insert_before(&timeout->link, tmp);
+	odlink_initialize(&timeout->link);
+	odict_insert(&timeout->link, &timeout_dict, NULL);
 }
 
 /**
@@ -697,7 +875,8 @@ errno_t fibril_wait_timeout(fibril_event_t *event,
 	assert(event->fibril != _EVENT_INITIAL);
 	assert(event->fibril == _EVENT_TIMED_OUT || event->fibril == _EVENT_TRIGGERED);
 
-	list_remove(&timeout.link);
+	if (odlink_used(&timeout.link))
+		odict_remove(&timeout.link);
 	errno_t rc = (event->fibril == _EVENT_TIMED_OUT) ? ETIMEOUT : EOK;
 	event->fibril = _EVENT_INITIAL;
 
@@ -741,12 +920,61 @@ void fibril_start(fibril_t *fibril)
 	futex_unlock(&fibril_futex);
 }
 
+/**
+ * Release the helper fibril and the runner of the current thread, which is
+ * about to exit. Fibrils left in the ready list of the runner are handed over
+ * to the remaining threads.
+ */
+void fibril_thread_teardown(void)
+{
+	fibril_t *helper = fibril_self()->thread_ctx;
+	if (!helper)
+		return;
+
+	fibril_self()->thread_ctx = NULL;
+
+	_runner_t *r = helper->runner;
+	if (r) {
+		if (r->malloc_cache != NULL) {
+			__malloc_cache_fini(r->malloc_cache);
+			r->malloc_cache = NULL;
+		}
+
+		futex_lock(&runner_futex);
+		list_remove(&r->link);
+		futex_lock(&r->futex);
+		list_concat(&ready_list, &r->ready_list);
+		futex_unlock(&r->futex);
+		futex_unlock(&runner_futex);
+
+		futex_destroy(&r->futex);
+		helper->runner = NULL;
+	}
+
+	/* A helper created on demand has a stack of its own. */
+	if (helper->stack)
+		fibril_destroy(helper);
+}
+
 /** Start a fibril that has not been running yet. (obsolete) */
 void fibril_add_ready(fibril_t *fibril)
 {
 	fibril_start(fibril);
 }
 
+/**
+ * Get the malloc cache slot of the current thread. The slot belongs to the
+ * runner and can be used without locking as long as the calling fibril does
+ * not switch away.
+ *
+ * @return  Pointer to the slot or NULL if the thread has no runner yet.
+ */
+struct malloc_cache **fibril_malloc_cache(void)
+{
+	_runner_t *r = _runner_self();
+	return r ? &r->malloc_cache : NULL;
+}
+
 /** @return the currently running fibril. */
 fibril_t *fibril_self(void)
 {
@@ -785,6 +1013,27 @@ static void _runner_fn(void *arg)
 	_helper_fibril_fn(arg);
 }
 
+/** Switch the ready list bookkeeping to be safe for several threads. */
+static void _set_multithreaded(void)
+{
+	if (!multithreaded) {
+		_ready_debug_check();
+		if (futex_initialize(&ready_semaphore, ready_st_count) != EOK)
+			abort();
+		multithreaded = true;
+	}
+}
+
+/**
+ * Allow fibril events to be notified from threads other than the runners,
+ * such as threads sleeping in the kernel on behalf of a fibril.
+ */
+void fibril_allow_foreign_threads(void)
+{
+	assert(fibril_self()->rmutex_locks == 0);
+	_set_multithreaded();
+}
+
 /**
  * Spawn a given number of runners (i.e. OS threads) immediately, and
  * unconditionally. This is meant to be used for tests and debugging.
@@ -797,12 +1046,7 @@ int fibril_test_spawn_runners(int n)
 {
 	assert(fibril_self()->rmutex_locks == 0);
 
-	if (!multithreaded) {
-		_ready_debug_check();
-		if (futex_initialize(&ready_semaphore, ready_st_count) != EOK)
-			abort();
-		multithreaded = true;
-	}
+	_set_multithreaded();
 
 	errno_t rc;
 
@@ -812,11 +1056,71 @@ int fibril_test_spawn_runners(int n)
 		if (rc != EOK)
 			return i;
 		thread_detach(tid);
+		atomic_fetch_add(&runner_count, 1);
 	}
 
 	return n;
 }
 
+/**
+ * Make sure there are at least the given number of runners (i.e. OS threads)
+ * including the initial one. Runners cannot be stopped, so the number never
+ * decreases. Servers can use this to make the number of runners configurable.
+ *
+ * @param n  Requested number of runners.
+ * @return   Number of runners.
+ */
+int fibril_set_runners(int n)
+{
+	int count = atomic_load(&runner_count);
+	if (n > count)
+		fibril_test_spawn_runners(n - count);
+
+	return atomic_load(&runner_count);
+}
+
+/**
+ * Set the number of runners from the command line of a server. The only
+ * accepted arguments are an optional "--runners <n>" pair.
+ *
+ * @param argc  Number of arguments, including the program name.
+ * @param argv  Arguments.
+ * @return      EOK on success, EINVAL if the arguments are not valid.
+ */
+errno_t fibril_set_runners_from_args(int argc, char **argv)
+{
+	if (argc <= 1)
+		return EOK;
+
+	if (argc != 3 || str_cmp(argv[1], "--runners") != 0)
+		return EINVAL;
+
+	uint32_t n;
+	errno_t rc = str_uint32_t(argv[2], NULL, 10, true, &n);
+	if (rc != EOK || n < 1 || n > FIBRIL_RUNNERS_MAX)
+		return EINVAL;
+
+	fibril_set_runners((int) n);
+	return EOK;
+}
+
+/**
+ * Set the CPU affinity of the thread running the calling fibril.
+ *
+ * Fibrils may move between runners, so this only pins the calling fibril
+ * if the task has a single runner, or if the fibril is the only one that
+ * uses the thread, such as a dedicated polling loop of a driver.
+ *
+ * @param mask  CPU mask. The bit (i % 8) of the byte (i / 8) allows the
+ *              CPU with ID i.
+ * @param size  Size of the mask in bytes. Zero removes any restriction.
+ * @return      EOK on success or an error code.
+ */
+errno_t fibril_set_affinity(const uint8_t *mask, size_t size)
+{
+	return thread_set_affinity(thread_get_id(), mask, size);
+}
+
 /**
  * Opt-in to have more than one runner thread.
  *
@@ -831,7 +1135,7 @@ void fibril_enable_multithreaded(void)
 	// TODO: Implement better.
 	//       For now, 4 total runners is a sensible default.
 	if (!multithreaded) {
-		fibril_test_spawn_runners(3);
+		fibril_set_runners(4);
 	}
 }
 
@@ -869,6 +1173,10 @@ void __fibrils_init(void)
 		abort();
 	if (futex_initialize(&ipc_lists_futex, 1) != EOK)
 		abort();
+	if (futex_initialize(&runner_futex, 1) != EOK)
+		abort();
+
+	odict_initialize(&timeout_dict, _timeout_getkey, _timeout_cmp);
 
 	/*
 	 * We allow a fixed, small amount of parallelism for IPC reads, but
@@ -883,12 +1191,22 @@ void __fibrils_init(void)
 		list_append(&buffers[i].link, &ipc_buffer_free_list);
 		_ready_up();
 	}
+
+	/*
+	 * The receive buffers of multi-call waits are not on the stack,
+	 * because the fibrils that wait for IPC may have small stacks.
+	 */
+	static _ipc_batch_t batches[IPC_BATCH_COUNT];
+
+	for (int i = 0; i < IPC_BATCH_COUNT; i++)
+		list_append(&batches[i].link, &ipc_batch_free_list);
 }
 
 void __fibrils_fini(void)
 {
 	futex_destroy(&fibril_futex);
 	futex_destroy(&ipc_lists_futex);
+	futex_destroy(&runner_futex);
 }
 
 void fibril_usleep(usec_t timeout)
@@ -87,19 +87,53 @@ void fibril_rmutex_unlock(fibril_rmutex_t *m)
 	futex_unlock(&m->futex);
 }
 
+/*
+ * The state of every synchronization primitive below, including its list of
+ * waiters, is protected by one of the following futexes, chosen by the address
+ * of the primitive. Unrelated primitives thus rarely contend for the same
+ * futex. Uncontended mutex operations do not touch them at all.
+ */
+#define SYNCH_LOCK_COUNT  32
+
+static futex_t synch_locks[SYNCH_LOCK_COUNT];
+
+#ifdef CONFIG_DEBUG_FIBRIL_SYNCH
+
 static fibril_local bool deadlocked = false;
 
+/** Serializes deadlock detection. */
 static futex_t fibril_synch_futex;
 
+#endif
+
 void __fibril_synch_init(void)
 {
+	for (size_t i = 0; i < SYNCH_LOCK_COUNT; i++) {
+		if (futex_initialize(&synch_locks[i], 1) != EOK)
+			abort();
+	}
+
+#ifdef CONFIG_DEBUG_FIBRIL_SYNCH
 	if (futex_initialize(&fibril_synch_futex, 1) != EOK)
 		abort();
+#endif
 }
 
 void __fibril_synch_fini(void)
 {
+	for (size_t i = 0; i < SYNCH_LOCK_COUNT; i++)
+		futex_destroy(&synch_locks[i]);
+
+#ifdef CONFIG_DEBUG_FIBRIL_SYNCH
 	futex_destroy(&fibril_synch_futex);
+#endif
+}
+
+/** Get the futex protecting a synchronization primitive. */
+static futex_t *synch_lock(const void *obj)
+{
+	uintptr_t addr = (uintptr_t) obj;
+	return &synch_locks[((addr >> 4) ^ (addr >> 12)) % SYNCH_LOCK_COUNT];
 }
 
 typedef struct {
@@ -111,6 +145,8 @@ typedef struct {
 
 #define AWAITER_INIT { .fid = fibril_get_id() }
 
+#ifdef CONFIG_DEBUG_FIBRIL_SYNCH
+
 static void print_deadlock(fibril_owner_info_t *oi)
 {
 	// FIXME: Print to stderr.
@@ -156,15 +192,56 @@ static void check_fibril_for_deadlock(fibril_owner_info_t *oi, fibril_t *fib)
 	}
 }
 
-static void check_for_deadlock(fibril_owner_info_t *oi)
+/** Note that the current fibril is going to wait for a primitive.
+ *
+ * Aborts the program if the wait would never end.
+ */
+static void wait_for_begin(fibril_owner_info_t *oi)
+{
+	fibril_t *f = fibril_self();
+
+	futex_lock(&fibril_synch_futex);
+	check_fibril_for_deadlock(oi, f);
+	f->waits_for = oi;
+	futex_unlock(&fibril_synch_futex);
+}
+
+/** Note that a fibril no longer waits for a primitive. */
+static void wait_for_end(fibril_t *f)
+{
+	futex_lock(&fibril_synch_futex);
+	f->waits_for = NULL;
+	futex_unlock(&fibril_synch_futex);
+}
+
+#else
+
+#define wait_for_begin(oi)  ((void) (oi))
+#define wait_for_end(f)     ((void) (f))
+
+#endif
+
+/*
+ * Mutex states. The state is only changed atomically, so that uncontended
+ * locking and unlocking need not take the synch lock. A contended mutex is
+ * handed over to the first waiter under the synch lock.
+ */
+#define MUTEX_UNLOCKED   0
+#define MUTEX_LOCKED     1
+/** Locked, and some fibrils may be waiting for the mutex. */
+#define MUTEX_CONTENDED  2
+
+static inline bool mutex_state_cas(fibril_mutex_t *fm, int expected,
+    int desired)
 {
-	check_fibril_for_deadlock(oi, fibril_self());
+	return __atomic_compare_exchange_n(&fm->state, &expected, desired,
+	    false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
 }
 
 void fibril_mutex_initialize(fibril_mutex_t *fm)
 {
 	fm->oi.owned_by = NULL;
-	fm->counter = 1;
+	fm->state = MUTEX_UNLOCKED;
 	list_initialize(&fm->waiters);
 }
 
@@ -172,70 +249,87 @@ void fibril_mutex_lock(fibril_mutex_t *fm)
 {
 	fibril_t *f = (fibril_t *) fibril_get_id();
 
-	futex_lock(&fibril_synch_futex);
-
-	if (fm->counter-- > 0) {
+	if (mutex_state_cas(fm, MUTEX_UNLOCKED, MUTEX_LOCKED)) {
 		fm->oi.owned_by = f;
-		futex_unlock(&fibril_synch_futex);
 		return;
 	}
 
+	futex_t *lock = synch_lock(fm);
+	futex_lock(lock);
+
+	/*
+	 * Make sure the owner takes the slow path when unlocking the mutex,
+	 * unless the mutex got unlocked in the meantime.
+	 */
+	while (true) {
+		int state = __atomic_load_n(&fm->state, __ATOMIC_RELAXED);
+		if (state == MUTEX_CONTENDED)
+			break;
+
+		if (mutex_state_cas(fm, state, MUTEX_CONTENDED)) {
+			if (state == MUTEX_UNLOCKED) {
+				fm->oi.owned_by = f;
+				futex_unlock(lock);
+				return;
+			}
+			break;
+		}
+	}
+
 	awaiter_t wdata = AWAITER_INIT;
 	list_append(&wdata.link, &fm->waiters);
-	check_for_deadlock(&fm->oi);
-	f->waits_for = &fm->oi;
+	wait_for_begin(&fm->oi);
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 
 	fibril_wait_for(&wdata.event);
 }
 
 bool fibril_mutex_trylock(fibril_mutex_t *fm)
 {
-	bool locked = false;
-
-	futex_lock(&fibril_synch_futex);
-	if (fm->counter > 0) {
-		fm->counter--;
-		fm->oi.owned_by = (fibril_t *) fibril_get_id();
-		locked = true;
-	}
-	futex_unlock(&fibril_synch_futex);
+	if (!mutex_state_cas(fm, MUTEX_UNLOCKED, MUTEX_LOCKED))
+		return false;
 
-	return locked;
+	fm->oi.owned_by = (fibril_t *) fibril_get_id();
+	return true;
 }
 
-static void _fibril_mutex_unlock_unsafe(fibril_mutex_t *fm)
+void fibril_mutex_unlock(fibril_mutex_t *fm)
 {
 	assert(fm->oi.owned_by == (fibril_t *) fibril_get_id());
 
-	if (fm->counter++ < 0) {
-		awaiter_t *wdp = list_pop(&fm->waiters, awaiter_t, link);
-		assert(wdp);
+	fm->oi.owned_by = NULL;
 
-		fibril_t *f = (fibril_t *) wdp->fid;
-		fm->oi.owned_by = f;
-		f->waits_for = NULL;
+	if (mutex_state_cas(fm, MUTEX_LOCKED, MUTEX_UNLOCKED))
+		return;
 
-		fibril_notify(&wdp->event);
-	} else {
-		fm->oi.owned_by = NULL;
+	futex_t *lock = synch_lock(fm);
+	futex_lock(lock);
+
+	assert(fm->state == MUTEX_CONTENDED);
+
+	awaiter_t *wdp = list_pop(&fm->waiters, awaiter_t, link);
+	if (!wdp) {
+		__atomic_store_n(&fm->state, MUTEX_UNLOCKED, __ATOMIC_RELEASE);
+		futex_unlock(lock);
+		return;
 	}
-}
 
-void fibril_mutex_unlock(fibril_mutex_t *fm)
-{
-	futex_lock(&fibril_synch_futex);
-	_fibril_mutex_unlock_unsafe(fm);
-	futex_unlock(&fibril_synch_futex);
+	/* Hand the mutex over to the first waiter. */
+	fibril_t *f = (fibril_t *) wdp->fid;
+	wait_for_end(f);
+	fm->oi.owned_by = f;
+	if (list_empty(&fm->waiters))
+		__atomic_store_n(&fm->state, MUTEX_LOCKED, __ATOMIC_RELAXED);
+
+	fibril_notify(&wdp->event);
+
+	futex_unlock(lock);
 }
 
 bool fibril_mutex_is_locked(fibril_mutex_t *fm)
 {
-	futex_lock(&fibril_synch_futex);
-	bool locked = (fm->oi.owned_by == (fibril_t *) fibril_get_id());
-	futex_unlock(&fibril_synch_futex);
-	return locked;
+	return fm->oi.owned_by == (fibril_t *) fibril_get_id();
 }
 
 void fibril_rwlock_initialize(fibril_rwlock_t *frw)
@@ -249,14 +343,15 @@ void fibril_rwlock_initialize(fibril_rwlock_t *frw)
 void fibril_rwlock_read_lock(fibril_rwlock_t *frw)
 {
 	fibril_t *f = (fibril_t *) fibril_get_id();
+	futex_t *lock = synch_lock(frw);
 
-	futex_lock(&fibril_synch_futex);
+	futex_lock(lock);
 
 	if (!frw->writers) {
 		/* Consider the first reader the owner. */
 		if (frw->readers++ == 0)
 			frw->oi.owned_by = f;
-		futex_unlock(&fibril_synch_futex);
+		futex_unlock(lock);
 		return;
 	}
 
@@ -264,10 +359,9 @@ void fibril_rwlock_read_lock(fibril_rwlock_t *frw)
 
 	awaiter_t wdata = AWAITER_INIT;
 	list_append(&wdata.link, &frw->waiters);
-	check_for_deadlock(&frw->oi);
-	f->waits_for = &frw->oi;
+	wait_for_begin(&frw->oi);
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 
 	fibril_wait_for(&wdata.event);
 }
@@ -275,13 +369,14 @@ void fibril_rwlock_read_lock(fibril_rwlock_t *frw)
 void fibril_rwlock_write_lock(fibril_rwlock_t *frw)
 {
 	fibril_t *f = (fibril_t *) fibril_get_id();
+	futex_t *lock = synch_lock(frw);
 
-	futex_lock(&fibril_synch_futex);
+	futex_lock(lock);
 
 	if (!frw->writers && !frw->readers) {
 		frw->oi.owned_by = f;
 		frw->writers++;
-		futex_unlock(&fibril_synch_futex);
+		futex_unlock(lock);
 		return;
 	}
 
@@ -289,10 +384,9 @@ void fibril_rwlock_write_lock(fibril_rwlock_t *frw)
 
 	awaiter_t wdata = AWAITER_INIT;
 	list_append(&wdata.link, &frw->waiters);
-	check_for_deadlock(&frw->oi);
-	f->waits_for = &frw->oi;
+	wait_for_begin(&frw->oi);
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 
 	fibril_wait_for(&wdata.event);
 }
@@ -342,7 +436,7 @@ static void _fibril_rwlock_common_unlock(fibril_rwlock_t *frw)
 			frw->readers++;
 		}
 
-		f->waits_for = NULL;
+		wait_for_end(f);
 		list_remove(&wdp->link);
 		frw->oi.owned_by = f;
 		fibril_notify(&wdp->event);
@@ -354,35 +448,43 @@ static void _fibril_rwlock_common_unlock(fibril_rwlock_t *frw)
 
 void fibril_rwlock_read_unlock(fibril_rwlock_t *frw)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(frw);
+
+	futex_lock(lock);
 	assert(frw->readers > 0);
 	_fibril_rwlock_common_unlock(frw);
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 }
 
 void fibril_rwlock_write_unlock(fibril_rwlock_t *frw)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(frw);
+
+	futex_lock(lock);
 	assert(frw->writers == 1);
 	assert(frw->oi.owned_by == fibril_self());
 	_fibril_rwlock_common_unlock(frw);
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 }
 
 bool fibril_rwlock_is_read_locked(fibril_rwlock_t *frw)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(frw);
+
+	futex_lock(lock);
 	bool locked = (frw->readers > 0);
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 	return locked;
 }
 
 bool fibril_rwlock_is_write_locked(fibril_rwlock_t *frw)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(frw);
+
+	futex_lock(lock);
 	assert(frw->writers <= 1);
 	bool locked = (frw->writers > 0) && (frw->oi.owned_by == fibril_self());
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 	return locked;
 }
 
@@ -422,17 +524,24 @@ fibril_condvar_wait_timeout(fibril_condvar_t *fcv, fibril_mutex_t *fm,
 		expires = &ts;
 	}
 
-	futex_lock(&fibril_synch_futex);
-	_fibril_mutex_unlock_unsafe(fm);
+	futex_t *lock = synch_lock(fcv);
+
+	/*
+	 * Start waiting before unlocking the mutex. A signal that comes in
+	 * between is remembered by the event.
+	 */
+	futex_lock(lock);
 	list_append(&wdata.link, &fcv->waiters);
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
+
+	fibril_mutex_unlock(fm);
 
 	(void) fibril_wait_timeout(&wdata.event, expires);
 
-	futex_lock(&fibril_synch_futex);
+	futex_lock(lock);
 	bool timed_out = link_in_use(&wdata.link);
 	list_remove(&wdata.link);
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 
 	fibril_mutex_lock(fm);
 
@@ -446,24 +555,28 @@ void fibril_condvar_wait(fibril_condvar_t *fcv, fibril_mutex_t *fm)
 
 void fibril_condvar_signal(fibril_condvar_t *fcv)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(fcv);
+
+	futex_lock(lock);
 
 	awaiter_t *w = list_pop(&fcv->waiters, awaiter_t, link);
 	if (w != NULL)
 		fibril_notify(&w->event);
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 }
 
 void fibril_condvar_broadcast(fibril_condvar_t *fcv)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(fcv);
+
+	futex_lock(lock);
 
 	awaiter_t *w;
 	while ((w = list_pop(&fcv->waiters, awaiter_t, link)))
 		fibril_notify(&w->event);
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 }
 
 /** Timer fibril.
@@ -693,10 +806,12 @@ void fibril_semaphore_initialize(fibril_semaphore_t *sem, long count)
  */
 void fibril_semaphore_up(fibril_semaphore_t *sem)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(sem);
+
+	futex_lock(lock);
 
 	if (sem->closed) {
-		futex_unlock(&fibril_synch_futex);
+		futex_unlock(lock);
 		return;
 	}
 
@@ -708,7 +823,7 @@ void fibril_semaphore_up(fibril_semaphore_t *sem)
 		fibril_notify(&w->event);
 	}
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 }
 
 /**
@@ -720,24 +835,26 @@ void fibril_semaphore_up(fibril_semaphore_t *sem)
  */
 void fibril_semaphore_down(fibril_semaphore_t *sem)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(sem);
+
+	futex_lock(lock);
 
 	if (sem->closed) {
-		futex_unlock(&fibril_synch_futex);
+		futex_unlock(lock);
 		return;
 	}
 
 	sem->count--;
 
 	if (sem->count >= 0) {
-		futex_unlock(&fibril_synch_futex);
+		futex_unlock(lock);
 		return;
 	}
 
 	awaiter_t wdata = AWAITER_INIT;
 	list_append(&wdata.link, &sem->waiters);
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 
 	fibril_wait_for(&wdata.event);
 }
@@ -747,23 +864,25 @@ errno_t fibril_semaphore_down_timeout(fibril_semaphore_t *sem, usec_t timeout)
 	if (timeout < 0)
 		return ETIMEOUT;
 
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(sem);
+
+	futex_lock(lock);
 	if (sem->closed) {
-		futex_unlock(&fibril_synch_futex);
+		futex_unlock(lock);
 		return EOK;
 	}
 
 	sem->count--;
 
 	if (sem->count >= 0) {
-		futex_unlock(&fibril_synch_futex);
+		futex_unlock(lock);
 		return EOK;
 	}
 
 	awaiter_t wdata = AWAITER_INIT;
 	list_append(&wdata.link, &sem->waiters);
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 
 	struct timespec ts;
 	struct timespec *expires = NULL;
@@ -777,15 +896,15 @@ errno_t fibril_semaphore_down_timeout(fibril_semaphore_t *sem, usec_t timeout)
 	if (rc == EOK)
 		return EOK;
 
-	futex_lock(&fibril_synch_futex);
+	futex_lock(lock);
 	if (!link_in_use(&wdata.link)) {
-		futex_unlock(&fibril_synch_futex);
+		futex_unlock(lock);
 		return EOK;
 	}
 
 	list_remove(&wdata.link);
 	sem->count++;
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 
 	return rc;
 }
@@ -796,14 +915,16 @@ errno_t fibril_semaphore_down_timeout(fibril_semaphore_t *sem, usec_t timeout)
  */
 void fibril_semaphore_close(fibril_semaphore_t *sem)
 {
-	futex_lock(&fibril_synch_futex);
+	futex_t *lock = synch_lock(sem);
+
+	futex_lock(lock);
 	sem->closed = true;
 	awaiter_t *w;
 
 	while ((w = list_pop(&sem->waiters, awaiter_t, link)))
 		fibril_notify(&w->event);
 
-	futex_unlock(&fibril_synch_futex);
+	futex_unlock(lock);
 }
 
 /** @}
@@ -73,6 +73,7 @@ void __thread_main(uspace_arg_t *uarg)
 	 * free(uarg);
 	 */
 
+	fibril_thread_teardown();
 	fibril_teardown(fibril);
 	thread_exit(0);
 }
@@ -172,6 +173,22 @@ thread_id_t thread_get_id(void)
 	return thread_id;
 }
 
+/** Set CPU affinity of a thread.
+ *
+ * @param thread_id ID of a thread of the current task.
+ * @param mask      CPU mask. The bit (i % 8) of the byte (i / 8) allows
+ *                  the CPU with ID i.
+ * @param size      Size of the mask in bytes. Zero removes any restriction.
+ *
+ * @return Zero on success or an error code.
+ */
+errno_t thread_set_affinity(thread_id_t thread_id, const uint8_t *mask,
+    size_t size)
+{
+	return (errno_t) __SYSCALL3(SYS_THREAD_SET_AFFINITY,
+	    (sysarg_t) &thread_id, (sysarg_t) mask, (sysarg_t) size);
+}
+
 /** Wait unconditionally for specified number of microseconds
  *
  */
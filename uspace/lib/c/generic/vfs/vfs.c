@@ -602,6 +602,30 @@ errno_t vfs_lookup_open(const char *path, int flags, int mode, int *handle)
 	return EOK;
 }
 
+/** Get statistics of the VFS path lookup cache
+ *
+ * @param[out] stats    Buffer for storing the statistics
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_lookup_stats(vfs_lookup_stats_t *stats)
+{
+	errno_t rc, ret;
+	aid_t req;
+
+	async_exch_t *exch = vfs_exchange_begin();
+
+	req = async_send_0(exch, VFS_IN_LOOKUP_STATS, NULL);
+	rc = async_data_read_start(exch, (void *) stats, sizeof(*stats));
+
+	vfs_exchange_end(exch);
+	async_wait_for(req, &ret);
+
+	rc = (ret != EOK ? ret : rc);
+
+	return rc;
+}
+
 /** Mount a file system
  *
  * @param[in] mp                File handle representing the mount-point
@@ -104,6 +104,7 @@ struct async_sess;
 
 typedef struct async_sess async_sess_t;
 typedef struct async_exch async_exch_t;
+typedef struct async_ring async_ring_t;
 
 extern __noreturn void async_manager(void);
 
@@ -311,6 +312,19 @@ extern errno_t async_share_out_start(async_exch_t *, void *, unsigned int);
 extern bool async_share_out_receive(ipc_call_t *, size_t *, unsigned int *);
 extern errno_t async_share_out_finalize(ipc_call_t *, void **);
 
+extern errno_t async_waitq_share_start(async_exch_t *, cap_waitq_handle_t);
+extern bool async_waitq_share_receive(ipc_call_t *, cap_waitq_handle_t *);
+extern errno_t async_waitq_share_finalize(ipc_call_t *);
+
+extern errno_t async_ring_create(async_exch_t *, size_t, bool,
+    async_ring_t **);
+extern errno_t async_ring_accept(async_ring_t **);
+extern void async_ring_destroy(async_ring_t *);
+extern size_t async_ring_max_size(async_ring_t *);
+extern errno_t async_ring_write(async_ring_t *, const void *, size_t);
+extern errno_t async_ring_read(async_ring_t *, void *, size_t, size_t *);
+extern errno_t async_ring_drain(async_ring_t *);
+
 extern errno_t async_data_read_forward_0_0(async_exch_t *, sysarg_t);
 extern errno_t async_data_read_forward_1_0(async_exch_t *, sysarg_t, sysarg_t);
 extern errno_t async_data_read_forward_2_0(async_exch_t *, sysarg_t, sysarg_t,
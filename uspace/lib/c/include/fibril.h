@@ -35,6 +35,8 @@
 #ifndef _LIBC_FIBRIL_H_
 #define _LIBC_FIBRIL_H_
 
+#include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 #include <_bits/errno.h>
 #include <_bits/__noreturn.h>
@@ -50,6 +52,9 @@ typedef struct {
 
 typedef fibril_t *fid_t;
 
+/** Maximum number of runners accepted on the command line of a server. */
+#define FIBRIL_RUNNERS_MAX  64
+
 #ifndef __cplusplus
 /** Fibril-local variable specifier */
 #define fibril_local __thread
@@ -67,6 +72,9 @@ extern void fibril_sleep(sec_t);
 
 extern void fibril_enable_multithreaded(void);
 extern int fibril_test_spawn_runners(int);
+extern int fibril_set_runners(int);
+extern errno_t fibril_set_runners_from_args(int, char **);
+extern errno_t fibril_set_affinity(const uint8_t *, size_t);
 
 extern void fibril_detach(fid_t fid);
 
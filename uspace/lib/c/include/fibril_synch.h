@@ -48,7 +48,7 @@
 		.oi = { \
 			.owned_by = NULL \
 		}, \
-		.counter = 1, \
+		.state = 0, \
 		.waiters = LIST_INITIALIZER((name).waiters), \
 	}
 
@@ -91,7 +91,8 @@ __HELENOS_DECLS_BEGIN;
 
 typedef struct {
 	fibril_owner_info_t oi;  /**< Keep this the first thing. */
-	int counter;
+	/** Lock state, only accessed atomically. */
+	volatile int state;
 	list_t waiters;
 } fibril_mutex_t;
 
@@ -61,6 +61,16 @@ typedef struct {
 	unsigned int instance;
 	bool concurrent_read_write;
 	bool write_retains_size;
+	/**
+	 * Files are stored on a block device, have a known size and change
+	 * only through VFS, so VFS may cache their contents.
+	 */
+	bool block_backed;
+	/**
+	 * Names may appear or disappear without going through VFS, so VFS
+	 * must not cache the results of lookups.
+	 */
+	bool external_namespace;
 } vfs_info_t;
 
 /** Data returned by filesystem probe regarding a specific volume. */
@@ -73,6 +83,7 @@ typedef enum {
 	VFS_IN_CLONE = IPC_FIRST_USER_METHOD,
 	VFS_IN_FSPROBE,
 	VFS_IN_FSTYPES,
+	VFS_IN_LOOKUP_STATS,
 	VFS_IN_MOUNT,
 	VFS_IN_OPEN,
 	VFS_IN_PUT,
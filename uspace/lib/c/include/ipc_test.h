@@ -37,6 +37,7 @@
 
 #include <async.h>
 #include <errno.h>
+#include <time.h>
 
 typedef struct {
 	async_sess_t *sess;
@@ -45,10 +46,18 @@ typedef struct {
 extern errno_t ipc_test_create(ipc_test_t **);
 extern void ipc_test_destroy(ipc_test_t *);
 extern errno_t ipc_test_ping(ipc_test_t *);
+extern errno_t ipc_test_ping_pipelined(ipc_test_t *, size_t);
 extern errno_t ipc_test_get_ro_area_size(ipc_test_t *, size_t *);
 extern errno_t ipc_test_get_rw_area_size(ipc_test_t *, size_t *);
 extern errno_t ipc_test_share_in_ro(ipc_test_t *, size_t, const void **);
 extern errno_t ipc_test_share_in_rw(ipc_test_t *, size_t, void **);
+extern errno_t ipc_test_write(ipc_test_t *, const void *, size_t);
+extern errno_t ipc_test_write_delayed(ipc_test_t *, const void *, size_t,
+    usec_t);
+extern errno_t ipc_test_read(ipc_test_t *, void *, size_t);
+extern errno_t ipc_test_read_partial(ipc_test_t *, void *, size_t, size_t,
+    usec_t);
+extern errno_t ipc_test_ring_create(ipc_test_t *, size_t, async_ring_t **);
 
 #endif
 
@@ -64,11 +64,26 @@ typedef struct {
 	service_id_t service;
 } vfs_stat_t;
 
+/** Write-back statistics of a block cache. */
+typedef struct {
+	/** Number of bytes held in dirty blocks. */
+	uint64_t dirty_bytes;
+	/** Number of write-back transfers. */
+	uint64_t flushes;
+	/** Number of blocks written back. */
+	uint64_t flushed_blocks;
+	/** Total time spent in write-back transfers (in microseconds). */
+	uint64_t flush_time;
+	/** Longest write-back transfer (in microseconds). */
+	uint64_t flush_time_max;
+} vfs_cache_stats_t;
+
 typedef struct {
 	char fs_name[FS_NAME_MAXLEN + 1];
 	uint32_t f_bsize;    /* fundamental file system block size */
 	uint64_t f_blocks;   /* total data blocks in file system */
 	uint64_t f_bfree;    /* free blocks in fs */
+	vfs_cache_stats_t f_cache; /* block cache statistics */
 } vfs_statfs_t;
 
 /** List of file system types */
@@ -78,6 +93,12 @@ typedef struct {
 	size_t size;
 } vfs_fstypes_t;
 
+/** Path lookup cache statistics */
+typedef struct {
+	uint64_t hits;
+	uint64_t misses;
+} vfs_lookup_stats_t;
+
 extern errno_t vfs_fhandle(FILE *, int *);
 
 extern char *vfs_absolutize(const char *, size_t *);
@@ -93,6 +114,7 @@ extern errno_t vfs_link(int, const char *, vfs_file_kind_t, int *);
 extern errno_t vfs_link_path(const char *, vfs_file_kind_t, int *);
 extern errno_t vfs_lookup(const char *, int, int *);
 extern errno_t vfs_lookup_open(const char *, int, int, int *);
+extern errno_t vfs_lookup_stats(vfs_lookup_stats_t *);
 extern errno_t vfs_mount_path(const char *, const char *, const char *,
     const char *, unsigned int, unsigned int);
 extern errno_t vfs_mount(int, const char *, service_id_t, const char *, unsigned,
@@ -752,7 +752,7 @@ static errno_t ext4_filesystem_init_block_bitmap(ext4_block_group_ref_t *bg_ref)
 
 	block_t *bitmap_block;
 	errno_t rc = block_get(&bitmap_block, bg_ref->fs->device,
-	    bitmap_block_addr, BLOCK_FLAGS_NOREAD);
+	    bitmap_block_addr, BLOCK_FLAGS_NOREAD | BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -821,7 +821,7 @@ static errno_t ext4_filesystem_init_inode_bitmap(ext4_block_group_ref_t *bg_ref)
 	block_t *bitmap_block;
 
 	errno_t rc = block_get(&bitmap_block, bg_ref->fs->device,
-	    bitmap_block_addr, BLOCK_FLAGS_NOREAD);
+	    bitmap_block_addr, BLOCK_FLAGS_NOREAD | BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -929,7 +929,8 @@ errno_t ext4_filesystem_get_block_group_ref(ext4_filesystem_t *fs, uint32_t bgid
 	    ext4_superblock_get_desc_size(fs->superblock);
 
 	/* Load block with descriptors */
-	errno_t rc = block_get(&newref->block, fs->device, block_id, 0);
+	errno_t rc = block_get(&newref->block, fs->device, block_id,
+	    BLOCK_FLAGS_META);
 	if (rc != EOK) {
 		free(newref);
 		return rc;
@@ -1164,7 +1165,8 @@ errno_t ext4_filesystem_get_inode_ref(ext4_filesystem_t *fs, uint32_t index,
 
 	/* Compute block address */
 	aoff64_t block_id = inode_table_start + (byte_offset_in_group / block_size);
-	rc = block_get(&newref->block, fs->device, block_id, 0);
+	rc = block_get(&newref->block, fs->device, block_id,
+	    BLOCK_FLAGS_META);
 	if (rc != EOK) {
 		free(newref);
 		return rc;
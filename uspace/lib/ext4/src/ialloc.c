@@ -112,7 +112,7 @@ errno_t ext4_ialloc_free_inode(ext4_filesystem_t *fs, uint32_t index, bool is_di
 	    bg_ref->block_group, sb);
 	block_t *bitmap_block;
 	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr,
-	    BLOCK_FLAGS_NONE);
+	    BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -223,7 +223,7 @@ retry:
 
 			block_t *bitmap_block;
 			rc = block_get(&bitmap_block, fs->device, bitmap_block_addr,
-			    BLOCK_FLAGS_NONE);
+			    BLOCK_FLAGS_META);
 			if (rc != EOK) {
 				ext4_filesystem_put_block_group_ref(bg_ref);
 				return rc;
@@ -356,7 +356,7 @@ errno_t ext4_ialloc_alloc_this_inode(ext4_filesystem_t *fs, uint32_t inode,
 
 	block_t *bitmap_block;
 	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr,
-	    BLOCK_FLAGS_NONE);
+	    BLOCK_FLAGS_META);
 	if (rc != EOK) {
 		ext4_filesystem_put_block_group_ref(bg_ref);
 		return rc;
@@ -789,6 +789,12 @@ void libfs_statfs(libfs_ops_t *ops, fs_handle_t fs_handle, ipc_call_t *req)
 			goto error;
 	}
 
+	if (ops->cache_stats != NULL) {
+		rc = ops->cache_stats(service_id, &st.f_cache);
+		if (rc != EOK)
+			goto error;
+	}
+
 	ops->node_put(fn);
 	async_data_read_finalize(&call, &st, sizeof(vfs_statfs_t));
 	async_answer_0(req, EOK);
@@ -40,6 +40,7 @@
 #include <offset.h>
 #include <async.h>
 #include <loc.h>
+#include <vfs/vfs.h>
 
 typedef struct {
 	errno_t (*fsprobe)(service_id_t, vfs_fs_probe_info_t *);
@@ -87,6 +88,7 @@ typedef struct {
 	errno_t (*size_block)(service_id_t, uint32_t *);
 	errno_t (*total_block_count)(service_id_t, uint64_t *);
 	errno_t (*free_block_count)(service_id_t, uint64_t *);
+	errno_t (*cache_stats)(service_id_t, vfs_cache_stats_t *);
 } libfs_ops_t;
 
 typedef struct {
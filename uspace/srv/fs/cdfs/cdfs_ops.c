@@ -845,7 +845,8 @@ libfs_ops_t cdfs_libfs_ops = {
 	.service_get = cdfs_service_get,
 	.size_block = cdfs_size_block,
 	.total_block_count = cdfs_total_block_count,
-	.free_block_count = cdfs_free_block_count
+	.free_block_count = cdfs_free_block_count,
+	.cache_stats = block_cache_get_stats
 };
 
 /** Verify that escape sequence corresonds to one of the allowed encoding
@@ -50,6 +50,7 @@
 
 vfs_info_t ext4fs_vfs_info = {
 	.name = NAME,
+	.block_backed = true,
 	.instance = 0
 };
 
@@ -84,7 +84,7 @@ static errno_t fat_directory_block_load(fat_directory_t *di)
 		}
 		if (!di->b) {
 			rc = fat_block_get(&di->b, di->bs, di->nodep, i,
-			    BLOCK_FLAGS_NONE);
+			    BLOCK_FLAGS_META);
 			if (rc != EOK) {
 				di->b = NULL;
 				return rc;
@@ -302,7 +302,7 @@ fat_get_cluster_fat12(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
 		return ERANGE;
 
 	rc = block_get(&b, service_id, RSCNT(bs) + SF(bs) * fatno +
-	    offset / BPS(bs), BLOCK_FLAGS_NONE);
+	    offset / BPS(bs), BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -314,7 +314,7 @@ fat_get_cluster_fat12(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
 			/* No, read the next sector */
 			rc = block_get(&b1, service_id, 1 + RSCNT(bs) +
 			    SF(bs) * fatno + offset / BPS(bs),
-			    BLOCK_FLAGS_NONE);
+			    BLOCK_FLAGS_META);
 			if (rc != EOK) {
 				block_put(b);
 				return rc;
@@ -369,7 +369,7 @@ fat_get_cluster_fat16(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
 	offset = (clst * FAT16_CLST_SIZE);
 
 	rc = block_get(&b, service_id, RSCNT(bs) + SF(bs) * fatno +
-	    offset / BPS(bs), BLOCK_FLAGS_NONE);
+	    offset / BPS(bs), BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -400,7 +400,7 @@ fat_get_cluster_fat32(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
 	offset = (clst * FAT32_CLST_SIZE);
 
 	rc = block_get(&b, service_id, RSCNT(bs) + SF(bs) * fatno +
-	    offset / BPS(bs), BLOCK_FLAGS_NONE);
+	    offset / BPS(bs), BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -463,7 +463,7 @@ fat_set_cluster_fat12(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
 		return ERANGE;
 
 	rc = block_get(&b, service_id, RSCNT(bs) + SF(bs) * fatno +
-	    offset / BPS(bs), BLOCK_FLAGS_NONE);
+	    offset / BPS(bs), BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -476,7 +476,7 @@ fat_set_cluster_fat12(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
 			/* No, read the next sector */
 			rc = block_get(&b1, service_id, 1 + RSCNT(bs) +
 			    SF(bs) * fatno + offset / BPS(bs),
-			    BLOCK_FLAGS_NONE);
+			    BLOCK_FLAGS_META);
 			if (rc != EOK) {
 				block_put(b);
 				return rc;
@@ -548,7 +548,7 @@ fat_set_cluster_fat16(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
 	offset = (clst * FAT16_CLST_SIZE);
 
 	rc = block_get(&b, service_id, RSCNT(bs) + SF(bs) * fatno +
-	    offset / BPS(bs), BLOCK_FLAGS_NONE);
+	    offset / BPS(bs), BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -582,7 +582,7 @@ fat_set_cluster_fat32(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
 	offset = (clst * FAT32_CLST_SIZE);
 
 	rc = block_get(&b, service_id, RSCNT(bs) + SF(bs) * fatno +
-	    offset / BPS(bs), BLOCK_FLAGS_NONE);
+	    offset / BPS(bs), BLOCK_FLAGS_META);
 	if (rc != EOK)
 		return rc;
 
@@ -905,7 +905,8 @@ libfs_ops_t fat_libfs_ops = {
 	.service_get = fat_service_get,
 	.size_block = fat_size_block,
 	.total_block_count = fat_total_block_count,
-	.free_block_count = fat_free_block_count
+	.free_block_count = fat_free_block_count,
+	.cache_stats = block_cache_get_stats
 };
 
 static errno_t fat_fs_open(service_id_t service_id, enum cache_mode cmode,
@@ -1540,6 +1541,68 @@ static errno_t fat_destroy(service_id_t service_id, fs_index_t index)
 	return rc;
 }
 
+/** Write back the cached blocks of a node.
+ *
+ * Writes back the data clusters of the node, the block with its directory
+ * entry and the FATs, coalescing runs of contiguous clusters.
+ */
+static errno_t fat_node_flush(fat_node_t *nodep)
+{
+	service_id_t service_id = nodep->idx->service_id;
+	fat_bs_t *bs = block_bb_get(service_id);
+	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
+	fat_cluster_t clst = nodep->firstc;
+	fat_cluster_t first = clst;
+	uint32_t run = 0;
+	block_t *b;
+	errno_t rc;
+
+	if (!FAT_IS_FAT32(bs) && nodep->firstc == FAT_CLST_ROOT) {
+		/* root directory special case */
+		rc = block_flush(service_id, RSCNT(bs) + FATCNT(bs) * SF(bs),
+		    RDS(bs));
+		if (rc != EOK)
+			return rc;
+		clst = clst_last1;
+	}
+
+	while (clst >= FAT_CLST_FIRST && clst < clst_last1) {
+		fat_cluster_t next;
+
+		rc = fat_get_cluster(bs, service_id, FAT1, clst, &next);
+		if (rc != EOK)
+			return rc;
+
+		run++;
+		if (next != clst + 1) {
+			rc = block_flush(service_id, CLBN2PBN(bs, first, 0),
+			    (aoff64_t) run * SPC(bs));
+			if (rc != EOK)
+				return rc;
+			first = next;
+			run = 0;
+		}
+		clst = next;
+	}
+
+	if (nodep->idx->pfc != FAT_CLST_ROOTPAR) {
+		rc = _fat_block_get(&b, bs, service_id, nodep->idx->pfc, NULL,
+		    (nodep->idx->pdi * sizeof(fat_dentry_t)) / BPS(bs),
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK)
+			return rc;
+		aoff64_t lba = b->lba;
+		rc = block_put(b);
+		if (rc != EOK)
+			return rc;
+		rc = block_flush(service_id, lba, 1);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return block_flush(service_id, RSCNT(bs), FATCNT(bs) * SF(bs));
+}
+
 static errno_t fat_sync(service_id_t service_id, fs_index_t index)
 {
 	fs_node_t *fn;
@@ -1553,6 +1616,8 @@ static errno_t fat_sync(service_id_t service_id, fs_index_t index)
 
 	nodep->dirty = true;
 	rc = fat_node_sync(nodep);
+	if (rc == EOK)
+		rc = fat_node_flush(nodep);
 
 	fat_node_put(fn);
 	return rc;
@@ -37,6 +37,7 @@
 #include <disp_srv.h>
 #include <dispcfg_srv.h>
 #include <errno.h>
+#include <fibril.h>
 #include <gfx/context.h>
 #include <str_error.h>
 #include <io/log.h>
@@ -46,6 +47,8 @@
 #include <ipcgfx/server.h>
 #include <loc.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
 #include <task.h>
 #include <wndmgt_srv.h>
 #include "cfgclient.h"
@@ -343,6 +346,11 @@ int main(int argc, char *argv[])
 
 	printf("%s: Display server\n", NAME);
 
+	if (fibril_set_runners_from_args(argc, argv) != EOK) {
+		printf("%s: Usage: %s [--runners <count>]\n", NAME, NAME);
+		return 1;
+	}
+
 	if (log_init(NAME) != EOK) {
 		printf(NAME ": Failed to initialize logging.\n");
 		return 1;
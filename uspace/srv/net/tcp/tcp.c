@@ -36,8 +36,11 @@
 
 #include <async.h>
 #include <errno.h>
+#include <fibril.h>
 #include <io/log.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
 #include <task.h>
 
 #include "conn.h"
@@ -95,6 +98,11 @@ int main(int argc, char **argv)
 
 	printf(NAME ": TCP (Transmission Control Protocol) network module\n");
 
+	if (fibril_set_runners_from_args(argc, argv) != EOK) {
+		printf("%s: Usage: %s [--runners <count>]\n", NAME, NAME);
+		return 1;
+	}
+
 	rc = log_init(NAME);
 	if (rc != EOK) {
 		printf(NAME ": Failed to initialize log.\n");
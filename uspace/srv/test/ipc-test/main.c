@@ -40,6 +40,7 @@
 #include <as.h>
 #include <async.h>
 #include <errno.h>
+#include <fibril.h>
 #include <str_error.h>
 #include <io/log.h>
 #include <ipc/ipc_test.h>
@@ -47,6 +48,7 @@
 #include <loc.h>
 #include <mem.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <task.h>
 
 #define NAME  "ipc-test"
@@ -67,6 +69,14 @@ static const char *ro_data = "Hello, world!";
  */
 static char rw_data[] = "Hello, world!";
 
+/** Buffer for data transfers.
+ *
+ * Allocated from the heap so that it is backed by anonymous memory as
+ * buffers of real servers usually are. Large enough for the largest
+ * transfer the kernel accepts, its pages are only touched when used.
+ */
+static void *xfer_buf;
+
 static void ipc_test_get_ro_area_size_srv(ipc_call_t *icall)
 {
 	errno_t rc;
@@ -181,6 +191,104 @@ static void ipc_test_share_in_rw_srv(ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+static void ipc_test_write_srv(ipc_call_t *icall)
+{
+	usec_t delay = ipc_get_arg1(icall);
+	ipc_call_t call;
+	errno_t rc;
+	size_t size;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ipc_test_write_srv");
+	if (!async_data_write_receive(&call, &size)) {
+		async_answer_0(icall, EINVAL);
+		log_msg(LOG_DEFAULT, LVL_ERROR, "data_write_receive failed");
+		return;
+	}
+
+	if (size > DATA_XFER_LOAN_LIMIT) {
+		async_answer_0(&call, ELIMIT);
+		async_answer_0(icall, ELIMIT);
+		return;
+	}
+
+	if (delay > 0)
+		fibril_usleep(delay);
+
+	rc = async_data_write_finalize(&call, xfer_buf, size);
+	async_answer_0(icall, rc);
+}
+
+static void ipc_test_read_srv(ipc_call_t *icall)
+{
+	usec_t delay = ipc_get_arg1(icall);
+	size_t part = ipc_get_arg2(icall);
+	ipc_call_t call;
+	errno_t rc;
+	size_t size;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ipc_test_read_srv");
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(icall, EINVAL);
+		log_msg(LOG_DEFAULT, LVL_ERROR, "data_read_receive failed");
+		return;
+	}
+
+	if (size > DATA_XFER_LOAN_LIMIT)
+		size = DATA_XFER_LOAN_LIMIT;
+	if (part > 0 && part < size)
+		size = part;
+
+	if (delay > 0)
+		fibril_usleep(delay);
+
+	rc = async_data_read_finalize(&call, xfer_buf, size);
+	async_answer_0(icall, rc);
+}
+
+static errno_t ipc_test_ring_consumer(void *arg)
+{
+	async_ring_t *ring = arg;
+	size_t size;
+	errno_t rc;
+
+	void *buf = malloc(async_ring_max_size(ring));
+	if (buf != NULL) {
+		do {
+			rc = async_ring_read(ring, buf, async_ring_max_size(ring),
+			    &size);
+		} while (rc == EOK);
+
+		free(buf);
+	}
+
+	async_ring_destroy(ring);
+	return EOK;
+}
+
+static void ipc_test_ring_srv(ipc_call_t *icall)
+{
+	async_ring_t *ring;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ipc_test_ring_srv");
+	rc = async_ring_accept(&ring);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		log_msg(LOG_DEFAULT, LVL_ERROR, "ring_accept failed");
+		return;
+	}
+
+	fid_t fid = fibril_create(ipc_test_ring_consumer, ring);
+	if (fid == 0) {
+		async_ring_destroy(ring);
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	fibril_add_ready(fid);
+	async_answer_0(icall, EOK);
+}
+
 static void ipc_test_connection(ipc_call_t *icall, void *arg)
 {
 	/* Accept connection */
@@ -211,6 +319,15 @@ static void ipc_test_connection(ipc_call_t *icall, void *arg)
 		case IPC_TEST_SHARE_IN_RW:
 			ipc_test_share_in_rw_srv(&call);
 			break;
+		case IPC_TEST_WRITE:
+			ipc_test_write_srv(&call);
+			break;
+		case IPC_TEST_READ:
+			ipc_test_read_srv(&call);
+			break;
+		case IPC_TEST_RING:
+			ipc_test_ring_srv(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -223,6 +340,13 @@ int main(int argc, char *argv[])
 	errno_t rc;
 
 	printf("%s: IPC test service\n", NAME);
+
+	xfer_buf = malloc(DATA_XFER_LOAN_LIMIT);
+	if (xfer_buf == NULL) {
+		printf(NAME ": Out of memory.\n");
+		return ENOMEM;
+	}
+
 	async_set_fallback_port_handler(ipc_test_connection, NULL);
 
 	rc = log_init(NAME);
@@ -36,6 +36,7 @@
  */
 
 #include <vfs/vfs.h>
+#include <fibril.h>
 #include <stdlib.h>
 #include <ipc/services.h>
 #include <abi/ipc/methods.h>
@@ -90,6 +91,11 @@ int main(int argc, char **argv)
 {
 	printf("%s: HelenOS VFS server\n", NAME);
 
+	if (fibril_set_runners_from_args(argc, argv) != EOK) {
+		printf("%s: Usage: %s [--runners <count>]\n", NAME, NAME);
+		return -1;
+	}
+
 	/*
 	 * Initialize VFS node hash table.
 	 */
@@ -99,6 +105,23 @@ int main(int argc, char **argv)
 		return ENOMEM;
 	}
 
+	/*
+	 * Initialize the directory entry cache.
+	 */
+	if (!vfs_dentry_init()) {
+		printf("%s: Failed to initialize VFS directory entry cache\n",
+		    NAME);
+		return ENOMEM;
+	}
+
+	/*
+	 * Initialize the page cache.
+	 */
+	if (!vfs_cache_init()) {
+		printf("%s: Failed to initialize VFS page cache\n", NAME);
+		return ENOMEM;
+	}
+
 	/*
 	 * Allocate and initialize the Path Lookup Buffer.
 	 */
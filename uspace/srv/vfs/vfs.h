@@ -118,6 +118,9 @@ typedef struct _vfs_node {
 
 	aoff64_t size;		/**< Cached size if the node is a file. */
 
+	/** The node was unlinked while it was in use. */
+	bool unlinked;
+
 	/**
 	 * Holding this rwlock prevents modifications of the node's contents.
 	 */
@@ -147,6 +150,29 @@ typedef struct {
 	bool append;
 } vfs_file_t;
 
+/** Page of regular file contents kept in the VFS page cache. */
+typedef struct {
+	/*
+	 * Identity of the page
+	 */
+
+	fs_handle_t fs_handle;
+	service_id_t service_id;
+	fs_index_t index;
+	aoff64_t offset;	/**< Page-aligned offset within the file. */
+
+	ht_link_t link;		/**< Page cache hash table link. */
+	link_t lru_link;	/**< Page cache LRU list link. */
+
+	/** Number of users currently accessing the page contents. */
+	unsigned refcnt;
+	/** The page can be found in the page cache. */
+	bool cached;
+
+	void *data;		/**< Page-sized address space area. */
+	size_t valid;		/**< Number of valid bytes in data. */
+} vfs_cache_page_t;
+
 extern fibril_mutex_t nodes_mutex;
 
 extern fibril_condvar_t fs_list_cv;
@@ -191,6 +217,25 @@ extern unsigned vfs_nodes_refcount_sum_get(fs_handle_t, service_id_t);
 
 extern bool vfs_node_has_children(vfs_node_t *node);
 
+extern bool vfs_dentry_init(void);
+extern uint64_t vfs_dentry_gen(void);
+extern bool vfs_dentry_find(vfs_node_t *, const char *, vfs_node_t **);
+extern void vfs_dentry_insert(vfs_node_t *, const char *, vfs_node_t *,
+    uint64_t);
+extern void vfs_dentry_invalidate(vfs_triplet_t *, const char *);
+extern void vfs_dentry_forget(vfs_triplet_t *);
+extern void vfs_dentry_invalidate_fs(fs_handle_t, service_id_t);
+extern void vfs_dentry_stats(vfs_lookup_stats_t *);
+
+extern bool vfs_cache_init(void);
+extern bool vfs_cache_enabled(vfs_node_t *);
+extern errno_t vfs_cache_get(vfs_node_t *, async_exch_t *, aoff64_t,
+    vfs_cache_page_t **);
+extern void vfs_cache_put(vfs_cache_page_t *);
+extern void vfs_cache_invalidate(fs_handle_t, service_id_t, fs_index_t,
+    aoff64_t, aoff64_t);
+extern void vfs_cache_invalidate_fs(fs_handle_t, service_id_t);
+
 extern void *vfs_client_data_create(void);
 extern void vfs_client_data_destroy(void *);
 
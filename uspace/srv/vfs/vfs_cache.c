@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup vfs
+ * @{
+ */
+
+/**
+ * @file vfs_cache.c
+ * @brief VFS page cache.
+ *
+ * The page cache keeps page-sized chunks of regular file contents in the VFS
+ * address space. It is shared by the read path and by the pager, so tasks
+ * that map the same file read-only end up sharing the cached physical frames.
+ *
+ * Pages are identified by the file triplet and the page-aligned offset. They
+ * outlive the VFS nodes and are dropped in LRU order when the cache exceeds
+ * its budget or when the system runs low on physical memory.
+ */
+
+#include "vfs.h"
+#include <adt/hash_table.h>
+#include <adt/hash.h>
+#include <adt/list.h>
+#include <align.h>
+#include <as.h>
+#include <assert.h>
+#include <async.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <macros.h>
+#include <stats.h>
+#include <stdlib.h>
+
+/** Maximum number of pages kept in the page cache. */
+#define VFS_CACHE_MAX_PAGES	1024
+
+/** Number of page insertions between two physical memory checks. */
+#define VFS_CACHE_PRESSURE_INTERVAL	64
+
+/** Shrink the cache when less than 1/Nth of physical memory is free. */
+#define VFS_CACHE_PRESSURE_RATIO	16
+
+/** Ranges of up to this many pages are invalidated by direct lookups. */
+#define VFS_CACHE_INVALIDATE_LOOKUPS	16
+
+typedef struct {
+	fs_handle_t fs_handle;
+	service_id_t service_id;
+	fs_index_t index;
+	aoff64_t offset;
+} vfs_cache_key_t;
+
+/** Mutex protecting the page cache. */
+static FIBRIL_MUTEX_INITIALIZE(cache_mutex);
+
+/** Page cache hash table. */
+static hash_table_t cache_pages;
+
+/** Cached pages, least recently used first. */
+static LIST_INITIALIZE(cache_lru);
+
+/** Number of pages in the page cache. */
+static size_t cache_count;
+
+/** Number of insertions since the last physical memory check. */
+static unsigned cache_inserts;
+
+/**
+ * Invalidation generation. A page read from the file system is only inserted
+ * into the cache if no invalidation happened while it was being filled.
+ */
+static uint64_t cache_gen;
+
+static size_t cache_key_hash(const void *key)
+{
+	const vfs_cache_key_t *k = key;
+	size_t hash = hash_combine(k->fs_handle, k->index);
+	hash = hash_combine(hash, k->service_id);
+	return hash_combine(hash, k->offset / PAGE_SIZE);
+}
+
+static size_t cache_hash(const ht_link_t *item)
+{
+	vfs_cache_page_t *page = hash_table_get_inst(item, vfs_cache_page_t,
+	    link);
+	vfs_cache_key_t key = {
+		.fs_handle = page->fs_handle,
+		.service_id = page->service_id,
+		.index = page->index,
+		.offset = page->offset
+	};
+
+	return cache_key_hash(&key);
+}
+
+static bool cache_key_equal(const void *key, const ht_link_t *item)
+{
+	const vfs_cache_key_t *k = key;
+	vfs_cache_page_t *page = hash_table_get_inst(item, vfs_cache_page_t,
+	    link);
+	return page->fs_handle == k->fs_handle &&
+	    page->service_id == k->service_id && page->index == k->index &&
+	    page->offset == k->offset;
+}
+
+/** Page cache hash table operations. */
+static const hash_table_ops_t cache_ops = {
+	.hash = cache_hash,
+	.key_hash = cache_key_hash,
+	.key_equal = cache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+/** Initialize the VFS page cache.
+ *
+ * @return		Return true on success, false on failure.
+ */
+bool vfs_cache_init(void)
+{
+	return hash_table_create(&cache_pages, 0, 0, &cache_ops);
+}
+
+static void cache_page_destroy(vfs_cache_page_t *page)
+{
+	as_area_destroy(page->data);
+	free(page);
+}
+
+/** Remove a page from the cache.
+ *
+ * The page is destroyed immediately unless someone is still using it, in
+ * which case it is destroyed by the last vfs_cache_put().
+ *
+ * The cache mutex must be held.
+ */
+static void cache_page_remove(vfs_cache_page_t *page)
+{
+	assert(page->cached);
+
+	hash_table_remove_item(&cache_pages, &page->link);
+	list_remove(&page->lru_link);
+	page->cached = false;
+	cache_count--;
+
+	if (page->refcnt == 0)
+		cache_page_destroy(page);
+}
+
+/** Shrink the cache to at most @a count pages.
+ *
+ * The cache mutex must be held.
+ */
+static void cache_shrink(size_t count)
+{
+	while (cache_count > count) {
+		link_t *link = list_first(&cache_lru);
+		cache_page_remove(list_get_instance(link, vfs_cache_page_t,
+		    lru_link));
+	}
+}
+
+/** Shrink the cache if the system is running low on physical memory. */
+static void cache_pressure_check(void)
+{
+	stats_physmem_t *physmem = stats_get_physmem();
+	if (physmem == NULL)
+		return;
+
+	if (physmem->free < physmem->total / VFS_CACHE_PRESSURE_RATIO) {
+		fibril_mutex_lock(&cache_mutex);
+		cache_shrink(cache_count / 2);
+		fibril_mutex_unlock(&cache_mutex);
+	}
+
+	free(physmem);
+}
+
+/** Check whether contents of a node may be kept in the page cache.
+ *
+ * Only regular files of block-backed file systems qualify. Other file
+ * systems, such as locfs, do not know the size of their files in advance
+ * or may change the contents behind the back of VFS.
+ *
+ * @param node		VFS node.
+ *
+ * @return		True if the node's contents may be cached.
+ */
+bool vfs_cache_enabled(vfs_node_t *node)
+{
+	if (node->type != VFS_NODE_FILE)
+		return false;
+
+	vfs_info_t *fs_info = fs_handle_to_info(node->fs_handle);
+	return fs_info != NULL && fs_info->block_backed;
+}
+
+/** Read a page of file contents from the file system.
+ *
+ * @param node		VFS node of the file.
+ * @param exch		Exchange with the node's file system.
+ * @param page		Page to be filled.
+ *
+ * @return		EOK on success or an error code from errno.h.
+ */
+static errno_t cache_page_fill(vfs_node_t *node, async_exch_t *exch,
+    vfs_cache_page_t *page)
+{
+	size_t size = min(PAGE_SIZE, node->size - page->offset);
+	size_t total = 0;
+
+	while (total < size) {
+		aoff64_t pos = page->offset + total;
+		ipc_call_t answer;
+		aid_t msg = async_send_4(exch, VFS_OUT_READ, node->service_id,
+		    node->index, LOWER32(pos), UPPER32(pos), &answer);
+		if (msg == 0)
+			return EINVAL;
+
+		errno_t rc = async_data_read_start(exch, page->data + total,
+		    size - total);
+		if (rc != EOK) {
+			async_forget(msg);
+			return rc;
+		}
+
+		async_wait_for(msg, &rc);
+		if (rc != EOK)
+			return rc;
+
+		size_t chunk = ipc_get_arg1(&answer);
+		if (chunk == 0)
+			break;
+
+		total += chunk;
+	}
+
+	page->valid = total;
+	return EOK;
+}
+
+/** Get a page of a regular file from the page cache.
+ *
+ * The node must be one for which vfs_cache_enabled() holds.
+ *
+ * If the page is not cached, it is read from the file system and inserted
+ * into the cache. The caller must hold the node's contents_rwlock and must
+ * return the page by calling vfs_cache_put().
+ *
+ * @param node		VFS node of a regular file.
+ * @param exch		Exchange with the node's file system.
+ * @param pos		Position within the file.
+ * @param out_page	Place to store the page covering @a pos.
+ *
+ * @return		EOK on success, ENOENT if @a pos lies beyond the end of
+ *			the file or another error code from errno.h.
+ */
+errno_t vfs_cache_get(vfs_node_t *node, async_exch_t *exch, aoff64_t pos,
+    vfs_cache_page_t **out_page)
+{
+	vfs_cache_key_t key = {
+		.fs_handle = node->fs_handle,
+		.service_id = node->service_id,
+		.index = node->index,
+		.offset = ALIGN_DOWN(pos, PAGE_SIZE)
+	};
+
+	if (key.offset >= node->size)
+		return ENOENT;
+
+	fibril_mutex_lock(&cache_mutex);
+	ht_link_t *link = hash_table_find(&cache_pages, &key);
+	if (link != NULL) {
+		vfs_cache_page_t *page = hash_table_get_inst(link,
+		    vfs_cache_page_t, link);
+		page->refcnt++;
+		list_remove(&page->lru_link);
+		list_append(&page->lru_link, &cache_lru);
+		fibril_mutex_unlock(&cache_mutex);
+
+		*out_page = page;
+		return EOK;
+	}
+	uint64_t gen = cache_gen;
+	fibril_mutex_unlock(&cache_mutex);
+
+	vfs_cache_page_t *page = malloc(sizeof(vfs_cache_page_t));
+	if (page == NULL)
+		return ENOMEM;
+
+	page->data = as_area_create(AS_AREA_ANY, PAGE_SIZE,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	    AS_AREA_UNPAGED);
+	if (page->data == AS_MAP_FAILED) {
+		free(page);
+		return ENOMEM;
+	}
+
+	page->fs_handle = key.fs_handle;
+	page->service_id = key.service_id;
+	page->index = key.index;
+	page->offset = key.offset;
+	page->refcnt = 1;
+	page->cached = false;
+	page->valid = 0;
+	link_initialize(&page->lru_link);
+
+	errno_t rc = cache_page_fill(node, exch, page);
+	if (rc != EOK) {
+		cache_page_destroy(page);
+		return rc;
+	}
+
+	bool check = false;
+
+	fibril_mutex_lock(&cache_mutex);
+	link = hash_table_find(&cache_pages, &key);
+	if (link != NULL) {
+		/* Someone else has filled the same page in the meantime. */
+		cache_page_destroy(page);
+		page = hash_table_get_inst(link, vfs_cache_page_t, link);
+		page->refcnt++;
+	} else if (gen == cache_gen) {
+		hash_table_insert(&cache_pages, &page->link);
+		list_append(&page->lru_link, &cache_lru);
+		page->cached = true;
+		cache_count++;
+		cache_shrink(VFS_CACHE_MAX_PAGES);
+
+		if (++cache_inserts >= VFS_CACHE_PRESSURE_INTERVAL) {
+			cache_inserts = 0;
+			check = true;
+		}
+	} else {
+		/*
+		 * The file may have changed while we were reading it. Use the
+		 * page only for this request.
+		 */
+	}
+	fibril_mutex_unlock(&cache_mutex);
+
+	if (check)
+		cache_pressure_check();
+
+	*out_page = page;
+	return EOK;
+}
+
+/** Return a page obtained by vfs_cache_get().
+ *
+ * @param page		Page to be returned.
+ */
+void vfs_cache_put(vfs_cache_page_t *page)
+{
+	bool destroy;
+
+	fibril_mutex_lock(&cache_mutex);
+	assert(page->refcnt > 0);
+	page->refcnt--;
+	destroy = (page->refcnt == 0) && !page->cached;
+	fibril_mutex_unlock(&cache_mutex);
+
+	if (destroy)
+		cache_page_destroy(page);
+}
+
+/** Drop cached pages of a file.
+ *
+ * @param fs_handle	File system handle.
+ * @param service_id	Service ID of the file system instance.
+ * @param index		Index of the file.
+ * @param start		Start of the range to be dropped.
+ * @param end		End of the range to be dropped (exclusive).
+ */
+void vfs_cache_invalidate(fs_handle_t fs_handle, service_id_t service_id,
+    fs_index_t index, aoff64_t start, aoff64_t end)
+{
+	start = ALIGN_DOWN(start, PAGE_SIZE);
+	if (end <= start)
+		return;
+
+	fibril_mutex_lock(&cache_mutex);
+	cache_gen++;
+
+	if ((end - start) / PAGE_SIZE < VFS_CACHE_INVALIDATE_LOOKUPS) {
+		vfs_cache_key_t key = {
+			.fs_handle = fs_handle,
+			.service_id = service_id,
+			.index = index
+		};
+
+		for (key.offset = start; key.offset < end;
+		    key.offset += PAGE_SIZE) {
+			ht_link_t *link = hash_table_find(&cache_pages, &key);
+			if (link != NULL) {
+				cache_page_remove(hash_table_get_inst(link,
+				    vfs_cache_page_t, link));
+			}
+		}
+	} else {
+		list_foreach_safe(cache_lru, cur, next) {
+			vfs_cache_page_t *page = list_get_instance(cur,
+			    vfs_cache_page_t, lru_link);
+			if (page->fs_handle == fs_handle &&
+			    page->service_id == service_id &&
+			    page->index == index && page->offset >= start &&
+			    page->offset < end)
+				cache_page_remove(page);
+		}
+	}
+
+	fibril_mutex_unlock(&cache_mutex);
+}
+
+/** Drop all cached pages of a file system instance.
+ *
+ * @param fs_handle	File system handle.
+ * @param service_id	Service ID of the file system instance.
+ */
+void vfs_cache_invalidate_fs(fs_handle_t fs_handle, service_id_t service_id)
+{
+	fibril_mutex_lock(&cache_mutex);
+	cache_gen++;
+
+	list_foreach_safe(cache_lru, cur, next) {
+		vfs_cache_page_t *page = list_get_instance(cur,
+		    vfs_cache_page_t, lru_link);
+		if (page->fs_handle == fs_handle &&
+		    page->service_id == service_id)
+			cache_page_remove(page);
+	}
+
+	fibril_mutex_unlock(&cache_mutex);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup vfs
+ * @{
+ */
+
+/**
+ * @file vfs_dentry.c
+ * @brief VFS directory entry cache.
+ *
+ * The directory entry cache maps a (parent directory, name) pair to the VFS
+ * node the name refers to. Negative entries record names that are known not
+ * to exist. The cache lets VFS resolve hot paths without asking the file
+ * system servers.
+ *
+ * Positive entries hold a reference to their VFS node so that the cached
+ * node, including its size, stays authoritative while the entry exists.
+ */
+
+#include "vfs.h"
+#include <adt/hash_table.h>
+#include <adt/hash.h>
+#include <adt/list.h>
+#include <fibril_synch.h>
+#include <stdlib.h>
+#include <str.h>
+
+/** Maximum number of entries kept in the directory entry cache. */
+#define VFS_DENTRY_MAX	1024
+
+typedef struct {
+	const vfs_triplet_t *parent;
+	const char *name;
+} vfs_dentry_key_t;
+
+typedef struct {
+	vfs_triplet_t parent;
+	char *name;
+
+	/** Node the name refers to or NULL for a negative entry. */
+	vfs_node_t *node;
+
+	ht_link_t link;		/**< Entry hash table link. */
+	link_t lru_link;	/**< Entry LRU list link. */
+} vfs_dentry_t;
+
+/** Mutex protecting the directory entry cache. */
+static FIBRIL_MUTEX_INITIALIZE(dentry_mutex);
+
+/** Directory entry hash table. */
+static hash_table_t dentries;
+
+/** Cached entries, least recently used first. */
+static LIST_INITIALIZE(dentry_lru);
+
+/** Number of entries in the cache. */
+static size_t dentry_count;
+
+/**
+ * Invalidation generation. An entry looked up in the file system is only
+ * inserted if the namespace did not change while the lookup was in progress.
+ */
+static uint64_t dentry_gen;
+
+static uint64_t dentry_hits;
+static uint64_t dentry_misses;
+
+static size_t dentry_key_hash(const void *key)
+{
+	const vfs_dentry_key_t *k = key;
+	size_t hash = hash_combine(k->parent->fs_handle, k->parent->index);
+	hash = hash_combine(hash, k->parent->service_id);
+
+	for (const char *c = k->name; *c != 0; c++)
+		hash = hash_combine(hash, (uint8_t) *c);
+
+	return hash;
+}
+
+static size_t dentry_hash(const ht_link_t *item)
+{
+	vfs_dentry_t *dentry = hash_table_get_inst(item, vfs_dentry_t, link);
+	vfs_dentry_key_t key = {
+		.parent = &dentry->parent,
+		.name = dentry->name
+	};
+
+	return dentry_key_hash(&key);
+}
+
+static bool dentry_key_equal(const void *key, const ht_link_t *item)
+{
+	const vfs_dentry_key_t *k = key;
+	vfs_dentry_t *dentry = hash_table_get_inst(item, vfs_dentry_t, link);
+	return dentry->parent.fs_handle == k->parent->fs_handle &&
+	    dentry->parent.service_id == k->parent->service_id &&
+	    dentry->parent.index == k->parent->index &&
+	    str_cmp(dentry->name, k->name) == 0;
+}
+
+/** Directory entry hash table operations. */
+static const hash_table_ops_t dentry_ops = {
+	.hash = dentry_hash,
+	.key_hash = dentry_key_hash,
+	.key_equal = dentry_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+/** Initialize the directory entry cache.
+ *
+ * @return		Return true on success, false on failure.
+ */
+bool vfs_dentry_init(void)
+{
+	return hash_table_create(&dentries, 0, 0, &dentry_ops);
+}
+
+static inline bool triplet_equal(const vfs_triplet_t *a,
+    const vfs_triplet_t *b)
+{
+	return a->fs_handle == b->fs_handle &&
+	    a->service_id == b->service_id && a->index == b->index;
+}
+
+/** Unhash an entry and move it to a list of entries to be destroyed.
+ *
+ * The dentry mutex must be held.
+ */
+static void dentry_remove(vfs_dentry_t *dentry, list_t *dead)
+{
+	hash_table_remove_item(&dentries, &dentry->link);
+	list_remove(&dentry->lru_link);
+	list_append(&dentry->lru_link, dead);
+	dentry_count--;
+}
+
+/** Destroy entries removed from the cache.
+ *
+ * Dropping a node reference can talk to the file system server, so this must
+ * be done without holding the dentry mutex.
+ */
+static void dentry_destroy_list(list_t *dead)
+{
+	link_t *link;
+
+	while ((link = list_first(dead)) != NULL) {
+		vfs_dentry_t *dentry = list_get_instance(link, vfs_dentry_t,
+		    lru_link);
+		list_remove(link);
+
+		if (dentry->node != NULL)
+			vfs_node_put(dentry->node);
+		free(dentry->name);
+		free(dentry);
+	}
+}
+
+/** Get the current invalidation generation.
+ *
+ * The returned value is to be passed to vfs_dentry_insert().
+ */
+uint64_t vfs_dentry_gen(void)
+{
+	fibril_mutex_lock(&dentry_mutex);
+	uint64_t gen = dentry_gen;
+	fibril_mutex_unlock(&dentry_mutex);
+
+	return gen;
+}
+
+/** Look up a name in the directory entry cache.
+ *
+ * @param parent	Parent directory.
+ * @param name		Name to look up.
+ * @param out_node	Place to store the node the name refers to, or NULL if
+ *			the name is known not to exist. A non-NULL node has
+ *			its reference count incremented.
+ *
+ * @return		True on cache hit, false on cache miss.
+ */
+bool vfs_dentry_find(vfs_node_t *parent, const char *name,
+    vfs_node_t **out_node)
+{
+	vfs_dentry_key_t key = {
+		.parent = (vfs_triplet_t *) parent,
+		.name = name
+	};
+
+	fibril_mutex_lock(&dentry_mutex);
+	ht_link_t *link = hash_table_find(&dentries, &key);
+	if (link == NULL) {
+		dentry_misses++;
+		fibril_mutex_unlock(&dentry_mutex);
+		return false;
+	}
+
+	vfs_dentry_t *dentry = hash_table_get_inst(link, vfs_dentry_t, link);
+	list_remove(&dentry->lru_link);
+	list_append(&dentry->lru_link, &dentry_lru);
+	if (dentry->node != NULL)
+		vfs_node_addref(dentry->node);
+	*out_node = dentry->node;
+	dentry_hits++;
+	fibril_mutex_unlock(&dentry_mutex);
+
+	return true;
+}
+
+/** Insert a name into the directory entry cache.
+ *
+ * @param parent	Parent directory.
+ * @param name		Name of the entry.
+ * @param node		Node the name refers to or NULL for a negative entry.
+ * @param gen		Invalidation generation obtained by vfs_dentry_gen()
+ *			before the name was looked up in the file system.
+ */
+void vfs_dentry_insert(vfs_node_t *parent, const char *name, vfs_node_t *node,
+    uint64_t gen)
+{
+	vfs_dentry_t *dentry = malloc(sizeof(vfs_dentry_t));
+	if (dentry == NULL)
+		return;
+
+	dentry->name = str_dup(name);
+	if (dentry->name == NULL) {
+		free(dentry);
+		return;
+	}
+
+	dentry->parent = *((vfs_triplet_t *) parent);
+	dentry->node = node;
+	link_initialize(&dentry->lru_link);
+
+	vfs_dentry_key_t key = {
+		.parent = &dentry->parent,
+		.name = dentry->name
+	};
+
+	list_t dead;
+	list_initialize(&dead);
+
+	fibril_mutex_lock(&dentry_mutex);
+	if (gen != dentry_gen || hash_table_find(&dentries, &key) != NULL) {
+		fibril_mutex_unlock(&dentry_mutex);
+		free(dentry->name);
+		free(dentry);
+		return;
+	}
+
+	if (node != NULL)
+		vfs_node_addref(node);
+
+	hash_table_insert(&dentries, &dentry->link);
+	list_append(&dentry->lru_link, &dentry_lru);
+	dentry_count++;
+
+	while (dentry_count > VFS_DENTRY_MAX) {
+		dentry_remove(list_get_instance(list_first(&dentry_lru),
+		    vfs_dentry_t, lru_link), &dead);
+	}
+	fibril_mutex_unlock(&dentry_mutex);
+
+	dentry_destroy_list(&dead);
+}
+
+/** Drop the cached entry for a name.
+ *
+ * This must be called whenever a name is added to a directory.
+ *
+ * @param parent	Parent directory.
+ * @param name		Name of the entry.
+ */
+void vfs_dentry_invalidate(vfs_triplet_t *parent, const char *name)
+{
+	vfs_dentry_key_t key = {
+		.parent = parent,
+		.name = name
+	};
+
+	list_t dead;
+	list_initialize(&dead);
+
+	fibril_mutex_lock(&dentry_mutex);
+	dentry_gen++;
+	ht_link_t *link = hash_table_find(&dentries, &key);
+	if (link != NULL) {
+		dentry_remove(hash_table_get_inst(link, vfs_dentry_t, link),
+		    &dead);
+	}
+	fibril_mutex_unlock(&dentry_mutex);
+
+	dentry_destroy_list(&dead);
+}
+
+/** Drop all cached names of a node and all entries whose parent it is.
+ *
+ * The latter matters only if the node is a directory. This must be called
+ * whenever a name is removed from a directory.
+ *
+ * @param triplet	Node that has lost one of its names.
+ */
+void vfs_dentry_forget(vfs_triplet_t *triplet)
+{
+	list_t dead;
+	list_initialize(&dead);
+
+	fibril_mutex_lock(&dentry_mutex);
+	dentry_gen++;
+	list_foreach_safe(dentry_lru, cur, next) {
+		vfs_dentry_t *dentry = list_get_instance(cur, vfs_dentry_t,
+		    lru_link);
+		if (triplet_equal(&dentry->parent, triplet) ||
+		    (dentry->node != NULL &&
+		    triplet_equal((vfs_triplet_t *) dentry->node, triplet)))
+			dentry_remove(dentry, &dead);
+	}
+	fibril_mutex_unlock(&dentry_mutex);
+
+	dentry_destroy_list(&dead);
+}
+
+/** Drop all cached entries of a file system instance.
+ *
+ * @param fs_handle	File system handle.
+ * @param service_id	Service ID of the file system instance.
+ */
+void vfs_dentry_invalidate_fs(fs_handle_t fs_handle, service_id_t service_id)
+{
+	list_t dead;
+	list_initialize(&dead);
+
+	fibril_mutex_lock(&dentry_mutex);
+	dentry_gen++;
+	list_foreach_safe(dentry_lru, cur, next) {
+		vfs_dentry_t *dentry = list_get_instance(cur, vfs_dentry_t,
+		    lru_link);
+		if (dentry->parent.fs_handle == fs_handle &&
+		    dentry->parent.service_id == service_id)
+			dentry_remove(dentry, &dead);
+	}
+	fibril_mutex_unlock(&dentry_mutex);
+
+	dentry_destroy_list(&dead);
+}
+
+/** Get directory entry cache statistics.
+ *
+ * @param stats		Place to store the statistics.
+ */
+void vfs_dentry_stats(vfs_lookup_stats_t *stats)
+{
+	fibril_mutex_lock(&dentry_mutex);
+	stats->hits = dentry_hits;
+	stats->misses = dentry_misses;
+	fibril_mutex_unlock(&dentry_mutex);
+}
+
+/**
+ * @}
+ */
@@ -110,6 +110,25 @@ out:
 	vfs_fstypes_free(&fstypes);
 }
 
+static void vfs_in_lookup_stats(ipc_call_t *req)
+{
+	vfs_lookup_stats_t stats;
+	vfs_dentry_stats(&stats);
+
+	ipc_call_t call;
+	size_t len;
+	if (!async_data_read_receive(&call, &len)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(req, EINVAL);
+		return;
+	}
+
+	if (len > sizeof(stats))
+		len = sizeof(stats);
+	errno_t rc = async_data_read_finalize(&call, &stats, len);
+	async_answer_0(req, rc);
+}
+
 static void vfs_in_mount(ipc_call_t *req)
 {
 	int mpfd = ipc_get_arg1(req);
@@ -344,6 +363,9 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_IN_FSTYPES:
 			vfs_in_fstypes(&call);
 			break;
+		case VFS_IN_LOOKUP_STATS:
+			vfs_in_lookup_stats(&call);
+			break;
 		case VFS_IN_MOUNT:
 			vfs_in_mount(&call);
 			break;
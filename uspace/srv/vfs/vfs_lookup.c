@@ -202,6 +202,8 @@ errno_t vfs_link_internal(vfs_node_t *base, char *path, vfs_triplet_t *child)
 	if (orig_rc != EOK)
 		rc = orig_rc;
 
+	vfs_dentry_invalidate(triplet, component);
+
 out:
 	return rc;
 }
@@ -237,9 +239,186 @@ static errno_t out_lookup(vfs_triplet_t *base, size_t *pfirst, size_t *plen,
 	return EOK;
 }
 
+/** Check whether lookups in a directory may use the directory entry cache.
+ *
+ * File systems such as locfs change their namespace without VFS knowing, so
+ * neither positive nor negative entries could be kept up to date for them.
+ */
+static bool lookup_cacheable(vfs_node_t *dir)
+{
+	vfs_info_t *fs_info = fs_handle_to_info(dir->fs_handle);
+	return fs_info != NULL && !fs_info->external_namespace;
+}
+
+/** Look up a single name in the file system and possibly cache the result.
+ *
+ * @param dir		Directory in which to look up the name.
+ * @param name		Name to look up.
+ * @param cache		Whether to insert the result into the cache.
+ * @param out_node	Place to store the node the name refers to, or NULL if
+ *			the name does not exist. A non-NULL node has its
+ *			reference count incremented.
+ *
+ * @return EOK on success or an error code from errno.h.
+ */
+static errno_t lookup_component(vfs_node_t *dir, char *name, bool cache,
+    vfs_node_t **out_node)
+{
+	char component[NAME_MAX + 2];
+	size_t len = str_size(name) + 1;
+	size_t first;
+	errno_t rc;
+
+	component[0] = '/';
+	memcpy(component + 1, name, len);
+
+	uint64_t gen = vfs_dentry_gen();
+
+	plb_entry_t entry;
+	rc = plb_insert_entry(&entry, component, &first, len);
+	if (rc != EOK)
+		return rc;
+
+	size_t next = first;
+	size_t nlen = len;
+	vfs_lookup_res_t res;
+	rc = out_lookup((vfs_triplet_t *) dir, &next, &nlen, L_NONE, &res);
+	plb_clear_entry(&entry, first, len);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * If the name does not exist, the file system stops at the directory
+	 * and leaves the name unresolved.
+	 */
+	vfs_node_t *node = NULL;
+	if (nlen == 0) {
+		node = vfs_node_get(&res);
+		if (!node)
+			return ENOMEM;
+	}
+
+	if (cache)
+		vfs_dentry_insert(dir, name, node, gen);
+
+	*out_node = node;
+	return EOK;
+}
+
+/** Perform a path lookup using the directory entry cache.
+ *
+ * The path is resolved one component at a time. Components missing from the
+ * cache are looked up in the file system and added to the cache. Directories
+ * of file systems with an external namespace bypass the cache.
+ */
+static errno_t lookup_cached(vfs_node_t *base, char *path, int lflag,
+    vfs_lookup_res_t *result, size_t len)
+{
+	char name[NAME_MAX + 1];
+	size_t pos = 0;
+	errno_t rc = EOK;
+
+	vfs_node_t *cur = base;
+	vfs_node_addref(cur);
+
+	do {
+		/* Cross mount points on the way. */
+		while (cur->mount) {
+			if (lflag & L_DISABLE_MOUNTS) {
+				rc = EXDEV;
+				goto out;
+			}
+
+			vfs_node_t *mnt = cur->mount;
+			vfs_node_addref(mnt);
+			vfs_node_put(cur);
+			cur = mnt;
+		}
+
+		/* Collect the next component. */
+		if (pos < len && path[pos] == '/')
+			pos++;
+		size_t start = pos;
+		while (pos < len && path[pos] != '/')
+			pos++;
+
+		size_t clen = pos - start;
+		if (clen == 0) {
+			/* The path is just "/". */
+			break;
+		}
+
+		if (clen > NAME_MAX) {
+			rc = ENAMETOOLONG;
+			goto out;
+		}
+
+		if (cur->type == VFS_NODE_FILE) {
+			rc = ENOTDIR;
+			goto out;
+		}
+
+		memcpy(name, &path[start], clen);
+		name[clen] = 0;
+
+		vfs_node_t *child;
+		bool cache = lookup_cacheable(cur);
+		if (!cache || !vfs_dentry_find(cur, name, &child)) {
+			rc = lookup_component(cur, name, cache, &child);
+			if (rc != EOK)
+				goto out;
+		}
+
+		if (child == NULL) {
+			rc = ENOENT;
+			goto out;
+		}
+
+		vfs_node_put(cur);
+		cur = child;
+	} while (pos < len);
+
+	/* The found file may be a mount point. Try to cross it. */
+	if (!(lflag & (L_MP | L_DISABLE_MOUNTS))) {
+		while (cur->mount) {
+			vfs_node_t *mnt = cur->mount;
+			vfs_node_addref(mnt);
+			vfs_node_put(cur);
+			cur = mnt;
+		}
+	}
+
+	if ((lflag & L_FILE) && cur->type == VFS_NODE_DIRECTORY) {
+		rc = EISDIR;
+		goto out;
+	}
+
+	if ((lflag & L_DIRECTORY) && cur->type == VFS_NODE_FILE) {
+		rc = ENOTDIR;
+		goto out;
+	}
+
+	if (result != NULL) {
+		result->triplet = *((vfs_triplet_t *) cur);
+		result->type = cur->type;
+		result->size = cur->size;
+	}
+
+out:
+	vfs_node_put(cur);
+	return rc;
+}
+
 static errno_t _vfs_lookup_internal(vfs_node_t *base, char *path, int lflag,
     vfs_lookup_res_t *result, size_t len)
 {
+	/*
+	 * Lookups which do not modify the namespace are served from the
+	 * directory entry cache.
+	 */
+	if (!(lflag & (L_CREATE | L_UNLINK)))
+		return lookup_cached(base, path, lflag, result, len);
+
 	size_t first;
 	errno_t rc;
 
@@ -385,6 +564,17 @@ errno_t vfs_lookup_internal(vfs_node_t *base, char *path, int lflag,
 		rc = _vfs_lookup_internal(parent, slash, lflag, result,
 		    len - (slash - path));
 
+		/*
+		 * A newly created name replaces a negative entry. Removed names
+		 * are dropped from the cache by the callers.
+		 */
+		if (lflag & L_CREATE) {
+			vfs_node_t *dir = parent;
+			while (dir->mount)
+				dir = dir->mount;
+			vfs_dentry_invalidate((vfs_triplet_t *) dir, slash + 1);
+		}
+
 		vfs_node_put(parent);
 
 	} else {
@@ -134,6 +134,15 @@ void vfs_node_delref(vfs_node_t *node)
 		    (sysarg_t)node->index);
 		vfs_exchange_release(exch);
 
+		/*
+		 * The index of an unlinked node can be reused by the file
+		 * system from now on.
+		 */
+		if (node->unlinked) {
+			vfs_cache_invalidate(node->fs_handle, node->service_id,
+			    node->index, 0, UINT64_MAX);
+		}
+
 		free(node);
 	}
 }
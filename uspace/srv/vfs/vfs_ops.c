@@ -36,7 +36,9 @@
  */
 
 #include "vfs.h"
+#include <as.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdint.h>
 #include <async.h>
 #include <errno.h>
@@ -50,6 +52,9 @@
 #include <assert.h>
 #include <vfs/canonify.h>
 
+/** Maximum number of bytes served from the page cache by one read. */
+#define VFS_CACHE_READ_MAX  (16 * PAGE_SIZE)
+
 /* Forward declarations of static functions. */
 static errno_t vfs_truncate_internal(fs_handle_t, service_id_t, fs_index_t,
     aoff64_t);
@@ -85,6 +90,30 @@ static void out_destroy(vfs_triplet_t *file)
 	vfs_exchange_release(exch);
 }
 
+/** Release a node that has just been unlinked from the namespace.
+ *
+ * If the node is not held by anyone, try to destroy it. Otherwise its cached
+ * pages are dropped once the last reference to the node goes away.
+ */
+static void out_unlinked(vfs_lookup_res_t *lr)
+{
+	vfs_node_t *node = vfs_node_peek(lr);
+	if (!node) {
+		vfs_cache_invalidate(lr->triplet.fs_handle,
+		    lr->triplet.service_id, lr->triplet.index, 0, UINT64_MAX);
+		out_destroy(&lr->triplet);
+	} else {
+		node->unlinked = true;
+		vfs_node_put(node);
+	}
+
+	/*
+	 * This may drop the last reference to the node, so it must come after
+	 * the node has been marked as unlinked.
+	 */
+	vfs_dentry_forget(&lr->triplet);
+}
+
 errno_t vfs_op_clone(int oldfd, int newfd, bool desc, int *out_fd)
 {
 	errno_t rc;
@@ -351,12 +380,94 @@ errno_t vfs_op_open(int fd, int mode)
 typedef errno_t (*rdwr_ipc_cb_t)(async_exch_t *, vfs_file_t *, aoff64_t,
     ipc_call_t *, bool, void *);
 
+static errno_t rdwr_cache_client(async_exch_t *exch, vfs_file_t *file,
+    aoff64_t pos, ipc_call_t *answer, bool read, void *data)
+{
+	size_t *bytes = (size_t *) data;
+	vfs_node_t *node = file->node;
+	ipc_call_t call;
+	size_t size;
+
+	assert(read);
+
+	/*
+	 * Serve the client's IPC_M_DATA_READ request from the page cache. The
+	 * read is cut short at the end of the file and at VFS_CACHE_READ_MAX
+	 * bytes.
+	 */
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (pos >= node->size) {
+		*bytes = 0;
+		return async_data_read_finalize(&call, NULL, 0);
+	}
+
+	size = min(size, min(node->size - pos, VFS_CACHE_READ_MAX));
+
+	vfs_cache_page_t *page;
+	errno_t rc = vfs_cache_get(node, exch, pos, &page);
+	if (rc != EOK) {
+		async_answer_0(&call, rc);
+		return rc;
+	}
+
+	size_t off = pos - page->offset;
+	size_t chunk = (off < page->valid) ? min(size, page->valid - off) : 0;
+
+	/* A read within a single page is answered directly from the page. */
+	if (chunk == size || page->valid < PAGE_SIZE) {
+		rc = async_data_read_finalize(&call, page->data + off, chunk);
+		vfs_cache_put(page);
+
+		*bytes = chunk;
+		return rc;
+	}
+
+	uint8_t *buf = malloc(size);
+	if (buf == NULL) {
+		vfs_cache_put(page);
+		async_answer_0(&call, ENOMEM);
+		return ENOMEM;
+	}
+
+	size_t total = 0;
+	while (true) {
+		memcpy(buf + total, page->data + off, chunk);
+		total += chunk;
+		bool short_page = page->valid < PAGE_SIZE;
+		vfs_cache_put(page);
+
+		if (total == size || short_page)
+			break;
+
+		/* On failure, return what has been read so far. */
+		if (vfs_cache_get(node, exch, pos + total, &page) != EOK)
+			break;
+
+		off = 0;
+		chunk = min(size - total, page->valid);
+	}
+
+	rc = async_data_read_finalize(&call, buf, total);
+	free(buf);
+
+	*bytes = total;
+	return rc;
+}
+
 static errno_t rdwr_ipc_client(async_exch_t *exch, vfs_file_t *file, aoff64_t pos,
     ipc_call_t *answer, bool read, void *data)
 {
 	size_t *bytes = (size_t *) data;
 	errno_t rc;
 
+	/* Regular files of block-backed file systems use the page cache. */
+	if (read && vfs_cache_enabled(file->node))
+		return rdwr_cache_client(exch, file, pos, answer, read, data);
+
 	/*
 	 * Make a VFS_READ/VFS_WRITE request at the destination FS server
 	 * and forward the IPC_M_DATA_READ/IPC_M_DATA_WRITE request to the
@@ -480,6 +591,18 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 
 	vfs_exchange_release(fs_exch);
 
+	/*
+	 * Drop the cached pages affected by the write. If the write changed the
+	 * file size, the page holding the former end of the file is stale too.
+	 */
+	if (!read) {
+		aoff64_t end = (rc == EOK) ?
+		    pos + ipc_get_arg1(&answer) : UINT64_MAX;
+		vfs_cache_invalidate(file->node->fs_handle,
+		    file->node->service_id, file->node->index,
+		    min(pos, file->node->size), end);
+	}
+
 	if (file->node->type == VFS_NODE_DIRECTORY)
 		fibril_rwlock_read_unlock(&namespace_rwlock);
 
@@ -597,14 +720,9 @@ errno_t vfs_op_rename(int basefd, char *old, char *new)
 		return rc;
 	}
 
-	/* If the node is not held by anyone, try to destroy it. */
-	if (orig_unlinked) {
-		vfs_node_t *node = vfs_node_peek(&new_lr_orig);
-		if (!node)
-			out_destroy(&new_lr_orig.triplet);
-		else
-			vfs_node_put(node);
-	}
+	vfs_dentry_forget(&old_lr.triplet);
+	if (orig_unlinked)
+		out_unlinked(&new_lr_orig);
 
 	vfs_node_put(base);
 	fibril_rwlock_write_unlock(&namespace_rwlock);
@@ -624,11 +742,15 @@ errno_t vfs_op_resize(int fd, int64_t size)
 
 	fibril_rwlock_write_lock(&file->node->contents_rwlock);
 
+	aoff64_t old_size = file->node->size;
 	errno_t rc = vfs_truncate_internal(file->node->fs_handle,
 	    file->node->service_id, file->node->index, size);
 	if (rc == EOK)
 		file->node->size = size;
 
+	vfs_cache_invalidate(file->node->fs_handle, file->node->service_id,
+	    file->node->index, min((aoff64_t) size, old_size), UINT64_MAX);
+
 	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
 	vfs_file_put(file);
 	return rc;
@@ -766,12 +888,7 @@ errno_t vfs_op_unlink(int parentfd, int expectfd, char *path)
 	if (rc != EOK)
 		goto exit;
 
-	/* If the node is not held by anyone, try to destroy it. */
-	vfs_node_t *node = vfs_node_peek(&lr);
-	if (!node)
-		out_destroy(&lr.triplet);
-	else
-		vfs_node_put(node);
+	out_unlinked(&lr);
 
 exit:
 	if (path)
@@ -797,6 +914,10 @@ errno_t vfs_op_unmount(int mpfd)
 
 	fibril_rwlock_write_lock(&namespace_rwlock);
 
+	/* Cached directory entries hold references to the nodes. */
+	vfs_dentry_invalidate_fs(mp->node->mount->fs_handle,
+	    mp->node->mount->service_id);
+
 	/*
 	 * Count the total number of references for the mounted file system. We
 	 * are expecting at least one, which is held by the mount point.
@@ -822,6 +943,8 @@ errno_t vfs_op_unmount(int mpfd)
 		return rc;
 	}
 
+	vfs_cache_invalidate_fs(mp->node->mount->fs_handle,
+	    mp->node->mount->service_id);
 	vfs_node_forget(mp->node->mount);
 	vfs_node_put(mp->node);
 	mp->node->mount = NULL;
@@ -41,15 +41,16 @@
 #include <errno.h>
 #include <as.h>
 
-void vfs_page_in(ipc_call_t *req)
+/** Serve a page-in request by reading the file into a private page.
+ *
+ * Used for files whose contents are not kept in the page cache.
+ */
+static void vfs_page_in_direct(ipc_call_t *req, int fd, aoff64_t offset)
 {
-	aoff64_t offset = ipc_get_arg1(req);
-	size_t page_size = ipc_get_arg2(req);
-	int fd = ipc_get_arg3(req);
 	void *page;
 	errno_t rc;
 
-	page = as_area_create(AS_AREA_ANY, page_size,
+	page = as_area_create(AS_AREA_ANY, PAGE_SIZE,
 	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
 	    AS_AREA_UNPAGED);
 
@@ -60,7 +61,7 @@ void vfs_page_in(ipc_call_t *req)
 
 	rdwr_io_chunk_t chunk = {
 		.buffer = page,
-		.size = page_size
+		.size = PAGE_SIZE
 	};
 
 	size_t total = 0;
@@ -74,18 +75,70 @@ void vfs_page_in(ipc_call_t *req)
 		total += chunk.size;
 		pos += chunk.size;
 		chunk.buffer += chunk.size;
-		chunk.size = page_size - total;
-	} while (total < page_size);
+		chunk.size = PAGE_SIZE - total;
+	} while (total < PAGE_SIZE);
 
 	async_answer_1(req, rc, (sysarg_t) page);
+	as_area_destroy(page);
+}
+
+/** Serve a page-in request from the VFS page cache.
+ *
+ * The answered page stays in the page cache so that all tasks mapping the
+ * same file share its frames. Files which are not cached are read into a
+ * private page instead.
+ */
+void vfs_page_in(ipc_call_t *req)
+{
+	aoff64_t offset = ipc_get_arg1(req);
+	size_t page_size = ipc_get_arg2(req);
+	int fd = ipc_get_arg3(req);
+
+	if (page_size != PAGE_SIZE || (offset % PAGE_SIZE) != 0) {
+		async_answer_0(req, EINVAL);
+		return;
+	}
+
+	vfs_file_t *file = vfs_file_get(fd);
+	if (!file) {
+		async_answer_0(req, EBADF);
+		return;
+	}
+
+	if (!file->open_read || file->node->type != VFS_NODE_FILE) {
+		vfs_file_put(file);
+		async_answer_0(req, EINVAL);
+		return;
+	}
+
+	if (!vfs_cache_enabled(file->node)) {
+		vfs_file_put(file);
+		vfs_page_in_direct(req, fd, offset);
+		return;
+	}
+
+	fibril_rwlock_read_lock(&file->node->contents_rwlock);
+
+	vfs_cache_page_t *page;
+	async_exch_t *exch = vfs_exchange_grab(file->node->fs_handle);
+	errno_t rc = vfs_cache_get(file->node, exch, offset, &page);
+	vfs_exchange_release(exch);
+
+	fibril_rwlock_read_unlock(&file->node->contents_rwlock);
+	vfs_file_put(file);
+
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		return;
+	}
 
 	/*
-	 * FIXME:
-	 * This is just for now until we implement proper page cache
-	 * management.  Not keeping the pages around in a cache results in
-	 * inherently non-coherent private mappings.
+	 * The kernel takes its own reference to the frame while processing
+	 * the answer, so the page can be evicted from the cache at any time
+	 * afterwards.
 	 */
-	as_area_destroy(page);
+	async_answer_1(req, EOK, (sysarg_t) page->data);
+	vfs_cache_put(page);
 }
 
 /**